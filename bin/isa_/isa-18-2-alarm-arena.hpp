@@ -0,0 +1,122 @@
+/**
+ * ISA-18.2 Alarm Storage Arenas
+ * StablePool stores records in fixed-size chunks that are never moved or
+ * freed while the pool lives, so a record's index - and its address - stays
+ * valid however large the pool grows; growth allocates one chunk and copies
+ * nothing. StringArena packs text (alarm descriptions) back to back into
+ * large blocks and hands out string_views with the same guarantee. Together
+ * they replace a vector of objects that each own heap strings: no per-alarm
+ * allocations, no reallocation copies, and the text lives apart from the
+ * state that is touched on every scan.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Stable handle of an alarm record: its slot in the system's pool
+using AlarmId = std::uint32_t;
+
+template <typename T, std::size_t CHUNK = 1024>
+class StablePool {
+private:
+    static_assert((CHUNK & (CHUNK - 1)) == 0, "chunk size must be a power of two");
+
+    struct Chunk {
+        alignas(T) unsigned char bytes[CHUNK * sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::size_t count = 0;
+
+    T* slot(std::size_t i) const {
+        return std::launder(reinterpret_cast<T*>(chunks[i / CHUNK]->bytes)) + (i & (CHUNK - 1));
+    }
+
+public:
+    StablePool() = default;
+    StablePool(const StablePool&) = delete;
+    StablePool& operator=(const StablePool&) = delete;
+
+    ~StablePool() {
+        for (std::size_t i = 0; i < count; i++) {
+            slot(i)->~T();
+        }
+    }
+
+    // Construct a record in place and return its index
+    template <typename... Args>
+    AlarmId emplace(Args&&... args) {
+        if (count == chunks.size() * CHUNK) {
+            chunks.emplace_back(new Chunk);
+        }
+        new (slot(count)) T(std::forward<Args>(args)...);
+        return static_cast<AlarmId>(count++);
+    }
+
+    // Allocate the chunks for count records up front
+    void reserve(std::size_t capacity) {
+        while (chunks.size() * CHUNK < capacity) {
+            chunks.emplace_back(new Chunk);
+        }
+    }
+
+    T& operator[](std::size_t i) { return *slot(i); }
+    const T& operator[](std::size_t i) const { return *slot(i); }
+
+    std::size_t size() const { return count; }
+    std::size_t bytes() const { return chunks.size() * sizeof(Chunk) + chunks.capacity() * sizeof(chunks[0]); }
+};
+
+class StringArena {
+private:
+    static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cursor = nullptr;
+    std::size_t remaining = 0;
+    std::size_t allocated = 0;
+
+    char* allocate(std::size_t size) {
+        blocks.emplace_back(new char[size]);
+        allocated += size;
+        return blocks.back().get();
+    }
+
+public:
+    StringArena() = default;
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    // Copy text into the arena; the view stays valid for the arena's lifetime
+    std::string_view store(std::string_view text) {
+        if (text.empty()) {
+            return {};
+        }
+        if (text.size() > remaining) {
+            if (text.size() > BLOCK_SIZE / 4) {
+                // Large strings get a block of their own; the current block keeps filling
+                char* own = allocate(text.size());
+                std::memcpy(own, text.data(), text.size());
+                return {own, text.size()};
+            }
+            cursor = allocate(BLOCK_SIZE);
+            remaining = BLOCK_SIZE;
+        }
+        std::memcpy(cursor, text.data(), text.size());
+        std::string_view stored(cursor, text.size());
+        cursor += text.size();
+        remaining -= text.size();
+        return stored;
+    }
+
+    std::size_t bytes() const { return allocated + blocks.capacity() * sizeof(blocks[0]); }
+};
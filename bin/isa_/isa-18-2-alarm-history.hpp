@@ -0,0 +1,566 @@
+/**
+ * ISA-18.2 Alarm History Store
+ * Time-partitioned, columnar history of alarm transitions for ISA-18.2
+ * performance reporting (alarm rate per operator, floods, chattering and
+ * stale alarms, bad actors).
+ *
+ * Each partition covers a fixed time window (one day by default) and is a
+ * set of column files in the history directory:
+ *   p<N>.time   int64 timestamps      p<N>.tag    uint32 tag IDs
+ *   p<N>.state  old<<4 | new state    p<N>.prio   priority
+ *   p<N>.value  double process value  p<N>.tagidx per-tag row index (CSR)
+ * Queries memory-map the columns, so a report over months of history
+ * streams through the page cache instead of loading it into RAM. Time ranges
+ * are resolved by partition and then by binary search on the time column;
+ * per-tag queries use the tag index, which is written when a partition is
+ * sealed. POSIX mmap, C++17 <filesystem>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "isa-clock.hpp"
+#include "isa-mapped-file.hpp"
+#include "isa-tag-registry.hpp"
+#include "isa-18-2-alarm-types.hpp"
+#include "isa-18-2-alarm-journal.hpp"
+
+// ISA-18.2 alarm system performance figures over a time range
+struct AlarmKpiReport {
+    struct BadActor {
+        TagId tag;
+        std::uint32_t activations;
+    };
+
+    TimestampNs from = 0;
+    TimestampNs to = 0;
+    std::uint64_t transitions = 0;
+    std::uint64_t activations = 0;
+    double averagePer10MinPerOperator = 0.0;
+    double peakPer10MinPerOperator = 0.0;
+    std::uint32_t tenMinutePeriods = 0;
+    std::uint32_t floodPeriods = 0;         // 10-minute periods with more than 10 alarms per operator
+    double percentTimeInFlood = 0.0;
+    std::uint32_t chatteringTags = 0;       // 3 or more activations within 60 seconds
+    std::uint32_t staleAlarms = 0;          // still active 24 hours after activation
+    std::vector<BadActor> topBadActors;     // most frequent, at most 10
+};
+
+class AlarmHistory {
+private:
+    static constexpr int COLUMN_COUNT = 5;
+    static constexpr const char* COLUMN_NAMES[COLUMN_COUNT] = {"time", "tag", "state", "prio", "value"};
+    static constexpr std::size_t COLUMN_SIZES[COLUMN_COUNT] = {sizeof(TimestampNs), sizeof(TagId), 1,
+                                                              sizeof(AlarmPriority), sizeof(double)};
+    static constexpr std::size_t WRITE_BUFFER_ROWS = 8192;
+
+    struct TagIndexHeader {
+        char magic[8];
+        std::uint32_t tagCount;     // offsets has tagCount + 1 entries
+        std::uint32_t rowCount;
+    };
+
+    // Mapped columns of one partition
+    struct PartitionView {
+        std::int64_t id = 0;
+        MappedFile columns[COLUMN_COUNT];
+        std::size_t rows = 0;
+        bool sorted = true;
+
+        const TimestampNs* times() const { return columns[0].as<TimestampNs>(); }
+        const TagId* tags() const { return columns[1].as<TagId>(); }
+        const std::uint8_t* states() const { return columns[2].as<std::uint8_t>(); }
+        const AlarmPriority* priorities() const { return columns[3].as<AlarmPriority>(); }
+        const double* values() const { return columns[4].as<double>(); }
+
+        JournalRecord row(std::size_t i) const {
+            std::uint8_t state = states()[i];
+            return {times()[i], tags()[i], static_cast<AlarmState>(state >> 4),
+                    static_cast<AlarmState>(state & 0x0F), priorities()[i], 0, values()[i]};
+        }
+    };
+
+    std::string directory;
+    TimestampNs partitionLength = 24LL * 3600 * NS_PER_SECOND;
+
+    // Partition currently being appended to
+    std::int64_t currentId = 0;
+    int fds[COLUMN_COUNT] = {-1, -1, -1, -1, -1};
+    TimestampNs lastTime = 0;
+    bool currentSorted = true;
+    std::vector<TimestampNs> bufferTimes;
+    std::vector<TagId> bufferTags;
+    std::vector<std::uint8_t> bufferStates;
+    std::vector<AlarmPriority> bufferPriorities;
+    std::vector<double> bufferValues;
+    bool writeFailed = false;
+
+    std::string partitionPath(std::int64_t id, const char* suffix) const {
+        return directory + "/p" + std::to_string(id) + "." + suffix;
+    }
+
+    std::int64_t partitionOf(TimestampNs time) const {
+        std::int64_t id = time / partitionLength;
+        return (time % partitionLength < 0) ? id - 1 : id;
+    }
+
+    static bool writeColumn(int fd, const void* data, std::size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t n = ::write(fd, bytes, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            bytes += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    void flushBuffers() {
+        if (bufferTimes.empty()) {
+            return;
+        }
+        bool ok = writeColumn(fds[0], bufferTimes.data(), bufferTimes.size() * sizeof(TimestampNs));
+        ok = writeColumn(fds[1], bufferTags.data(), bufferTags.size() * sizeof(TagId)) && ok;
+        ok = writeColumn(fds[2], bufferStates.data(), bufferStates.size()) && ok;
+        ok = writeColumn(fds[3], bufferPriorities.data(), bufferPriorities.size()) && ok;
+        ok = writeColumn(fds[4], bufferValues.data(), bufferValues.size() * sizeof(double)) && ok;
+        writeFailed = writeFailed || !ok;
+        bufferTimes.clear();
+        bufferTags.clear();
+        bufferStates.clear();
+        bufferPriorities.clear();
+        bufferValues.clear();
+    }
+
+    bool isWriting() const { return fds[0] >= 0; }
+
+    void beginPartition(std::int64_t id) {
+        currentId = id;
+        // Appending invalidates any index written when the partition was last sealed
+        std::remove(partitionPath(id, "tagidx").c_str());
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            fds[c] = ::open(partitionPath(id, COLUMN_NAMES[c]).c_str(),
+                            O_WRONLY | O_CREAT | O_APPEND, 0644);
+            writeFailed = writeFailed || fds[c] < 0;
+        }
+        // Cut columns left uneven by a crash or a failed write back to the
+        // rows all of them hold, so appended rows line up again
+        std::size_t rows = SIZE_MAX;
+        struct stat info;
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            rows = std::min<std::size_t>(rows, fds[c] >= 0 && ::fstat(fds[c], &info) == 0
+                                                   ? static_cast<std::size_t>(info.st_size) / COLUMN_SIZES[c] : 0);
+        }
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            if (fds[c] >= 0 && ::fstat(fds[c], &info) == 0 &&
+                static_cast<std::size_t>(info.st_size) != rows * COLUMN_SIZES[c]) {
+                writeFailed = ::ftruncate(fds[c], static_cast<off_t>(rows * COLUMN_SIZES[c])) != 0 || writeFailed;
+            }
+        }
+        currentSorted = !std::filesystem::exists(partitionPath(id, "unsorted"));
+        lastTime = INT64_MIN;
+        MappedFile existing;
+        existing.map(partitionPath(id, "time"));
+        if (existing.size() >= sizeof(TimestampNs)) {
+            lastTime = existing.as<TimestampNs>()[existing.size() / sizeof(TimestampNs) - 1];
+        }
+    }
+
+    void sealPartition() {
+        if (!isWriting()) {
+            return;
+        }
+        flushBuffers();
+        for (int& fd : fds) {
+            ::close(fd);
+            fd = -1;
+        }
+        if (!currentSorted) {
+            int marker = ::open(partitionPath(currentId, "unsorted").c_str(), O_WRONLY | O_CREAT, 0644);
+            if (marker >= 0) {
+                ::close(marker);
+            }
+        }
+        writeFailed = !writeTagIndex(currentId) || writeFailed;
+    }
+
+    // Counting sort of row numbers by tag: offsets[tag]..offsets[tag+1] in rows
+    static void buildTagIndex(const TagId* tags, std::size_t rowCount,
+                              std::vector<std::uint32_t>& offsets, std::vector<std::uint32_t>& rows) {
+        TagId maxTag = 0;
+        for (std::size_t i = 0; i < rowCount; i++) {
+            maxTag = std::max(maxTag, tags[i]);
+        }
+        offsets.assign(rowCount == 0 ? 1 : static_cast<std::size_t>(maxTag) + 2, 0);
+        for (std::size_t i = 0; i < rowCount; i++) {
+            offsets[tags[i] + 1]++;
+        }
+        for (std::size_t t = 1; t < offsets.size(); t++) {
+            offsets[t] += offsets[t - 1];
+        }
+        rows.resize(rowCount);
+        std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < rowCount; i++) {
+            rows[cursor[tags[i]]++] = static_cast<std::uint32_t>(i);
+        }
+    }
+
+    bool writeTagIndex(std::int64_t id) const {
+        MappedFile timeColumn;
+        MappedFile tagColumn;
+        timeColumn.map(partitionPath(id, "time"));
+        tagColumn.map(partitionPath(id, "tag"));
+        std::size_t rowCount = std::min(timeColumn.size() / sizeof(TimestampNs), tagColumn.size() / sizeof(TagId));
+        std::vector<std::uint32_t> offsets, rows;
+        buildTagIndex(tagColumn.as<TagId>(), rowCount, offsets, rows);
+
+        TagIndexHeader header{};
+        std::memcpy(header.magic, "ISA182X", 8);
+        header.tagCount = static_cast<std::uint32_t>(offsets.size() - 1);
+        header.rowCount = static_cast<std::uint32_t>(rowCount);
+        std::string path = partitionPath(id, "tagidx");
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        bool ok = writeColumn(fd, &header, sizeof(header)) &&
+                  writeColumn(fd, offsets.data(), offsets.size() * sizeof(std::uint32_t)) &&
+                  writeColumn(fd, rows.data(), rows.size() * sizeof(std::uint32_t));
+        ok = ::close(fd) == 0 && ok;
+        if (!ok) {
+            // Queries rebuild a missing index in memory; a partial one must not stay
+            std::remove(path.c_str());
+        }
+        return ok;
+    }
+
+    bool mapPartition(std::int64_t id, PartitionView& view) const {
+        view.id = id;
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            if (!view.columns[c].map(partitionPath(id, COLUMN_NAMES[c]))) {
+                return false;
+            }
+        }
+        // A column cut short (crash, failed write) limits the rows of all of them
+        view.rows = SIZE_MAX;
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            view.rows = std::min(view.rows, view.columns[c].size() / COLUMN_SIZES[c]);
+        }
+        view.sorted = !std::filesystem::exists(partitionPath(id, "unsorted")) &&
+                      !(isWriting() && id == currentId && !currentSorted);
+        return true;
+    }
+
+    // Partitions overlapping [from, to), sorted by start time (id * partitionLength)
+    std::vector<std::int64_t> partitionsInRange(TimestampNs from, TimestampNs to) const {
+        std::vector<std::int64_t> ids;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            std::string name = entry.path().filename().string();
+            if (name.size() > 6 && name[0] == 'p' && name.compare(name.size() - 5, 5, ".time") == 0) {
+                // Stray files that only look like partitions are skipped
+                std::int64_t id = 0;
+                const char* first = name.data() + 1;
+                const char* last = name.data() + name.size() - 5;
+                auto parsed = std::from_chars(first, last, id);
+                if (parsed.ec != std::errc() || parsed.ptr != last) {
+                    continue;
+                }
+                if ((id + 1) * partitionLength > from && id * partitionLength < to) {
+                    ids.push_back(id);
+                }
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    // Row range of a partition inside [from, to)
+    static void rowRange(const PartitionView& view, TimestampNs from, TimestampNs to,
+                         std::size_t& first, std::size_t& last) {
+        if (!view.sorted) {
+            first = 0;
+            last = view.rows;
+            return;
+        }
+        const TimestampNs* begin = view.times();
+        const TimestampNs* end = begin + view.rows;
+        first = static_cast<std::size_t>(std::lower_bound(begin, end, from) - begin);
+        last = static_cast<std::size_t>(std::lower_bound(begin, end, to) - begin);
+    }
+
+public:
+    explicit AlarmHistory(TimestampNs partitionNs = 24LL * 3600 * NS_PER_SECOND)
+        : partitionLength(partitionNs) {}
+
+    ~AlarmHistory() { close(); }
+
+    AlarmHistory(const AlarmHistory&) = delete;
+    AlarmHistory& operator=(const AlarmHistory&) = delete;
+
+    // Open a history directory, creating it unless this is a read-only query
+    bool open(const std::string& path, bool create = true) {
+        close();
+        std::error_code error;
+        if (create) {
+            std::filesystem::create_directories(path, error);
+        }
+        directory = path;
+        return std::filesystem::is_directory(path, error);
+    }
+
+    // Seal the partition being written (flush and write its tag index);
+    // false if any write since open() failed
+    bool close() {
+        sealPartition();
+        bool ok = !writeFailed;
+        writeFailed = false;
+        return ok;
+    }
+
+    // True once a column, index or truncation write has failed since open()
+    bool failed() const { return writeFailed; }
+
+    // Append one transition; records should arrive in time order
+    void append(const JournalRecord& record) {
+        std::int64_t id = partitionOf(record.time);
+        if (!isWriting() || id != currentId) {
+            sealPartition();
+            beginPartition(id);
+        }
+        if (record.time < lastTime) {
+            currentSorted = false;
+        }
+        lastTime = record.time;
+        bufferTimes.push_back(record.time);
+        bufferTags.push_back(record.tag);
+        bufferStates.push_back(static_cast<std::uint8_t>(
+            (static_cast<unsigned>(record.oldState) << 4) | static_cast<unsigned>(record.newState)));
+        bufferPriorities.push_back(record.priority);
+        bufferValues.push_back(record.value);
+        if (bufferTimes.size() >= WRITE_BUFFER_ROWS) {
+            flushBuffers();
+        }
+    }
+
+    void append(const JournalRecord* records, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            append(records[i]);
+        }
+    }
+
+    // Visit every transition in [from, to), in time order within each partition
+    std::size_t forEachInRange(TimestampNs from, TimestampNs to,
+                               const std::function<void(const JournalRecord&)>& visit) {
+        flushBuffers();
+        std::size_t visited = 0;
+        for (std::int64_t id : partitionsInRange(from, to)) {
+            PartitionView view;
+            if (!mapPartition(id, view)) {
+                continue;
+            }
+            std::size_t first, last;
+            rowRange(view, from, to, first, last);
+            for (std::size_t i = first; i < last; i++) {
+                TimestampNs time = view.times()[i];
+                if (time >= from && time < to) {
+                    visit(view.row(i));
+                    visited++;
+                }
+            }
+        }
+        return visited;
+    }
+
+    // Visit the transitions of one tag in [from, to) through the per-tag index
+    std::size_t forEachForTag(TagId tag, TimestampNs from, TimestampNs to,
+                              const std::function<void(const JournalRecord&)>& visit) {
+        flushBuffers();
+        std::size_t visited = 0;
+        for (std::int64_t id : partitionsInRange(from, to)) {
+            PartitionView view;
+            if (!mapPartition(id, view)) {
+                continue;
+            }
+            MappedFile indexFile;
+            indexFile.map(partitionPath(id, "tagidx"));
+            const std::uint32_t* offsets = nullptr;
+            const std::uint32_t* rows = nullptr;
+            std::uint32_t tagCount = 0;
+            std::vector<std::uint32_t> builtOffsets, builtRows;
+            if (indexFile.size() >= sizeof(TagIndexHeader) &&
+                indexFile.as<TagIndexHeader>()->rowCount == view.rows &&
+                indexFile.size() == sizeof(TagIndexHeader) + (std::size_t(indexFile.as<TagIndexHeader>()->tagCount) +
+                                                              1 + view.rows) * sizeof(std::uint32_t)) {
+                const TagIndexHeader* header = indexFile.as<TagIndexHeader>();
+                tagCount = header->tagCount;
+                offsets = reinterpret_cast<const std::uint32_t*>(header + 1);
+                rows = offsets + tagCount + 1;
+            } else {
+                // Partition still open (or index lost): index it in memory
+                buildTagIndex(view.tags(), view.rows, builtOffsets, builtRows);
+                tagCount = static_cast<std::uint32_t>(builtOffsets.size() - 1);
+                offsets = builtOffsets.data();
+                rows = builtRows.data();
+            }
+            if (tag >= tagCount) {
+                continue;
+            }
+            // A corrupt index must not send us past the mapped columns
+            std::uint32_t begin = offsets[tag];
+            std::uint32_t end = offsets[tag + 1];
+            bool inRange = begin <= end && end <= view.rows;
+            for (std::uint32_t k = begin; inRange && k < end; k++) {
+                inRange = rows[k] < view.rows;
+            }
+            if (!inRange) {
+                continue;
+            }
+            for (std::uint32_t k = begin; k < end; k++) {
+                TimestampNs time = view.times()[rows[k]];
+                if (time >= from && time < to) {
+                    visit(view.row(rows[k]));
+                    visited++;
+                }
+            }
+        }
+        return visited;
+    }
+
+    // ISA-18.2 KPIs over [from, to) in a single streaming pass. Alarm load is
+    // assumed to be shared evenly by the given number of operator positions.
+    AlarmKpiReport computeKpis(TimestampNs from, TimestampNs to, int operators = 1) {
+        constexpr TimestampNs TEN_MINUTES = 600 * NS_PER_SECOND;
+        constexpr TimestampNs CHATTER_WINDOW = 60 * NS_PER_SECOND;
+        constexpr TimestampNs STALE_AFTER = 24LL * 3600 * NS_PER_SECOND;
+        constexpr double FLOOD_THRESHOLD = 10.0;
+
+        flushBuffers();
+        AlarmKpiReport report;
+        report.from = from;
+        report.to = to;
+        operators = std::max(operators, 1);
+        if (to <= from) {
+            return report;
+        }
+
+        std::size_t periodCount = static_cast<std::size_t>((to - from + TEN_MINUTES - 1) / TEN_MINUTES);
+        std::vector<std::uint32_t> perPeriod(periodCount, 0);
+
+        // Per-tag running state, sized on demand by tag ID
+        std::vector<std::uint32_t> activationCount;
+        std::vector<TimestampNs> previous1, previous2, activeSince;
+        std::vector<std::uint8_t> chattering;
+
+        for (std::int64_t id : partitionsInRange(from, to)) {
+            PartitionView view;
+            if (!mapPartition(id, view)) {
+                continue;
+            }
+            std::size_t first, last;
+            rowRange(view, from, to, first, last);
+            const TimestampNs* times = view.times();
+            const TagId* tags = view.tags();
+            const std::uint8_t* states = view.states();
+            // Chatter and standing alarms need each tag's transitions in time
+            // order: walk an out-of-order partition through a sorted row list
+            std::vector<std::uint32_t> order;
+            if (!view.sorted) {
+                order.resize(last - first);
+                for (std::size_t i = first; i < last; i++) {
+                    order[i - first] = static_cast<std::uint32_t>(i);
+                }
+                std::stable_sort(order.begin(), order.end(), [times](std::uint32_t a, std::uint32_t b) {
+                    return times[a] < times[b];
+                });
+            }
+            for (std::size_t n = first; n < last; n++) {
+                std::size_t i = view.sorted ? n : order[n - first];
+                TimestampNs time = times[i];
+                if (time < from || time >= to) {
+                    continue;
+                }
+                report.transitions++;
+                TagId tag = tags[i];
+                if (tag >= activationCount.size()) {
+                    std::size_t size = std::max<std::size_t>(tag + 1, activationCount.size() * 2);
+                    activationCount.resize(size, 0);
+                    previous1.resize(size, INT64_MIN / 2);
+                    previous2.resize(size, INT64_MIN / 2);
+                    activeSince.resize(size, 0);
+                    chattering.resize(size, 0);
+                }
+                AlarmState oldState = static_cast<AlarmState>(states[i] >> 4);
+                AlarmState newState = static_cast<AlarmState>(states[i] & 0x0F);
+                if (oldState == AlarmState::NORMAL && newState == AlarmState::UNACKNOWLEDGED) {
+                    report.activations++;
+                    activationCount[tag]++;
+                    perPeriod[static_cast<std::size_t>((time - from) / TEN_MINUTES)]++;
+                    if (time - previous2[tag] <= CHATTER_WINDOW) {
+                        chattering[tag] = 1;
+                    }
+                    previous2[tag] = previous1[tag];
+                    previous1[tag] = time;
+                    activeSince[tag] = time;
+                } else if (newState != AlarmState::UNACKNOWLEDGED &&
+                           newState != AlarmState::ACKNOWLEDGED) {
+                    activeSince[tag] = 0;
+                }
+            }
+        }
+
+        report.tenMinutePeriods = static_cast<std::uint32_t>(periodCount);
+        std::uint32_t peak = 0;
+        for (std::uint32_t count : perPeriod) {
+            peak = std::max(peak, count);
+            if (count / static_cast<double>(operators) > FLOOD_THRESHOLD) {
+                report.floodPeriods++;
+            }
+        }
+        if (periodCount != 0) {
+            report.averagePer10MinPerOperator =
+                static_cast<double>(report.activations) / periodCount / operators;
+            report.percentTimeInFlood = 100.0 * report.floodPeriods / periodCount;
+        }
+        report.peakPer10MinPerOperator = static_cast<double>(peak) / operators;
+
+        std::vector<AlarmKpiReport::BadActor> actors;
+        for (std::size_t tag = 0; tag < activationCount.size(); tag++) {
+            report.chatteringTags += chattering[tag];
+            if (activeSince[tag] != 0 && to - activeSince[tag] >= STALE_AFTER) {
+                report.staleAlarms++;
+            }
+            if (activationCount[tag] != 0) {
+                actors.push_back({static_cast<TagId>(tag), activationCount[tag]});
+            }
+        }
+        std::size_t top = std::min<std::size_t>(10, actors.size());
+        std::partial_sort(actors.begin(), actors.begin() + top, actors.end(),
+                          [](const AlarmKpiReport::BadActor& a, const AlarmKpiReport::BadActor& b) {
+                              return a.activations > b.activations ||
+                                     (a.activations == b.activations && a.tag < b.tag);
+                          });
+        actors.resize(top);
+        report.topBadActors = std::move(actors);
+        return report;
+    }
+};
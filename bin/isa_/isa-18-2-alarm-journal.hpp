@@ -0,0 +1,358 @@
+/**
+ * ISA-18.2 Alarm Event Journal
+ * Binary, append-only record of alarm state changes. The evaluation loop
+ * only pushes fixed-size records into a lock-free ring; a background thread
+ * writes them to the file in groups (one write per batch) and applies the
+ * configured fsync policy, so console or disk I/O never stalls evaluation.
+ * An audit trail must not lose events: appendWait() holds the producer while
+ * the ring is full instead of dropping, and close() drains every accepted
+ * record before it returns.
+ *
+ * File layout: a 16-byte header ("ISA182J" + version, record size) followed
+ * by JournalRecord entries in host byte order. POSIX file I/O.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "isa-clock.hpp"
+#include "isa-tag-registry.hpp"
+#include "isa-18-2-alarm-types.hpp"
+#include "isa-18-2-ingest-queue.hpp"
+
+// One alarm state change (24 bytes on disk)
+struct JournalRecord {
+    TimestampNs time;
+    TagId tag;
+    AlarmState oldState;
+    AlarmState newState;
+    AlarmPriority priority;
+    std::uint8_t reserved;
+    double value;       // process value at the transition, NaN for operator actions
+};
+
+static_assert(sizeof(JournalRecord) == 24, "journal record layout is part of the file format");
+
+enum class FsyncPolicy {
+    NEVER,          // leave durability to the OS page cache
+    EVERY_BATCH,    // fsync after every group commit
+    INTERVAL        // fsync at most once per configured interval
+};
+
+struct JournalHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+};
+
+constexpr char JOURNAL_MAGIC[8] = {'I', 'S', 'A', '1', '8', '2', 'J', '\0'};
+constexpr std::uint32_t JOURNAL_VERSION = 1;
+
+class AlarmJournal {
+public:
+    // Receives each group commit on the writer thread (e.g. to feed AlarmHistory)
+    using BatchListener = std::function<void(const JournalRecord*, std::size_t)>;
+
+private:
+    int fd = -1;
+    BatchListener listener;
+    FsyncPolicy fsyncPolicy;
+    std::chrono::milliseconds fsyncInterval;
+    std::size_t batchSize;
+
+    BoundedMpscQueue<JournalRecord> queue;
+    std::thread writer;
+    std::atomic<bool> running{false};
+    std::atomic<int> appending{0};      // producers inside append()/appendWait()
+
+    std::atomic<std::uint64_t> appended{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint64_t> backpressureWaits{0};
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<std::uint64_t> commits{0};
+    std::atomic<std::uint64_t> syncs{0};
+    std::atomic<bool> writeFailed{false};
+
+    std::mutex flushLock;
+    std::condition_variable flushed;
+
+    static bool writeAll(int file, const void* data, std::size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t n = ::write(file, bytes, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            bytes += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    void run() {
+        std::vector<JournalRecord> batch(batchSize);
+        auto lastSync = std::chrono::steady_clock::now();
+        bool dirty = false;
+        int idlePolls = 0;
+        bool settled = false;
+        for (;;) {
+            bool stopping = !running.load(std::memory_order_acquire);
+            std::size_t count = queue.popBatch(batch.data(), batch.size());
+            if (count != 0) {
+                // Group commit: the whole batch goes out in one write
+                if (!writeAll(fd, batch.data(), count * sizeof(JournalRecord))) {
+                    writeFailed.store(true, std::memory_order_relaxed);
+                }
+                if (listener) {
+                    listener(batch.data(), count);
+                }
+                commits.fetch_add(1, std::memory_order_relaxed);
+                dirty = true;
+                idlePolls = 0;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            bool syncNow = dirty &&
+                ((fsyncPolicy == FsyncPolicy::EVERY_BATCH) ||
+                 (fsyncPolicy == FsyncPolicy::INTERVAL && now - lastSync >= fsyncInterval) ||
+                 (fsyncPolicy != FsyncPolicy::NEVER && count == 0 && stopping));
+            if (syncNow) {
+                ::fsync(fd);
+                syncs.fetch_add(1, std::memory_order_relaxed);
+                lastSync = now;
+                dirty = false;
+            }
+
+            if (count != 0) {
+                {
+                    std::lock_guard<std::mutex> guard(flushLock);
+                    written.fetch_add(count, std::memory_order_release);
+                }
+                flushed.notify_all();
+                continue;
+            }
+            if (stopping) {
+                // Wait out producers that saw the journal running, then take
+                // one more pass for whatever they pushed
+                if (appending.load() != 0) {
+                    settled = false;
+                    std::this_thread::yield();
+                } else if (settled) {
+                    return;
+                } else {
+                    settled = true;
+                }
+                continue;
+            }
+            if (++idlePolls < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+    }
+
+public:
+    AlarmJournal(FsyncPolicy policy = FsyncPolicy::INTERVAL,
+                 std::chrono::milliseconds interval = std::chrono::milliseconds(1000),
+                 std::size_t capacity = 1 << 16, std::size_t maxBatch = 4096)
+        : fsyncPolicy(policy), fsyncInterval(interval), batchSize(maxBatch), queue(capacity) {}
+
+    ~AlarmJournal() { close(); }
+
+    AlarmJournal(const AlarmJournal&) = delete;
+    AlarmJournal& operator=(const AlarmJournal&) = delete;
+
+    // Open (or create) a journal file for appending and start the writer
+    // thread. A torn record left at the end by a crash is cut off first, so
+    // appended records stay on the record grid.
+    bool open(const std::string& path) {
+        close();
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        JournalHeader header{};
+        ssize_t n = ::pread(fd, &header, sizeof(header), 0);
+        if (n == 0) {
+            std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+            header.version = JOURNAL_VERSION;
+            header.recordSize = sizeof(JournalRecord);
+            if (!writeAll(fd, &header, sizeof(header))) {
+                close();
+                return false;
+            }
+        } else if (n != sizeof(header) ||
+                   std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0 ||
+                   header.recordSize != sizeof(JournalRecord)) {
+            close();
+            return false;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            close();
+            return false;
+        }
+        std::size_t records = (static_cast<std::size_t>(info.st_size) - sizeof(header)) / sizeof(JournalRecord);
+        off_t whole = static_cast<off_t>(sizeof(header) + records * sizeof(JournalRecord));
+        if (whole != info.st_size && ::ftruncate(fd, whole) != 0) {
+            close();
+            return false;
+        }
+        running.store(true, std::memory_order_release);
+        writer = std::thread(&AlarmJournal::run, this);
+        return true;
+    }
+
+    // Drain outstanding records, apply the final fsync and close the file.
+    // Threads blocked in flush() are released once the writer has finished.
+    void close() {
+        if (running.exchange(false)) {
+            writer.join();
+            {
+                std::lock_guard<std::mutex> guard(flushLock);
+            }
+            flushed.notify_all();
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    bool isOpen() const { return fd >= 0; }
+
+    // Set before open(); the listener runs on the writer thread only
+    void setBatchListener(BatchListener batchListener) {
+        listener = std::move(batchListener);
+    }
+
+    // Never blocks. Returns false (and counts a drop) if the journal is closed
+    // or the writer has fallen a full ring behind.
+    bool append(const JournalRecord& record) {
+        appending.fetch_add(1);
+        bool accepted = running.load() && queue.tryPush(record);
+        appending.fetch_sub(1);
+        (accepted ? appended : dropped).fetch_add(1, std::memory_order_relaxed);
+        return accepted;
+    }
+
+    bool append(TimestampNs time, TagId tag, AlarmState oldState, AlarmState newState,
+                AlarmPriority priority, double value) {
+        return append(JournalRecord{time, tag, oldState, newState, priority, 0, value});
+    }
+
+    // Append that waits for ring space instead of dropping (backpressure on
+    // the evaluation loop); false (a drop) only if the journal is closed
+    bool appendWait(const JournalRecord& record) {
+        appending.fetch_add(1);
+        bool accepted = false;
+        while (running.load() && !(accepted = queue.tryPush(record))) {
+            backpressureWaits.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+        appending.fetch_sub(1);
+        (accepted ? appended : dropped).fetch_add(1, std::memory_order_relaxed);
+        return accepted;
+    }
+
+    bool appendWait(TimestampNs time, TagId tag, AlarmState oldState, AlarmState newState,
+                    AlarmPriority priority, double value) {
+        return appendWait(JournalRecord{time, tag, oldState, newState, priority, 0, value});
+    }
+
+    // Wait until every record appended so far has been written
+    void flush() {
+        std::uint64_t target = appended.load(std::memory_order_relaxed);
+        std::unique_lock<std::mutex> guard(flushLock);
+        flushed.wait(guard, [&]() {
+            return written.load(std::memory_order_acquire) >= target ||
+                   !running.load(std::memory_order_acquire);
+        });
+    }
+
+    std::uint64_t appendedCount() const { return appended.load(std::memory_order_relaxed); }
+    std::uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+    std::uint64_t backpressureCount() const { return backpressureWaits.load(std::memory_order_relaxed); }
+    std::uint64_t writtenCount() const { return written.load(std::memory_order_relaxed); }
+    std::uint64_t commitCount() const { return commits.load(std::memory_order_relaxed); }
+    std::uint64_t syncCount() const { return syncs.load(std::memory_order_relaxed); }
+    bool hasWriteError() const { return writeFailed.load(std::memory_order_relaxed); }
+};
+
+// Read every record of a journal file; returns false if the file is not a journal.
+// A torn trailing record (crash mid-write) is ignored.
+inline bool readJournal(const std::string& path, std::vector<JournalRecord>& records) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    JournalHeader header{};
+    bool valid = ::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                 std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) == 0 &&
+                 header.recordSize == sizeof(JournalRecord);
+    if (valid) {
+        off_t size = ::lseek(fd, 0, SEEK_END);
+        std::size_t count = static_cast<std::size_t>(size - static_cast<off_t>(sizeof(header))) /
+                            sizeof(JournalRecord);
+        std::size_t first = records.size();
+        records.resize(first + count);
+        char* bytes = reinterpret_cast<char*>(records.data() + first);
+        std::size_t total = count * sizeof(JournalRecord);
+        std::size_t done = 0;
+        while (done < total) {
+            ssize_t n = ::pread(fd, bytes + done, total - done,
+                                static_cast<off_t>(sizeof(header) + done));
+            if (n <= 0) {
+                break;
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        records.resize(first + done / sizeof(JournalRecord));
+    }
+    ::close(fd);
+    return valid;
+}
+
+// Human-readable rendering of journal records. Tag names come from the
+// registry when one is supplied, otherwise tags are shown by ID.
+inline void renderJournal(const std::vector<JournalRecord>& records, std::ostream& out,
+                          const TagRegistry* tags = nullptr) {
+    char time[TimestampFormatter::BUFFER_SIZE];
+    for (const JournalRecord& record : records) {
+        TimestampFormatter::format(record.time, time);
+        out << "[" << time << "] ";
+        if (tags != nullptr && tags->contains(record.tag)) {
+            out << tags->name(record.tag);
+        } else {
+            out << "tag#" << record.tag;
+        }
+        out << " " << stateToString(record.oldState) << " -> " << stateToString(record.newState)
+            << " - Priority: " << priorityToString(record.priority);
+        if (!std::isnan(record.value)) {
+            out << " - Value: " << record.value;
+        }
+        out << "\n";
+    }
+}
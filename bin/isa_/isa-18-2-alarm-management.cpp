@@ -1,102 +1,95 @@
 /**
  * ISA-18.2 Simulation - Management of Alarm Systems
  * This program simulates an alarm management system following ISA-18.2 principles
+ *
+ * Build: g++ -std=c++17 -O2 [-mavx2] isa-18-2-alarm-management.cpp
+ * Usage: isa-18-2-alarm-management            run the simulation
+ *        isa-18-2-alarm-management --journal <file>
+ *                                             run the simulation, journaling alarm events
+ *        isa-18-2-alarm-management --journal <file> --history <dir>
+ *                                             ... and also record the events in a history store
+ *        isa-18-2-alarm-management --kpi <dir> [days] [operators]
+ *                                             ISA-18.2 performance report from a history store
+ *        isa-18-2-alarm-management --render <file>
+ *                                             print a journal in human-readable form
+ *        isa-18-2-alarm-management --config <file> [--snapshot <out>]
+ *                                             load alarms and I/O points from a configuration
+ *                                             file or snapshot, optionally writing a snapshot
+ *        isa-18-2-alarm-management --impact [tag]
+ *                                             fail a transmitter (default FT303) and suppress
+ *                                             the alarms it makes consequential
+ *        isa-18-2-alarm-management --bench [maxWorkers]
+ *                                             run the performance benchmarks and check the
+ *                                             sharded engine against a serial alarm table
  */
 
 #include <iostream>
 #include <vector>
 #include <string>
-#include <map>
+#include <array>
 #include <chrono>
 #include <iomanip>
 #include <algorithm>
+#include <random>
+#include <sstream>
+#include <limits>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 
-// Get current timestamp as string
-std::string getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto now_time = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&now_time), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
-}
-
-// ISA-18.2 defined alarm priorities
-enum class AlarmPriority {
-    LOW,
-    MEDIUM,
-    HIGH,
-    CRITICAL
-};
-
-// ISA-18.2 alarm states
-enum class AlarmState {
-    NORMAL,
-    UNACKNOWLEDGED,
-    ACKNOWLEDGED,
-    RETURNED_UNACKNOWLEDGED,
-    SHELVED,
-    SUPPRESSED,
-    OUT_OF_SERVICE
-};
-
-// Convert alarm priority to string
-std::string priorityToString(AlarmPriority priority) {
-    switch (priority) {
-        case AlarmPriority::LOW: return "LOW";
-        case AlarmPriority::MEDIUM: return "MEDIUM";
-        case AlarmPriority::HIGH: return "HIGH";
-        case AlarmPriority::CRITICAL: return "CRITICAL";
-        default: return "UNKNOWN";
-    }
-}
-
-// Convert alarm state to string
-std::string stateToString(AlarmState state) {
-    switch (state) {
-        case AlarmState::NORMAL: return "NORMAL";
-        case AlarmState::UNACKNOWLEDGED: return "UNACKNOWLEDGED";
-        case AlarmState::ACKNOWLEDGED: return "ACKNOWLEDGED";
-        case AlarmState::RETURNED_UNACKNOWLEDGED: return "RETURNED_UNACKNOWLEDGED";
-        case AlarmState::SHELVED: return "SHELVED";
-        case AlarmState::SUPPRESSED: return "SUPPRESSED";
-        case AlarmState::OUT_OF_SERVICE: return "OUT_OF_SERVICE";
-        default: return "UNKNOWN";
-    }
-}
+#include "isa-clock.hpp"
+#include "isa-tag-registry.hpp"
+#include "isa-18-2-alarm-types.hpp"
+#include "isa-18-2-alarm-arena.hpp"
+#include "isa-18-2-alarm-table.hpp"
+#include "isa-18-2-ingest-queue.hpp"
+#include "isa-18-2-sharded-engine.hpp"
+#include "isa-18-2-alarm-journal.hpp"
+#include "isa-18-2-alarm-history.hpp"
+#include "isa-18-2-suppression.hpp"
+#include "isa-18-2-timer-wheel.hpp"
+#include "isa-loop-graph.hpp"
+#include "isa-plant-config.hpp"
+#include "isa-61131-3-plc-memory.hpp"
 
-// Alarm class following ISA-18.2 recommendations
-class Alarm {
+// Evaluation state and ISA-18.2 transitions of one alarm, without its text.
+// The alarm system stores these hot records in a StablePool and keeps tag
+// and description elsewhere.
+class AlarmCore {
 private:
-    std::string tagName;
-    std::string description;
     AlarmPriority priority;
     AlarmState state;
     double setpoint;
     double deadband;
-    std::string timestamp;
-    std::string lastAckTimestamp;
+    TimestampNs activationTime;     // 0 until the first activation
+    TimestampNs lastAckTime;        // 0 until the first acknowledgement
     int occurrenceCount;
     bool isEnabled;
     bool isSuppressed;
     bool isShelved;
 
 public:
-    Alarm(const std::string& tag, const std::string& desc, 
-          AlarmPriority prio, double sp, double db)
-        : tagName(tag), description(desc), priority(prio), 
-          setpoint(sp), deadband(db), occurrenceCount(0),
-          isEnabled(true), isSuppressed(false), isShelved(false),
-          state(AlarmState::NORMAL) {}
+    AlarmCore(AlarmPriority prio, double sp, double db)
+        : priority(prio),
+          state(AlarmState::NORMAL), setpoint(sp), deadband(db),
+          activationTime(0), lastAckTime(0), occurrenceCount(0),
+          isEnabled(true), isSuppressed(false), isShelved(false) {}
+
+    // Records are built in place in the pool and never copied
+    AlarmCore(const AlarmCore&) = delete;
+    AlarmCore& operator=(const AlarmCore&) = delete;
+    AlarmCore(AlarmCore&&) = default;
+    AlarmCore& operator=(AlarmCore&&) = default;
 
-    // Trigger an alarm condition
-    void trigger(double currentValue) {
+    // Trigger an alarm condition; now is the time of the sample
+    void trigger(double currentValue, TimestampNs now = clockNowNs()) {
         if (!isEnabled || isSuppressed || isShelved) {
             return;
         }
 
         if (currentValue >= setpoint && state == AlarmState::NORMAL) {
             state = AlarmState::UNACKNOWLEDGED;
-            timestamp = getCurrentTimestamp();
+            activationTime = now;
             occurrenceCount++;
         } else if (currentValue < (setpoint - deadband) && 
                   (state == AlarmState::ACKNOWLEDGED || state == AlarmState::UNACKNOWLEDGED)) {
@@ -108,10 +101,10 @@ public:
     void acknowledge() {
         if (state == AlarmState::UNACKNOWLEDGED) {
             state = AlarmState::ACKNOWLEDGED;
-            lastAckTimestamp = getCurrentTimestamp();
+            lastAckTime = clockNowNs();
         } else if (state == AlarmState::RETURNED_UNACKNOWLEDGED) {
             state = AlarmState::NORMAL;
-            lastAckTimestamp = getCurrentTimestamp();
+            lastAckTime = clockNowNs();
         }
     }
 
@@ -160,22 +153,29 @@ public:
     // Get alarm information
     AlarmState getState() const { return state; }
     AlarmPriority getPriority() const { return priority; }
-    std::string getTagName() const { return tagName; }
-    std::string getDescription() const { return description; }
-    std::string getTimestamp() const { return timestamp; }
+    double getSetpoint() const { return setpoint; }
+    double getDeadband() const { return deadband; }
+    TimestampNs getActivationTime() const { return activationTime; }
+    TimestampNs getLastAckTime() const { return lastAckTime; }
+    std::string getTimestamp() const {
+        return activationTime != 0 ? TimestampFormatter::format(activationTime) : std::string();
+    }
     int getOccurrenceCount() const { return occurrenceCount; }
 
     // Print alarm details
-    void print() const {
+    void print(std::string_view tagName, std::string_view description) const {
         std::cout << "Alarm: " << tagName << " (" << description << ")\n";
         std::cout << "  Priority: " << priorityToString(priority) << "\n";
         std::cout << "  State: " << stateToString(state) << "\n";
         std::cout << "  Setpoint: " << setpoint << " (Deadband: " << deadband << ")\n";
-        if (!timestamp.empty()) {
-            std::cout << "  Triggered: " << timestamp << "\n";
+        char buffer[TimestampFormatter::BUFFER_SIZE];
+        if (activationTime != 0) {
+            TimestampFormatter::format(activationTime, buffer);
+            std::cout << "  Triggered: " << buffer << "\n";
         }
-        if (!lastAckTimestamp.empty()) {
-            std::cout << "  Last Acknowledged: " << lastAckTimestamp << "\n";
+        if (lastAckTime != 0) {
+            TimestampFormatter::format(lastAckTime, buffer);
+            std::cout << "  Last Acknowledged: " << buffer << "\n";
         }
         std::cout << "  Occurrence Count: " << occurrenceCount << "\n";
         std::cout << "  Enabled: " << (isEnabled ? "Yes" : "No") << "\n";
@@ -184,96 +184,506 @@ public:
     }
 };
 
+// Alarm class following ISA-18.2 recommendations: a standalone alarm that
+// owns its tag and description
+class Alarm : public AlarmCore {
+private:
+    std::string tagName;
+    std::string description;
+
+public:
+    Alarm(std::string_view tag, std::string_view desc,
+          AlarmPriority prio, double sp, double db)
+        : AlarmCore(prio, sp, db), tagName(tag), description(desc) {}
+
+    Alarm(const Alarm&) = delete;
+    Alarm& operator=(const Alarm&) = delete;
+    Alarm(Alarm&&) = default;
+    Alarm& operator=(Alarm&&) = default;
+
+    const std::string& getTagName() const { return tagName; }
+    std::string getDescription() const { return description; }
+
+    void print() const { AlarmCore::print(tagName, description); }
+};
+
 // Alarm Management System following ISA-18.2 principles
 class AlarmManagementSystem {
 private:
-    std::vector<Alarm> alarms;
-    std::map<AlarmPriority, int> alarmCounts;
+    static constexpr size_t NO_ALARM = static_cast<size_t>(-1);
+    static constexpr size_t PRIORITY_COUNT = 4;
+
+    // Hot evaluation records, never moved once created; descriptions (cold)
+    // live in the arena and tags in the registry
+    StablePool<AlarmCore> alarms;
+    StringArena text;
+    std::vector<std::string_view> descriptions;
+    std::array<int, PRIORITY_COUNT> alarmCounts;    // annunciated alarms by priority
     int maxActiveAlarms;
     int currentActiveAlarms;
 
+    // Intrusive list of alarms shown in the summary (any state but NORMAL/OUT_OF_SERVICE),
+    // linked by alarm slot in the order they entered it
+    std::vector<size_t> listedPrev;
+    std::vector<size_t> listedNext;
+    size_t listedHead = NO_ALARM;
+    size_t listedTail = NO_ALARM;
+
+    // Interned tag index: one tag maps to every alarm configured on it (HI/HIHI/LO on the same PV)
+    TagRegistry tags;
+    std::vector<std::vector<size_t>> alarmsByTag;
+
+    // Event journal; when attached, transitions are journaled instead of printed
+    AlarmJournal* journal = nullptr;
+
+    // Alarm timers run on one hierarchical wheel; each alarm owns TIMER_KINDS
+    // consecutive timer IDs, so arming a timer never allocates
+    enum TimerKind : uint32_t { SHELVE_EXPIRY, ON_DELAY, OFF_DELAY, RETRIGGER_BLOCK, TIMER_KINDS };
+    static constexpr TimestampNs TIMER_TICK_NS = NS_PER_SECOND / 100;
+
+    // On-delay/off-delay and re-trigger (chatter) filtering, in wheel ticks
+    struct AlarmTiming {
+        uint32_t onDelay = 0;
+        uint32_t offDelay = 0;
+        uint32_t retrigger = 0;
+        bool filtered() const { return onDelay != 0 || offDelay != 0 || retrigger != 0; }
+    };
+
+    TimerWheel timers;
+    TimestampNs timerClock = 0;         // time of wheel tick now(), 0 until the first processTimers()
+    std::vector<TagId> alarmTags;
+    std::vector<AlarmTiming> timing;
+    std::vector<double> lastValues;     // last sample seen by filtered alarms
+    uint64_t chatterBlocked = 0;
+
+    // Annunciated alarms: raised and not yet cleared by acknowledgement
+    static bool isAnnunciated(AlarmState state) {
+        return state == AlarmState::UNACKNOWLEDGED ||
+               state == AlarmState::ACKNOWLEDGED ||
+               state == AlarmState::RETURNED_UNACKNOWLEDGED;
+    }
+
+    static bool isListed(AlarmState state) {
+        return state != AlarmState::NORMAL && state != AlarmState::OUT_OF_SERVICE;
+    }
+
+    void linkListed(size_t index) {
+        listedPrev[index] = listedTail;
+        listedNext[index] = NO_ALARM;
+        if (listedTail != NO_ALARM) {
+            listedNext[listedTail] = index;
+        } else {
+            listedHead = index;
+        }
+        listedTail = index;
+    }
+
+    void unlinkListed(size_t index) {
+        size_t prev = listedPrev[index];
+        size_t next = listedNext[index];
+        if (prev != NO_ALARM) {
+            listedNext[prev] = next;
+        } else {
+            listedHead = next;
+        }
+        if (next != NO_ALARM) {
+            listedPrev[next] = prev;
+        } else {
+            listedTail = prev;
+        }
+    }
+
+    // Single bookkeeping point for every state change: counters, summary list, journal
+    void recordTransition(TagId id, size_t index, AlarmState oldState, double value,
+                          TimestampNs time = clockNowNs()) {
+        const AlarmCore& alarm = alarms[index];
+        AlarmState newState = alarm.getState();
+        if (newState == oldState) {
+            return;
+        }
+
+        int delta = int(isAnnunciated(newState)) - int(isAnnunciated(oldState));
+        currentActiveAlarms += delta;
+        alarmCounts[static_cast<size_t>(alarm.getPriority())] += delta;
+
+        if (isListed(newState) && !isListed(oldState)) {
+            linkListed(index);
+        } else if (!isListed(newState) && isListed(oldState)) {
+            unlinkListed(index);
+        }
+
+        if (journal != nullptr) {
+            journal->appendWait(time, id, oldState, newState, alarm.getPriority(), value);
+        }
+    }
+
+    void logActivation(size_t index, AlarmState oldState, double value) const {
+        const AlarmCore& alarm = alarms[index];
+        if (journal == nullptr && oldState == AlarmState::NORMAL &&
+            alarm.getState() == AlarmState::UNACKNOWLEDGED) {
+            std::cout << "[ALARM TRIGGERED] " << tagName(index) 
+                      << " - " << descriptions[index] 
+                      << " - Priority: " << priorityToString(alarm.getPriority())
+                      << " - Value: " << value << "\n";
+        }
+    }
+
+    static TimerWheel::TimerId timerId(size_t index, TimerKind kind) {
+        return static_cast<TimerWheel::TimerId>(index * TIMER_KINDS + kind);
+    }
+
+    static uint32_t toTicks(TimestampNs duration) {
+        if (duration <= 0) {
+            return 0;
+        }
+        TimestampNs ticks = (duration + TIMER_TICK_NS - 1) / TIMER_TICK_NS;
+        return static_cast<uint32_t>(std::min<TimestampNs>(ticks, std::numeric_limits<uint32_t>::max()));
+    }
+
+    // Evaluate a sample through the delay and re-trigger filters: the alarm
+    // only annunciates (or returns) once its condition has held for the delay
+    void filterValue(size_t index, double value, TimestampNs time = clockNowNs()) {
+        AlarmCore& alarm = alarms[index];
+        const AlarmTiming& config = timing[index];
+        double previous = lastValues[index];
+        lastValues[index] = value;
+
+        AlarmState state = alarm.getState();
+        if (state == AlarmState::NORMAL) {
+            if (value < alarm.getSetpoint()) {
+                timers.cancel(timerId(index, ON_DELAY));
+            } else if (timers.isScheduled(timerId(index, RETRIGGER_BLOCK))) {
+                chatterBlocked += previous < alarm.getSetpoint() || std::isnan(previous);
+            } else if (config.onDelay == 0) {
+                alarm.trigger(value, time);
+            } else if (!timers.isScheduled(timerId(index, ON_DELAY))) {
+                timers.schedule(timerId(index, ON_DELAY), config.onDelay);
+            }
+        } else if (state == AlarmState::UNACKNOWLEDGED || state == AlarmState::ACKNOWLEDGED) {
+            if (value >= alarm.getSetpoint() - alarm.getDeadband()) {
+                timers.cancel(timerId(index, OFF_DELAY));
+            } else if (config.offDelay == 0) {
+                returnToNormal(index, value, time);
+            } else if (!timers.isScheduled(timerId(index, OFF_DELAY))) {
+                timers.schedule(timerId(index, OFF_DELAY), config.offDelay);
+            }
+        }
+    }
+
+    void returnToNormal(size_t index, double value, TimestampNs time = clockNowNs()) {
+        alarms[index].trigger(value, time);
+        if (alarms[index].getState() == AlarmState::RETURNED_UNACKNOWLEDGED && timing[index].retrigger != 0) {
+            timers.schedule(timerId(index, RETRIGGER_BLOCK), timing[index].retrigger);
+        }
+    }
+
+    // Timer expiry: called by the wheel for each due timer, stamped with the
+    // time the timer fell due rather than the time it is processed
+    void onTimer(TimerWheel::TimerId timer, TimestampNs time) {
+        size_t index = timer / TIMER_KINDS;
+        AlarmCore& alarm = alarms[index];
+        AlarmState oldState = alarm.getState();
+        double value = lastValues[index];
+        switch (static_cast<TimerKind>(timer % TIMER_KINDS)) {
+        case SHELVE_EXPIRY:
+            alarm.unshelve();
+            value = std::numeric_limits<double>::quiet_NaN();
+            if (journal == nullptr && alarm.getState() != oldState) {
+                std::cout << "[ALARM UNSHELVED] " << tagName(index) << "\n";
+            }
+            break;
+        case ON_DELAY:
+            if (oldState == AlarmState::NORMAL && value >= alarm.getSetpoint()) {
+                alarm.trigger(value, time);
+            }
+            break;
+        case OFF_DELAY:
+            if (value < alarm.getSetpoint() - alarm.getDeadband()) {
+                returnToNormal(index, value, time);
+            }
+            break;
+        case RETRIGGER_BLOCK:
+            // Condition still present once the block lapses: annunciate it now
+            if (oldState == AlarmState::NORMAL && value >= alarm.getSetpoint()) {
+                filterValue(index, value, time);
+            }
+            break;
+        default:
+            break;
+        }
+        recordTransition(alarmTags[index], index, oldState, value, time);
+        logActivation(index, oldState, value);
+    }
+
+    // Register the alarm just created in the pool: tag index, per-alarm
+    // columns, timers and the summary list
+    TagId indexAlarm(std::string_view tag, std::string_view description) {
+        size_t index = alarms.size() - 1;
+        TagId id = tags.intern(tag);
+        descriptions.push_back(text.store(description));
+        if (id >= alarmsByTag.size()) {
+            alarmsByTag.resize(id + 1);
+        }
+        alarmsByTag[id].push_back(index);
+        listedPrev.push_back(NO_ALARM);
+        listedNext.push_back(NO_ALARM);
+        alarmTags.push_back(id);
+        timing.emplace_back();
+        lastValues.push_back(std::numeric_limits<double>::quiet_NaN());
+        timers.resize(alarms.size() * TIMER_KINDS);
+        AlarmState state = alarms[index].getState();
+        if (isListed(state)) {
+            linkListed(index);
+        }
+        if (isAnnunciated(state)) {
+            currentActiveAlarms++;
+            alarmCounts[static_cast<size_t>(alarms[index].getPriority())]++;
+        }
+        return id;
+    }
+
 public:
     AlarmManagementSystem(int maxAlarms = 100) 
-        : maxActiveAlarms(maxAlarms), currentActiveAlarms(0) {
-        alarmCounts[AlarmPriority::LOW] = 0;
-        alarmCounts[AlarmPriority::MEDIUM] = 0;
-        alarmCounts[AlarmPriority::HIGH] = 0;
-        alarmCounts[AlarmPriority::CRITICAL] = 0;
+        : alarmCounts{}, maxActiveAlarms(maxAlarms), currentActiveAlarms(0) {}
+
+    // Construct an alarm in place and return its own handle. The handle, and
+    // references from alarm() and the views from tagName()/description(),
+    // stay valid for the lifetime of the system however many alarms follow.
+    AlarmId emplaceAlarm(std::string_view tag, std::string_view description, AlarmPriority priority,
+                         double setpoint, double deadband) {
+        AlarmId id = alarms.emplace(priority, setpoint, deadband);
+        indexAlarm(tag, description);
+        return id;
+    }
+
+    const AlarmCore& alarm(AlarmId id) const { return alarms[id]; }
+    TagId tagOf(AlarmId id) const { return alarmTags[id]; }
+    std::string_view tagName(AlarmId id) const { return tags.name(alarmTags[id]); }
+    std::string_view description(AlarmId id) const { return descriptions[id]; }
+    size_t size() const { return alarms.size(); }
+
+    // Bytes held for alarm records and their text (pool, arena, description views)
+    size_t alarmStorageBytes() const {
+        return alarms.bytes() + text.bytes() + descriptions.capacity() * sizeof(std::string_view);
+    }
+
+    // Pre-size the per-alarm storage before a bulk load
+    void reserveAlarms(size_t count) {
+        alarms.reserve(count);
+        descriptions.reserve(count);
+        listedPrev.reserve(count);
+        listedNext.reserve(count);
+        alarmTags.reserve(count);
+        timing.reserve(count);
+        lastValues.reserve(count);
+        tags.reserve(count);
+        alarmsByTag.reserve(count);
+        timers.resize(count * TIMER_KINDS);
     }
 
-    // Add a new alarm to the system
-    void addAlarm(const Alarm& alarm) {
-        alarms.push_back(alarm);
+    // Route alarm events to a journal (nullptr restores console logging)
+    void attachJournal(AlarmJournal* eventJournal) {
+        journal = eventJournal;
+    }
+
+    const TagRegistry& getTagRegistry() const { return tags; }
+
+    // Resolve a tag name to its stable numeric handle (INVALID_TAG_ID if unknown)
+    TagId resolveTag(const std::string& tag) const {
+        return tags.find(tag);
     }
 
     // Update a process value and check for alarms
     void updateProcessValue(const std::string& tag, double value) {
-        for (auto& alarm : alarms) {
-            if (alarm.getTagName() == tag) {
-                AlarmState oldState = alarm.getState();
-                alarm.trigger(value);
-                
-                // Check if alarm became active
-                if (oldState == AlarmState::NORMAL && 
-                    alarm.getState() == AlarmState::UNACKNOWLEDGED) {
-                    currentActiveAlarms++;
-                    alarmCounts[alarm.getPriority()]++;
-                    
-                    // Log alarm activation
-                    std::cout << "[ALARM TRIGGERED] " << alarm.getTagName() 
-                              << " - " << alarm.getDescription() 
-                              << " - Priority: " << priorityToString(alarm.getPriority())
-                              << " - Value: " << value << "\n";
-                }
+        TagId id = tags.find(tag);
+        if (id != INVALID_TAG_ID) {
+            updateProcessValue(id, value);
+        }
+    }
+
+    // Update a process value by tag handle (one lookup, no string compares);
+    // time is when the value was sampled and stamps any transition it causes
+    void updateProcessValue(TagId id, double value, TimestampNs time = clockNowNs()) {
+        if (!tags.contains(id)) {
+            return;
+        }
+        for (size_t index : alarmsByTag[id]) {
+            AlarmCore& alarm = alarms[index];
+            AlarmState oldState = alarm.getState();
+            if (timing[index].filtered()) {
+                filterValue(index, value, time);
+            } else {
+                alarm.trigger(value, time);
             }
+            recordTransition(id, index, oldState, value, time);
+            
+            // Log alarm activation
+            logActivation(index, oldState, value);
+        }
+    }
+
+    // Apply a batch of samples drained from a ProcessValueIngestor, each at its sample time
+    void updateProcessValues(const ProcessSample* samples, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            updateProcessValue(samples[i].tag, samples[i].value, samples[i].timestamp);
         }
     }
 
     // Acknowledge an alarm
     void acknowledgeAlarm(const std::string& tag) {
-        for (auto& alarm : alarms) {
-            if (alarm.getTagName() == tag) {
-                AlarmState oldState = alarm.getState();
-                alarm.acknowledge();
-                
-                // Check if alarm became inactive
-                if ((oldState == AlarmState::UNACKNOWLEDGED || 
-                     oldState == AlarmState::RETURNED_UNACKNOWLEDGED) && 
-                    alarm.getState() == AlarmState::NORMAL) {
-                    currentActiveAlarms--;
-                    alarmCounts[alarm.getPriority()]--;
-                }
-                
-                std::cout << "[ALARM ACKNOWLEDGED] " << alarm.getTagName() << "\n";
-                return;
+        TagId id = tags.find(tag);
+        if (id == INVALID_TAG_ID) {
+            std::cout << "[ERROR] Alarm tag not found: " << tag << "\n";
+            return;
+        }
+        acknowledgeAlarm(id);
+    }
+
+    // Acknowledge every alarm configured on a tag
+    void acknowledgeAlarm(TagId id) {
+        if (!tags.contains(id)) {
+            std::cout << "[ERROR] Alarm tag handle not found: " << id << "\n";
+            return;
+        }
+        for (size_t index : alarmsByTag[id]) {
+            AlarmCore& alarm = alarms[index];
+            AlarmState oldState = alarm.getState();
+            alarm.acknowledge();
+            recordTransition(id, index, oldState, std::numeric_limits<double>::quiet_NaN());
+            
+            if (journal == nullptr) {
+                std::cout << "[ALARM ACKNOWLEDGED] " << tagName(index) << "\n";
             }
         }
-        
-        std::cout << "[ERROR] Alarm tag not found: " << tag << "\n";
     }
 
     // Shelve an alarm
     void shelveAlarm(const std::string& tag) {
-        for (auto& alarm : alarms) {
-            if (alarm.getTagName() == tag) {
-                AlarmState oldState = alarm.getState();
-                alarm.shelve();
-                
-                // Check if alarm became inactive due to shelving
-                if (oldState != AlarmState::NORMAL && 
-                    oldState != AlarmState::SHELVED && 
-                    oldState != AlarmState::SUPPRESSED && 
-                    oldState != AlarmState::OUT_OF_SERVICE) {
-                    currentActiveAlarms--;
-                    alarmCounts[alarm.getPriority()]--;
-                }
-                
-                std::cout << "[ALARM SHELVED] " << alarm.getTagName() << "\n";
-                return;
+        TagId id = tags.find(tag);
+        if (id == INVALID_TAG_ID) {
+            std::cout << "[ERROR] Alarm tag not found: " << tag << "\n";
+            return;
+        }
+        shelveAlarm(id);
+    }
+
+    // Shelve every alarm configured on a tag
+    void shelveAlarm(TagId id) {
+        if (!tags.contains(id)) {
+            std::cout << "[ERROR] Alarm tag handle not found: " << id << "\n";
+            return;
+        }
+        for (size_t index : alarmsByTag[id]) {
+            AlarmCore& alarm = alarms[index];
+            AlarmState oldState = alarm.getState();
+            alarm.shelve();
+            timers.cancel(timerId(index, SHELVE_EXPIRY));
+            recordTransition(id, index, oldState, std::numeric_limits<double>::quiet_NaN());
+            
+            if (journal == nullptr) {
+                std::cout << "[ALARM SHELVED] " << tagName(index) << "\n";
+            }
+        }
+    }
+
+    // Timed shelving: the alarms return to service when the duration expires
+    void shelveAlarm(TagId id, TimestampNs duration) {
+        shelveAlarm(id);
+        if (!tags.contains(id)) {
+            return;
+        }
+        for (size_t index : alarmsByTag[id]) {
+            if (alarms[index].getState() == AlarmState::SHELVED) {
+                timers.schedule(timerId(index, SHELVE_EXPIRY), toTicks(duration));
+            }
+        }
+    }
+
+    // Return shelved alarms on a tag to service ahead of any shelving timer
+    void unshelveAlarm(TagId id) {
+        if (!tags.contains(id)) {
+            std::cout << "[ERROR] Alarm tag handle not found: " << id << "\n";
+            return;
+        }
+        for (size_t index : alarmsByTag[id]) {
+            AlarmCore& alarm = alarms[index];
+            AlarmState oldState = alarm.getState();
+            alarm.unshelve();
+            timers.cancel(timerId(index, SHELVE_EXPIRY));
+            recordTransition(id, index, oldState, std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+
+    // Configure on-delay, off-delay and re-trigger suppression for every alarm
+    // on a tag (0 disables each). Resolution is one timer tick (10 ms).
+    void setAlarmTiming(TagId id, TimestampNs onDelay, TimestampNs offDelay, TimestampNs retrigger) {
+        if (!tags.contains(id)) {
+            std::cout << "[ERROR] Alarm tag handle not found: " << id << "\n";
+            return;
+        }
+        for (size_t index : alarmsByTag[id]) {
+            timing[index] = AlarmTiming{toTicks(onDelay), toTicks(offDelay), toTicks(retrigger)};
+            if (!timing[index].filtered()) {
+                timers.cancel(timerId(index, ON_DELAY));
+                timers.cancel(timerId(index, OFF_DELAY));
+                timers.cancel(timerId(index, RETRIGGER_BLOCK));
             }
         }
-        
-        std::cout << "[ERROR] Alarm tag not found: " << tag << "\n";
+    }
+
+    // Advance alarm timers to now; call once per scan. Cost is O(elapsed ticks)
+    // plus the timers that expire, independent of the number of alarms.
+    void processTimers(TimestampNs now) {
+        if (timerClock == 0) {
+            timerClock = now;
+            return;
+        }
+        if (now <= timerClock) {
+            return;
+        }
+        uint64_t ticks = static_cast<uint64_t>((now - timerClock) / TIMER_TICK_NS);
+        TimestampNs base = timerClock;
+        uint64_t baseTick = timers.now();
+        timerClock += static_cast<TimestampNs>(ticks) * TIMER_TICK_NS;
+        timers.advance(ticks, [this, base, baseTick](TimerWheel::TimerId timer) {
+            onTimer(timer, base + static_cast<TimestampNs>(timers.now() - baseTick) * TIMER_TICK_NS);
+        });
+    }
+
+    size_t pendingTimerCount() const { return timers.size(); }
+    uint64_t chatterBlockedCount() const { return chatterBlocked; }
+
+    // Suppress (or unsuppress) every alarm configured on a tag. Bulk and
+    // state-based suppression of the columnar table lives in SuppressionEngine.
+    void suppressAlarm(TagId id, bool suppress = true) {
+        if (!tags.contains(id)) {
+            std::cout << "[ERROR] Alarm tag handle not found: " << id << "\n";
+            return;
+        }
+        for (size_t index : alarmsByTag[id]) {
+            AlarmCore& alarm = alarms[index];
+            AlarmState oldState = alarm.getState();
+            if (suppress) {
+                alarm.suppress();
+            } else {
+                alarm.unsuppress();
+            }
+            recordTransition(id, index, oldState, std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+
+    // Summary counters, maintained incrementally (cheap enough for HMI polling)
+    int activeAlarmCount() const { return currentActiveAlarms; }
+    int alarmCount(AlarmPriority priority) const {
+        return alarmCounts[static_cast<size_t>(priority)];
+    }
+
+    // Visit the handles of alarms in the summary list, O(listed) rather than O(configured)
+    template <typename Visitor>
+    void forEachListedAlarm(Visitor visit) const {
+        for (size_t index = listedHead; index != NO_ALARM; index = listedNext[index]) {
+            visit(static_cast<AlarmId>(index));
+        }
     }
 
     // Print alarm summary (ISA-18.2 recommended practice)
@@ -282,53 +692,1006 @@ public:
         std::cout << "Total Active Alarms: " << currentActiveAlarms 
                   << " (Max: " << maxActiveAlarms << ")\n";
         std::cout << "By Priority:\n";
-        std::cout << "  CRITICAL: " << alarmCounts.at(AlarmPriority::CRITICAL) << "\n";
-        std::cout << "  HIGH:     " << alarmCounts.at(AlarmPriority::HIGH) << "\n";
-        std::cout << "  MEDIUM:   " << alarmCounts.at(AlarmPriority::MEDIUM) << "\n";
-        std::cout << "  LOW:      " << alarmCounts.at(AlarmPriority::LOW) << "\n";
+        std::cout << "  CRITICAL: " << alarmCount(AlarmPriority::CRITICAL) << "\n";
+        std::cout << "  HIGH:     " << alarmCount(AlarmPriority::HIGH) << "\n";
+        std::cout << "  MEDIUM:   " << alarmCount(AlarmPriority::MEDIUM) << "\n";
+        std::cout << "  LOW:      " << alarmCount(AlarmPriority::LOW) << "\n";
         
         std::cout << "\nActive Alarms:\n";
-        for (const auto& alarm : alarms) {
-            if (alarm.getState() != AlarmState::NORMAL && 
-                alarm.getState() != AlarmState::OUT_OF_SERVICE) {
-                std::cout << "  " << alarm.getTagName() 
-                          << " (" << priorityToString(alarm.getPriority()) << ") - " 
-                          << stateToString(alarm.getState()) << "\n";
-            }
-        }
+        forEachListedAlarm([this](AlarmId id) {
+            const AlarmCore& alarm = alarms[id];
+            std::cout << "  " << tagName(id) 
+                      << " (" << priorityToString(alarm.getPriority()) << ") - " 
+                      << stateToString(alarm.getState()) << "\n";
+        });
         std::cout << "=====================\n\n";
     }
 
     // Print detailed information for all alarms
     void printAllAlarms() const {
         std::cout << "\n=== ALL CONFIGURED ALARMS ===\n";
-        for (const auto& alarm : alarms) {
-            alarm.print();
+        for (AlarmId id = 0; id < alarms.size(); id++) {
+            alarms[id].print(tagName(id), descriptions[id]);
             std::cout << "--------------------------\n";
         }
         std::cout << "============================\n\n";
     }
 };
 
-int main() {
+// Benchmark: columnar batch evaluation vs per-object Alarm::trigger
+void benchmarkAlarmTable(size_t alarmCount, int scans) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> setpointDist(50.0, 150.0);
+    std::uniform_real_distribution<double> noise(-20.0, 20.0);
+
+    TagRegistry tags;
+    AlarmTable table;
+    std::vector<Alarm> objects;
+    table.reserve(alarmCount);
+    objects.reserve(alarmCount);
+    for (size_t i = 0; i < alarmCount; i++) {
+        std::string tag = "TAG" + std::to_string(i);
+        double sp = setpointDist(rng);
+        table.addAlarm(tags.intern(tag), AlarmPriority::MEDIUM, sp, 2.0);
+        objects.emplace_back(tag, "Benchmark alarm", AlarmPriority::MEDIUM, sp, 2.0);
+    }
+
+    // Process values hover around the setpoints so a share of alarms cycles every scan
+    std::vector<std::vector<double>> scanValues(scans, std::vector<double>(alarmCount));
+    for (auto& values : scanValues) {
+        for (size_t i = 0; i < alarmCount; i++) {
+            values[i] = table.getSetpoint(static_cast<uint32_t>(i)) + noise(rng);
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    double tableNs = 0.0;
+    size_t tableTransitions = 0;
+    for (const auto& values : scanValues) {
+        auto start = Clock::now();
+        const auto& changes = table.evaluateBatch(values.data(), values.size());
+        tableNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        tableTransitions += changes.size();
+        for (const auto& change : changes) {
+            table.acknowledge(change.slot);
+        }
+    }
+
+    double objectNs = 0.0;
+    for (const auto& values : scanValues) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < alarmCount; i++) {
+            objects[i].trigger(values[i]);
+        }
+        objectNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        for (auto& alarm : objects) {
+            alarm.acknowledge();
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Alarm evaluation, " << alarmCount << " alarms x " << scans << " scans:\n";
+#if defined(__AVX2__)
+    std::cout << "  Kernel: AVX2\n";
+#elif defined(__SSE2__)
+    std::cout << "  Kernel: SSE2\n";
+#else
+    std::cout << "  Kernel: scalar\n";
+#endif
+    std::cout << "  Columnar evaluateBatch: " << tableNs / scans / 1e6 << " ms/scan ("
+              << tableNs / scans / alarmCount << " ns/alarm, "
+              << tableTransitions / scans << " transitions/scan)\n";
+    std::cout << "  Alarm::trigger loop:    " << objectNs / scans / 1e6 << " ms/scan ("
+              << objectNs / scans / alarmCount << " ns/alarm)\n";
+    std::cout << "  Scan budget:            100.000 ms/scan\n\n";
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+// Benchmark: per-transition timestamp cost, string formatting vs int64 capture
+void benchmarkTimestamps(int transitions) {
+    using Clock = std::chrono::steady_clock;
+
+    // Before: every transition formatted wall-clock text through stringstream/localtime
+    std::string text;
+    auto start = Clock::now();
+    for (int i = 0; i < transitions; i++) {
+        auto now = std::chrono::system_clock::now();
+        auto nowTime = std::chrono::system_clock::to_time_t(now);
+        std::stringstream ss;
+        ss << std::put_time(std::localtime(&nowTime), "%Y-%m-%d %H:%M:%S");
+        text = ss.str();
+    }
+    double formatNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    // After: a transition only records the clock
+    std::vector<TimestampNs> stamps(transitions);
+    start = Clock::now();
+    for (int i = 0; i < transitions; i++) {
+        stamps[i] = systemNowNs();
+    }
+    double captureNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    // Lazy bulk output of the captured stamps through the cached formatter
+    char buffer[TimestampFormatter::BUFFER_SIZE];
+    size_t written = 0;
+    start = Clock::now();
+    for (int i = 0; i < transitions; i++) {
+        written += TimestampFormatter::format(stamps[i], buffer);
+    }
+    double bulkNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Timestamp cost per transition, " << transitions << " transitions:\n";
+    std::cout << "  stringstream + localtime: " << formatNs / transitions << " ns\n";
+    std::cout << "  int64 capture:            " << captureNs / transitions << " ns\n";
+    std::cout << "  cached bulk formatting:   " << bulkNs / transitions << " ns/record ("
+              << written << " chars)\n\n";
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+// Benchmark: several I/O driver threads feeding one evaluation thread
+void benchmarkIngestion(int producers, int samplesPerProducer, size_t tagCount) {
+    AlarmManagementSystem alarmSystem;
+    std::vector<TagId> handles;
+    for (size_t i = 0; i < tagCount; i++) {
+        // Setpoints above the simulated range keep the console quiet during the run
+        handles.push_back(alarmSystem.tagOf(
+            alarmSystem.emplaceAlarm("TAG" + std::to_string(i), "Benchmark alarm", AlarmPriority::LOW, 1e9, 1.0)));
+    }
+
+    ProcessValueIngestor ingestor([&](const ProcessSample* samples, size_t count) {
+        alarmSystem.updateProcessValues(samples, count);
+    });
+    ingestor.start();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> drivers;
+    for (int p = 0; p < producers; p++) {
+        drivers.emplace_back([&, p]() {
+            for (int i = 0; i < samplesPerProducer; i++) {
+                ingestor.submit(handles[(static_cast<size_t>(i) * producers + p) % tagCount],
+                                static_cast<double>(i));
+            }
+        });
+    }
+    for (auto& driver : drivers) {
+        driver.join();
+    }
+    ingestor.stop();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    IngestStatistics stats = ingestor.statistics();
+    std::cout << "Ingestion, " << producers << " producers x " << samplesPerProducer << " samples:\n";
+    std::cout << "  Enqueued: " << stats.enqueued << ", dropped: " << stats.dropped
+              << ", evaluated: " << stats.evaluated << " in " << stats.batches << " batches\n";
+    std::cout << "  Throughput: " << static_cast<uint64_t>(stats.evaluated / seconds) << " samples/s\n";
+    std::cout << "  Enqueue-to-evaluation latency: p50 " << stats.latencyP50Ns / 1000
+              << " us, p99 " << stats.latencyP99Ns / 1000 << " us\n\n";
+}
+
+// Benchmark: sharded evaluation scaling from 1 to maxWorkers cores
+void benchmarkShardedScaling(size_t alarmCount, int scans, size_t maxWorkers) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> setpointDist(50.0, 150.0);
+    std::uniform_real_distribution<double> noise(-5.0, 5.0);
+
+    // Three alarms per tag (e.g. HI/HIHI/LO on one PV)
+    size_t tagCount = alarmCount / 3;
+    std::vector<double> setpoints(alarmCount);
+    for (auto& sp : setpoints) {
+        sp = setpointDist(rng);
+    }
+
+    // The first tenth of the plant is in an upset and swings across its limits every scan
+    std::vector<std::vector<double>> scanValues(scans, std::vector<double>(tagCount));
+    for (int scan = 0; scan < scans; scan++) {
+        for (size_t tag = 0; tag < tagCount; tag++) {
+            double base = setpoints[tag * 3];
+            scanValues[scan][tag] = (tag < tagCount / 10) ? base + ((scan & 1) ? 40.0 : -40.0)
+                                                          : base - 30.0 + noise(rng);
+        }
+    }
+
+    std::cout << "Sharded evaluation scaling, " << alarmCount << " alarms x " << scans << " scans:\n";
+    double baseline = 0.0;
+    for (size_t workers = 1; workers <= maxWorkers; workers *= 2) {
+        ShardedAlarmEngine engine(workers);
+        std::vector<AlarmHandle> handles;
+        for (size_t i = 0; i < alarmCount; i++) {
+            handles.push_back(engine.addAlarm(static_cast<TagId>(i / 3), AlarmPriority::HIGH,
+                                              setpoints[i], 2.0));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& values : scanValues) {
+            engine.evaluateScan(values.data(), values.size());
+        }
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count() / scans;
+        if (workers == 1) {
+            baseline = ms;
+        }
+        std::cout << "  " << workers << " worker(s), " << engine.shardCount() << " shards: "
+                  << ms << " ms/scan, speedup " << baseline / ms
+                  << ", steals " << engine.stealCount()
+                  << ", active " << engine.activeAlarmCount() << "\n";
+    }
+    std::cout << "\n";
+}
+
+// Randomized equivalence check: the sharded engine against one serial
+// AlarmTable fed the same scans and operator actions. Build with
+// -fsanitize=thread to check the pool and the shard counters for races.
+int verifyShardedEngine(size_t alarmCount, int scans, size_t workers) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> setpointDist(50.0, 150.0);
+    std::uniform_real_distribution<double> valueDist(0.0, 200.0);
+    std::uniform_int_distribution<size_t> anyAlarm(0, alarmCount - 1);
+    std::uniform_int_distribution<int> anyAction(0, 6);
+
+    size_t tagCount = alarmCount / 3 + 1;
+    ShardedAlarmEngine engine(workers);
+    AlarmTable serial;
+    std::vector<AlarmHandle> handles;
+    for (size_t i = 0; i < alarmCount; i++) {
+        TagId tag = static_cast<TagId>(i % tagCount);
+        AlarmPriority priority = static_cast<AlarmPriority>(i % 4);
+        double setpoint = setpointDist(rng);
+        handles.push_back(engine.addAlarm(tag, priority, setpoint, 2.0));
+        serial.addAlarm(tag, priority, setpoint, 2.0);
+    }
+
+    std::vector<double> tagValues(tagCount);
+    std::vector<double> slotValues(alarmCount);
+    size_t stateMismatches = 0;
+    size_t counterMismatches = 0;
+    for (int scan = 0; scan < scans; scan++) {
+        for (size_t tag = 0; tag < tagCount; tag++) {
+            // A few tags read bad quality (NaN) now and then
+            tagValues[tag] = (tag + static_cast<size_t>(scan)) % 97 == 0 ? std::numeric_limits<double>::quiet_NaN()
+                                                                         : valueDist(rng);
+        }
+        for (size_t i = 0; i < alarmCount; i++) {
+            slotValues[i] = tagValues[serial.getTagId(static_cast<uint32_t>(i))];
+        }
+        engine.evaluateScan(tagValues.data(), tagValues.size());
+        serial.evaluateBatch(slotValues.data(), slotValues.size());
+
+        // Operator actions between scans, on both
+        for (size_t k = 0; k < alarmCount / 50; k++) {
+            size_t i = anyAlarm(rng);
+            uint32_t slot = static_cast<uint32_t>(i);
+            switch (anyAction(rng)) {
+                case 0: case 1: engine.acknowledge(handles[i]); serial.acknowledge(slot); break;
+                case 2: engine.shelve(handles[i]); serial.shelve(slot); break;
+                case 3: engine.unshelve(handles[i]); serial.unshelve(slot); break;
+                case 4: engine.suppress(handles[i]); serial.suppress(slot); break;
+                case 5: engine.unsuppress(handles[i]); serial.unsuppress(slot); break;
+                default: {
+                    bool enable = (i & 1) == 0;
+                    engine.enable(handles[i], enable);
+                    serial.enable(slot, enable);
+                    break;
+                }
+            }
+        }
+
+        int active = 0;
+        int byPriority[4] = {0, 0, 0, 0};
+        for (size_t i = 0; i < alarmCount; i++) {
+            AlarmState state = serial.getState(static_cast<uint32_t>(i));
+            stateMismatches += engine.getState(handles[i]) != state;
+            if (state == AlarmState::UNACKNOWLEDGED || state == AlarmState::ACKNOWLEDGED ||
+                state == AlarmState::RETURNED_UNACKNOWLEDGED) {
+                active++;
+                byPriority[static_cast<size_t>(serial.getPriority(static_cast<uint32_t>(i)))]++;
+            }
+        }
+        counterMismatches += engine.activeAlarmCount() != active;
+        for (int p = 0; p < 4; p++) {
+            counterMismatches += engine.alarmCount(static_cast<AlarmPriority>(p)) != byPriority[p];
+        }
+    }
+
+    std::cout << "Sharded engine check, " << alarmCount << " alarms x " << scans << " scans, " << workers
+              << " worker(s): " << stateMismatches << " state and " << counterMismatches
+              << " counter mismatches against a serial AlarmTable\n\n";
+    return stateMismatches == 0 && counterMismatches == 0 ? 0 : 1;
+}
+
+// Benchmark: alarm flood through the journal vs synchronous console logging
+void benchmarkJournal(int transitions) {
+    const std::string path = "isa-18-2-journal-bench.bin";
+    std::remove(path.c_str());
+
+    AlarmJournal journal(FsyncPolicy::INTERVAL, std::chrono::milliseconds(100));
+    if (!journal.open(path)) {
+        std::cout << "[ERROR] Cannot open journal file: " << path << "\n";
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < transitions; i++) {
+        journal.appendWait(systemNowNs(), static_cast<TagId>(i % 50000), AlarmState::NORMAL,
+                           AlarmState::UNACKNOWLEDGED, AlarmPriority::HIGH, static_cast<double>(i));
+    }
+    double appendNs = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+    journal.close();
+    double totalMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    // Console baseline on a throwaway stream of the same shape as the old log line
+    std::ostringstream console;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < transitions; i++) {
+        console << "[ALARM TRIGGERED] " << "TAG" << (i % 50000) << " - " << "Flood alarm"
+                << " - Priority: " << priorityToString(AlarmPriority::HIGH)
+                << " - Value: " << static_cast<double>(i) << "\n";
+    }
+    double consoleNs = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Alarm journal, " << transitions << " transitions:\n";
+    std::cout << "  Evaluation-side cost: " << appendNs / transitions << " ns/event (journal append), "
+              << consoleNs / transitions << " ns/event (formatted log line)\n";
+    std::cout << "  Written: " << journal.writtenCount() << ", dropped: " << journal.droppedCount()
+              << ", backpressure waits: " << journal.backpressureCount() << ", group commits: " << journal.commitCount() << ", fsyncs: " << journal.syncCount()
+              << ", drained in " << totalMs << " ms\n\n";
+    std::remove(path.c_str());
+}
+
+// Print an ISA-18.2 performance report
+void printKpiReport(const AlarmKpiReport& report, const TagRegistry* tags) {
+    std::cout << "\n=== ISA-18.2 ALARM PERFORMANCE ===\n";
+    std::cout << "Period: " << TimestampFormatter::format(report.from) << " to "
+              << TimestampFormatter::format(report.to) << "\n";
+    std::cout << "Transitions: " << report.transitions << ", annunciated alarms: "
+              << report.activations << "\n";
+    std::cout << "Alarms per 10 min per operator: average " << report.averagePer10MinPerOperator
+              << ", peak " << report.peakPer10MinPerOperator << "\n";
+    std::cout << "Flood periods (>10 alarms/10 min): " << report.floodPeriods << " of "
+              << report.tenMinutePeriods << " (" << report.percentTimeInFlood << "% of time)\n";
+    std::cout << "Chattering tags: " << report.chatteringTags << "\n";
+    std::cout << "Stale alarms (>24 h): " << report.staleAlarms << "\n";
+    std::cout << "Top bad actors:\n";
+    for (const auto& actor : report.topBadActors) {
+        std::cout << "  ";
+        if (tags != nullptr && tags->contains(actor.tag)) {
+            std::cout << tags->name(actor.tag);
+        } else {
+            std::cout << "tag#" << actor.tag;
+        }
+        std::cout << ": " << actor.activations << "\n";
+    }
+    std::cout << "==================================\n\n";
+}
+
+// Benchmark: KPI report over a synthetic multi-day history
+void benchmarkHistory(int days, size_t tagCount, int transitionsPerDay) {
+    const std::string directory = "isa-18-2-history-bench";
+    std::filesystem::remove_all(directory);
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<TagId> anyTag(0, static_cast<TagId>(tagCount - 1));
+    std::uniform_int_distribution<TagId> badActor(0, 19);
+    const TimestampNs day = 24LL * 3600 * NS_PER_SECOND;
+    const TimestampNs start = (systemNowNs() / day - days) * day;
+
+    auto writeStart = std::chrono::steady_clock::now();
+    {
+        AlarmHistory history;
+        history.open(directory);
+        TimestampNs step = day / transitionsPerDay;
+        for (int64_t i = 0; i < static_cast<int64_t>(days) * transitionsPerDay; i++) {
+            // A fifth of the traffic comes from twenty bad actors
+            TagId tag = (i % 5 == 0) ? badActor(rng) : anyTag(rng);
+            bool activation = (i & 1) == 0;
+            history.append({start + i * step, tag,
+                            activation ? AlarmState::NORMAL : AlarmState::ACKNOWLEDGED,
+                            activation ? AlarmState::UNACKNOWLEDGED : AlarmState::RETURNED_UNACKNOWLEDGED,
+                            AlarmPriority::MEDIUM, 0, 100.0});
+        }
+        if (!history.close()) {
+            std::cout << "[ERROR] Alarm history write failed: " << directory << "\n";
+        }
+    }
+    double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count();
+
+    AlarmHistory history;
+    history.open(directory);
+    auto queryStart = std::chrono::steady_clock::now();
+    AlarmKpiReport report = history.computeKpis(start, start + days * day, 4);
+    double kpiSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - queryStart).count();
+
+    queryStart = std::chrono::steady_clock::now();
+    size_t tagRows = history.forEachForTag(3, start, start + days * day, [](const JournalRecord&) {});
+    double tagMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queryStart).count();
+
+    std::cout << "Alarm history, " << days << " days x " << transitionsPerDay << " transitions, "
+              << tagCount << " tags:\n";
+    std::cout << "  Write: " << writeSeconds << " s, KPI report: " << kpiSeconds
+              << " s, single-tag query: " << tagMs << " ms (" << tagRows << " rows)\n";
+    printKpiReport(report, nullptr);
+    std::filesystem::remove_all(directory);
+}
+
+// Benchmark: plant trip with and without flood/state-based suppression
+void benchmarkFloodSuppression(size_t units, size_t alarmsPerUnit) {
+    const int phaseScans = 30;
+    std::cout << "Plant trip, " << units << " units x " << alarmsPerUnit << " alarms (half the units trip):\n";
+    for (int suppressed = 0; suppressed <= 1; suppressed++) {
+        AlarmTable table;
+        table.reserve(units * alarmsPerUnit);
+        for (size_t i = 0; i < units * alarmsPerUnit; i++) {
+            // Slot 0 of each unit is its trip alarm
+            AlarmPriority prio = (i % alarmsPerUnit == 0) ? AlarmPriority::CRITICAL
+                                                          : static_cast<AlarmPriority>(i % 4);
+            table.addAlarm(static_cast<TagId>(i), prio, 100.0, 2.0);
+        }
+        SuppressionEngine engine(table);
+        for (size_t unit = 0; unit < units; unit++) {
+            auto group = engine.addGroup("UNIT" + std::to_string(unit),
+                                         static_cast<uint32_t>(unit * alarmsPerUnit));
+            for (size_t k = 1; k < alarmsPerUnit; k++) {
+                engine.addToGroup(group, static_cast<uint32_t>(unit * alarmsPerUnit + k));
+            }
+        }
+
+        std::vector<double> values(table.size(), 50.0);
+        TimestampNs now = 0;
+        std::cout << "  " << (suppressed ? "With suppression:   " : "Without suppression:");
+        for (int phase = 0; phase < 3; phase++) {
+            size_t transitions = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int scan = 0; scan < phaseScans; scan++) {
+                now += NS_PER_SECOND;
+                // Phase 1: tripped units' alarms chatter across their limits
+                for (size_t unit = 0; unit < units / 2; unit++) {
+                    for (size_t k = 0; k < alarmsPerUnit; k++) {
+                        size_t slot = unit * alarmsPerUnit + k;
+                        values[slot] = (phase != 1) ? 50.0 : (k == 0 || (scan & 1)) ? 150.0 : 50.0;
+                    }
+                }
+                const auto& changes = table.evaluateBatch(values.data(), values.size());
+                transitions += changes.size();
+                for (const auto& change : changes) {
+                    if (change.newState == AlarmState::RETURNED_UNACKNOWLEDGED) {
+                        table.acknowledge(change.slot);
+                    }
+                }
+                if (suppressed) {
+                    transitions += engine.update(now, changes).size();
+                }
+            }
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count() / phaseScans;
+            const char* names[] = {"normal", "trip", "recovery"};
+            std::cout << " " << names[phase] << " " << ms << " ms/scan ("
+                      << transitions / phaseScans << " transitions)";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+}
+
+// Benchmark: timer wheel (timed shelving over a shift) vs polling every expiry each scan
+void benchmarkTimerWheel(size_t timerCount, size_t alarmCount) {
+    const uint64_t scanTicks = 10;                      // 100 ms scan at 10 ms ticks
+    const uint64_t horizon = 8ULL * 3600 * 100;         // 8 h shelving limit in ticks
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<uint64_t> delayDist(1, horizon);
+    std::vector<uint64_t> delays(timerCount);
+    for (auto& delay : delays) {
+        delay = delayDist(rng);
+    }
+
+    TimerWheel wheel(timerCount);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < timerCount; i++) {
+        wheel.schedule(static_cast<TimerWheel::TimerId>(i), delays[i]);
+    }
+    double scheduleNs = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / timerCount;
+
+    size_t fired = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t tick = 0; tick < horizon; tick += scanTicks) {
+        wheel.advance(scanTicks, [&fired](TimerWheel::TimerId) { fired++; });
+    }
+    double wheelSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Polling baseline: compare every expiry on each scan (sampled, then extrapolated)
+    const uint64_t sampledScans = 50;
+    size_t polled = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t scan = 1; scan <= sampledScans; scan++) {
+        for (size_t i = 0; i < timerCount; i++) {
+            polled += delays[i] <= scan * scanTicks;
+        }
+    }
+    double pollSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() *
+                         static_cast<double>(horizon / scanTicks) / sampledScans;
+
+    std::cout << "Timer wheel, " << timerCount << " shelving timers over 8 h of 100 ms scans:\n";
+    std::cout << "  Schedule: " << scheduleNs << " ns/timer, expire all: " << wheelSeconds
+              << " s (" << fired << " fired, " << wheelSeconds * 1e9 / (horizon / scanTicks)
+              << " ns/scan)\n";
+    std::cout << "  Polling every scan: ~" << pollSeconds << " s (" << polled << " sampled hits)\n";
+
+    // Alarm system: every alarm on a 2 s on-delay, 1% of tags raising each scan
+    // (events go to a journal so the console stays quiet)
+    const std::string path = "isa-18-2-timer-bench.bin";
+    std::remove(path.c_str());
+    AlarmJournal journal;
+    journal.open(path);
+    AlarmManagementSystem alarmSystem(static_cast<int>(alarmCount));
+    alarmSystem.attachJournal(&journal);
+    std::vector<TagId> ids;
+    ids.reserve(alarmCount);
+    for (size_t i = 0; i < alarmCount; i++) {
+        ids.push_back(alarmSystem.tagOf(alarmSystem.emplaceAlarm("TW" + std::to_string(i), "Timer bench",
+                                                                 AlarmPriority::LOW, 100.0, 2.0)));
+        alarmSystem.setAlarmTiming(ids.back(), 2 * NS_PER_SECOND, NS_PER_SECOND, 0);
+    }
+    std::uniform_int_distribution<size_t> tagDist(0, alarmCount - 1);
+    TimestampNs now = NS_PER_SECOND;
+    alarmSystem.processTimers(now);
+    const int scans = 600;
+    start = std::chrono::steady_clock::now();
+    for (int scan = 0; scan < scans; scan++) {
+        for (size_t k = 0; k < alarmCount / 100; k++) {
+            alarmSystem.updateProcessValue(ids[tagDist(rng)], (scan / 50) % 2 ? 50.0 : 150.0, now);
+        }
+        now += NS_PER_SECOND / 10;
+        alarmSystem.processTimers(now);
+    }
+    double scanUs = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count() / scans;
+    std::cout << "  Alarm system, " << alarmCount << " delayed alarms: " << static_cast<long>(scanUs)
+              << " us/scan, " << alarmSystem.activeAlarmCount() << " active, "
+              << alarmSystem.pendingTimerCount() << " timers pending\n\n";
+    journal.close();
+    std::remove(path.c_str());
+}
+
+// Benchmark: alarms as objects owning heap strings in a growing vector, vs
+// pooled records with arena text
+void benchmarkAlarmStorage(size_t alarmCount) {
+    std::vector<std::string> tags;
+    std::vector<std::string> texts;
+    for (size_t i = 0; i < alarmCount; i++) {
+        tags.push_back("TT" + std::to_string(10000 + i));
+        texts.push_back("Unit " + std::to_string(i / 100) + " reactor temperature high");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t objectBytes = 0;
+    {
+        std::vector<Alarm> objects;
+        for (size_t i = 0; i < alarmCount; i++) {
+            objects.emplace_back(tags[i], texts[i], AlarmPriority::HIGH, 150.0, 2.0);
+        }
+        objectBytes = objects.capacity() * sizeof(Alarm);
+        for (const Alarm& alarm : objects) {
+            for (size_t length : {alarm.getTagName().size(), alarm.getDescription().size()}) {
+                objectBytes += length > 15 ? length + 1 : 0;   // beyond the small-string buffer
+            }
+        }
+    }
+    double objectMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // The same records and text as the alarm system stores them
+    start = std::chrono::steady_clock::now();
+    size_t pooledBytes = 0;
+    {
+        StablePool<AlarmCore> pool;
+        StringArena arena;
+        std::vector<std::string_view> descriptions;
+        for (size_t i = 0; i < alarmCount; i++) {
+            pool.emplace(AlarmPriority::HIGH, 150.0, 2.0);
+            descriptions.push_back(arena.store(texts[i]));
+        }
+        pooledBytes = pool.bytes() + arena.bytes() + descriptions.capacity() * sizeof(std::string_view);
+    }
+    double pooledMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Handles and text views survive the system growing past many chunks
+    AlarmManagementSystem alarmSystem(static_cast<int>(alarmCount));
+    AlarmId first = alarmSystem.emplaceAlarm(tags[0], texts[0], AlarmPriority::HIGH, 150.0, 2.0);
+    const AlarmCore* firstRecord = &alarmSystem.alarm(first);
+    std::string_view firstText = alarmSystem.description(first);
+    for (size_t i = 1; i < alarmCount; i++) {
+        alarmSystem.emplaceAlarm(tags[i], texts[i], AlarmPriority::HIGH, 150.0, 2.0);
+    }
+    bool stable = firstRecord == &alarmSystem.alarm(first) && firstText.data() == alarmSystem.description(first).data() &&
+                  firstText == texts[0];
+
+    std::cout << "Alarm storage, " << alarmCount << " alarms:\n";
+    std::cout << "  Objects in a vector: " << objectMs << " ms, " << objectBytes / alarmCount << " bytes/alarm\n";
+    std::cout << "  Pool + string arena: " << pooledMs << " ms, " << pooledBytes / alarmCount << " bytes/alarm ("
+              << sizeof(AlarmCore) << " hot), first handle " << (stable ? "still valid" : "MOVED")
+              << " after " << alarmSystem.size() << " alarms\n\n";
+}
+
+// Create the configured alarms and I/O points, constructing alarms in place
+// from the configuration's views
+void applyConfiguration(const PlantConfig& config, AlarmManagementSystem& alarmSystem, PLCMemory& memory) {
+    alarmSystem.reserveAlarms(config.alarms().size());
+    for (const AlarmConfig& alarm : config.alarms()) {
+        alarmSystem.emplaceAlarm(alarm.tag, alarm.description, alarm.priority, alarm.setpoint, alarm.deadband);
+    }
+    size_t perArea[5] = {};
+    for (const PointConfig& point : config.points()) {
+        perArea[static_cast<size_t>(point.area)]++;
+    }
+    for (PLCArea area : {PLCArea::INPUT, PLCArea::OUTPUT, PLCArea::INT, PLCArea::REAL, PLCArea::BOOL}) {
+        memory.reserve(area, perArea[static_cast<size_t>(area)]);
+    }
+    ProcessImage& image = memory.image();
+    for (const PointConfig& point : config.points()) {
+        PLCAddress address = memory.define(point.area, std::string(point.name));
+        switch (point.area) {
+            case PLCArea::INPUT: image.setInput(address.index, point.value != 0.0); break;
+            case PLCArea::OUTPUT: image.setOutput(address.index, point.value != 0.0); break;
+            case PLCArea::INT: image.integers[address.index] = static_cast<int32_t>(point.value); break;
+            case PLCArea::REAL: image.reals[address.index] = static_cast<float>(point.value); break;
+            case PLCArea::BOOL: image.booleans[address.index] = point.value != 0.0; break;
+            case PLCArea::NONE: break;
+        }
+    }
+}
+
+// Load a plant configuration (text or snapshot) and report what it contains
+int runConfig(const std::string& path, const std::string& snapshotPath) {
+    auto start = std::chrono::steady_clock::now();
+    PlantConfig config;
+    if (!config.load(path)) {
+        std::cout << "[ERROR] " << path << ": " << config.error() << "\n";
+        return 1;
+    }
+    AlarmManagementSystem alarmSystem(static_cast<int>(config.alarms().size()));
+    PLCMemory memory;
+    applyConfiguration(config, alarmSystem, memory);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Loaded " << config.alarms().size() << " alarms and " << config.points().size()
+              << " I/O points from " << path << " in " << ms << " ms\n";
+    if (!snapshotPath.empty()) {
+        if (!config.writeSnapshot(snapshotPath)) {
+            std::cout << "[ERROR] Cannot write snapshot: " << snapshotPath << "\n";
+            return 1;
+        }
+        std::cout << "Snapshot written to " << snapshotPath << "\n";
+    }
+    if (config.alarms().size() <= 20) {
+        alarmSystem.printAllAlarms();
+    }
+    return 0;
+}
+
+// Benchmark: bulk configuration load - stream parsing and copying, mapped
+// text parsed in place, and a binary snapshot
+void benchmarkConfigLoad(size_t alarmCount, size_t pointCount) {
+    const std::string textPath = "isa-plant-config-bench.txt";
+    const std::string snapshotPath = "isa-plant-config-bench.bin";
+    const char* priorities[] = {"LOW", "MEDIUM", "HIGH", "CRITICAL"};
+    const char* areas[] = {"INPUT", "OUTPUT", "INT", "REAL", "BOOL"};
+    {
+        std::ofstream out(textPath);
+        out << "# Generated plant database\n";
+        for (size_t i = 0; i < alarmCount; i++) {
+            out << "ALARM,TT" << 10000 + i << "," << priorities[i % 4] << "," << 100 + i % 50 << ".5,2,"
+                << "Unit " << i / 100 << " temperature high, train " << i % 3 << "\n";
+        }
+        for (size_t i = 0; i < pointCount; i++) {
+            out << "IO," << areas[i % 5] << ",P" << i << "," << (i % 5 >= 2 ? i % 100 : i % 2) << "\n";
+        }
+    }
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    // Baseline: getline/stringstream/stod into std::string fields, Alarm copied in
+    auto start = Clock::now();
+    {
+        AlarmManagementSystem alarmSystem(static_cast<int>(alarmCount));
+        PLCMemory memory;
+        std::ifstream in(textPath);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::stringstream fields(line);
+            std::string kind, tag, prio, sp, db, desc;
+            std::getline(fields, kind, ',');
+            if (kind == "ALARM") {
+                std::getline(fields, tag, ',');
+                std::getline(fields, prio, ',');
+                std::getline(fields, sp, ',');
+                std::getline(fields, db, ',');
+                std::getline(fields, desc);
+                AlarmPriority priority = prio == "LOW" ? AlarmPriority::LOW : prio == "MEDIUM" ? AlarmPriority::MEDIUM
+                                       : prio == "HIGH" ? AlarmPriority::HIGH : AlarmPriority::CRITICAL;
+                alarmSystem.emplaceAlarm(tag, desc, priority, std::stod(sp), std::stod(db));
+            } else if (kind == "IO") {
+                std::string area, name, value;
+                std::getline(fields, area, ',');
+                std::getline(fields, name, ',');
+                std::getline(fields, value);
+                if (area == "REAL") {
+                    memory.setReal(name, std::stof(value));
+                } else if (area == "INT") {
+                    memory.setInteger(name, std::stoi(value));
+                } else if (area == "BOOL") {
+                    memory.setBoolean(name, value != "0");
+                } else if (area == "INPUT") {
+                    memory.setDigitalInput(name, value != "0");
+                } else {
+                    memory.setDigitalOutput(name, value != "0");
+                }
+            }
+        }
+    }
+    double streamMs = ms(start);
+
+    PlantConfig config;
+    start = Clock::now();
+    bool parsed = config.load(textPath);
+    double parseMs = ms(start);
+    start = Clock::now();
+    {
+        AlarmManagementSystem alarmSystem(static_cast<int>(alarmCount));
+        PLCMemory memory;
+        applyConfiguration(config, alarmSystem, memory);
+    }
+    double applyMs = ms(start);
+    config.writeSnapshot(snapshotPath);
+
+    PlantConfig warm;
+    start = Clock::now();
+    bool restored = warm.load(snapshotPath);
+    double snapshotMs = ms(start);
+    size_t matching = 0;
+    for (size_t i = 0; restored && parsed && i < warm.alarms().size(); i++) {
+        matching += warm.alarms()[i].tag == config.alarms()[i].tag &&
+                    warm.alarms()[i].setpoint == config.alarms()[i].setpoint;
+    }
+
+    std::cout << "Configuration load, " << alarmCount << " alarms + " << pointCount << " I/O points:\n";
+    std::cout << "  Stream parser + copies: " << streamMs << " ms\n";
+    std::cout << "  Mapped text: parse " << parseMs << " ms, build " << applyMs << " ms\n";
+    std::cout << "  Snapshot: load " << snapshotMs << " ms (" << matching << " alarms identical to text)\n\n";
+    std::remove(textPath.c_str());
+    std::remove(snapshotPath.c_str());
+}
+
+// Wire one control loop into the graph: transmitter -> controller -> valve,
+// transmitter -> its alarm and PV slot, controller -> its output slot.
+// Returns the valve node, which the caller couples to the process.
+LoopNodeId addControlLoop(LoopGraph& graph, PLCMemory& memory, char measurement, const std::string& loop,
+                          TagId alarmTag) {
+    std::string transmitter = std::string(1, measurement) + "T" + loop;
+    std::string controller = std::string(1, measurement) + "IC" + loop;
+    LoopNodeId pt = graph.addInstrument(transmitter);
+    LoopNodeId ic = graph.addInstrument(controller);
+    LoopNodeId valve = graph.addInstrument(std::string(1, measurement) + "V" + loop);
+    graph.connect(pt, ic);
+    graph.connect(ic, valve);
+    if (alarmTag != INVALID_TAG_ID) {
+        graph.connect(pt, graph.addAlarm(transmitter, alarmTag));
+    }
+    memory.setReal(transmitter + "_PV", 0.0f);
+    memory.setReal(controller + "_OUT", 0.0f);
+    graph.connect(pt, graph.addVariable(transmitter + "_PV", memory.find(transmitter + "_PV")));
+    graph.connect(ic, graph.addVariable(controller + "_OUT", memory.find(controller + "_OUT")));
+    return valve;
+}
+
+// Benchmark: impact queries on a plant of trains of coupled units
+void benchmarkLoopGraph(size_t units) {
+    const size_t unitsPerTrain = 8;
+    const char measurements[] = {'T', 'P', 'F', 'L'};
+    LoopGraph graph;
+    PLCMemory memory;
+    graph.reserve(units * 24, units * 28);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t unit = 0; unit < units; unit++) {
+        std::string loop = std::to_string(1000 + unit);
+        LoopNodeId valves[4];
+        for (int m = 0; m < 4; m++) {
+            valves[m] = addControlLoop(graph, memory, measurements[m], loop, static_cast<TagId>(unit * 4 + m));
+        }
+        // Coolant flow drives temperature, level drives pressure; each unit
+        // feeds the next one in its train
+        graph.connect(valves[2], graph.find(LoopNodeKind::INSTRUMENT, "TT" + loop));
+        graph.connect(valves[3], graph.find(LoopNodeKind::INSTRUMENT, "PT" + loop));
+        if ((unit + 1) % unitsPerTrain != 0 && unit + 1 < units) {
+            graph.connect(valves[1], graph.addInstrument("FT" + std::to_string(1000 + unit + 1)));
+        }
+    }
+    std::vector<LoopNodeId> reached;
+    graph.affected(0, reached);     // builds the rows
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::mt19937 rng(7);
+    std::vector<LoopNodeId> failed;
+    for (int q = 0; q < 10000; q++) {
+        failed.push_back(graph.find(LoopNodeKind::INSTRUMENT, "FT" + std::to_string(1000 + rng() % units)));
+    }
+    size_t alarms = 0;
+    size_t slots = 0;
+    start = std::chrono::steady_clock::now();
+    for (LoopNodeId node : failed) {
+        graph.affected(node, reached);
+        for (LoopNodeId n : reached) {
+            alarms += graph.kind(n) == LoopNodeKind::ALARM;
+            slots += graph.kind(n) == LoopNodeKind::VARIABLE;
+        }
+    }
+    double queryUs = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count() / failed.size();
+
+    std::cout << "Loop graph, " << units << " units (" << graph.nodeCount() << " nodes, " << graph.edgeCount()
+              << " edges), built in " << buildMs << " ms:\n";
+    std::cout << "  Transmitter failure impact: " << queryUs << " us/query (avg " << alarms / failed.size()
+              << " alarms, " << slots / failed.size() << " PLC slots affected)\n\n";
+}
+
+// Fail a transmitter and use the loop graph to find the consequential alarms
+// and the process-image slots that can no longer be trusted
+int runImpact(const std::string& failedTag) {
+    AlarmManagementSystem alarmSystem;
+    TagId tt101 = alarmSystem.tagOf(alarmSystem.emplaceAlarm("TT101", "Reactor Temperature High", AlarmPriority::HIGH, 150.0, 2.0));
+    TagId pt202 = alarmSystem.tagOf(alarmSystem.emplaceAlarm("PT202", "Feed Pressure Low", AlarmPriority::MEDIUM, 50.0, 5.0));
+    TagId ft303 = alarmSystem.tagOf(alarmSystem.emplaceAlarm("FT303", "Coolant Flow Low", AlarmPriority::CRITICAL, 20.0, 1.0));
+    TagId lt404 = alarmSystem.tagOf(alarmSystem.emplaceAlarm("LT404", "Tank Level High", AlarmPriority::LOW, 80.0, 3.0));
+
+    LoopGraph graph;
+    PLCMemory memory;
+    LoopNodeId tv101 = addControlLoop(graph, memory, 'T', "101", tt101);
+    addControlLoop(graph, memory, 'P', "202", pt202);
+    LoopNodeId fv303 = addControlLoop(graph, memory, 'F', "303", ft303);
+    LoopNodeId lv404 = addControlLoop(graph, memory, 'L', "404", lt404);
+    LoopNodeId reactorTemp = graph.find(LoopNodeKind::INSTRUMENT, "TT101");
+    graph.connect(tv101, reactorTemp);
+    graph.connect(fv303, reactorTemp);          // coolant flow sets reactor temperature
+    graph.connect(lv404, graph.find(LoopNodeKind::INSTRUMENT, "PT202"));    // tank feeds the pump
+    graph.connect(reactorTemp, graph.addVariable("Q0.0", memory.find("Q0.0")));  // high-temperature trip
+
+    LoopNodeId failed = graph.find(LoopNodeKind::INSTRUMENT, failedTag);
+    if (failed == INVALID_LOOP_NODE) {
+        std::cout << "[ERROR] Unknown instrument: " << failedTag << "\n";
+        return 1;
+    }
+    std::vector<LoopNodeId> reached;
+    auto start = std::chrono::steady_clock::now();
+    graph.affected(failed, reached);
+    double queryUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Impact of " << failedTag << " failure (" << reached.size() << " nodes, " << queryUs << " us):\n";
+    for (LoopNodeKind kind : {LoopNodeKind::INSTRUMENT, LoopNodeKind::ALARM, LoopNodeKind::VARIABLE}) {
+        const char* labels[] = {"Instruments", "Alarms", "PLC slots"};
+        std::cout << "  " << labels[static_cast<int>(kind)] << ":";
+        for (LoopNodeId node : reached) {
+            if (graph.kind(node) == kind) {
+                std::cout << " " << graph.name(node);
+            }
+        }
+        std::cout << "\n";
+    }
+
+    // The failed transmitter's own alarm stays; the consequential ones are suppressed
+    for (LoopNodeId node : reached) {
+        if (graph.kind(node) == LoopNodeKind::ALARM && graph.name(node) != failedTag) {
+            alarmSystem.suppressAlarm(graph.alarmTag(node));
+            std::cout << "Suppressed consequential alarm " << graph.name(node) << "\n";
+        }
+    }
+    std::cout << "\n";
+
+    graph.causes(graph.find(LoopNodeKind::ALARM, "TT101"), reached);
+    std::cout << "Possible causes of alarm TT101:";
+    for (LoopNodeId node : reached) {
+        std::cout << " " << graph.name(node);
+    }
+    std::cout << "\n\n";
+    alarmSystem.printAllAlarms();
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        benchmarkAlarmTable(100000, 20);
+        benchmarkTimestamps(1000000);
+        benchmarkIngestion(4, 250000, 10000);
+        size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        size_t maxWorkers = argc > 2 ? std::stoul(argv[2]) : cores;
+        benchmarkShardedScaling(300000, 20, maxWorkers);
+        int mismatches = verifyShardedEngine(30000, 200, std::max<size_t>(2, maxWorkers));
+        benchmarkJournal(1000000);
+        benchmarkHistory(30, 50000, 200000);
+        benchmarkFloodSuppression(100, 1000);
+        benchmarkTimerWheel(1000000, 100000);
+        benchmarkLoopGraph(25000);
+        benchmarkConfigLoad(100000, 100000);
+        benchmarkAlarmStorage(200000);
+        return mismatches;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--kpi") {
+        AlarmHistory history;
+        if (!history.open(argv[2], false)) {
+            std::cout << "[ERROR] Cannot open history directory: " << argv[2] << "\n";
+            return 1;
+        }
+        int days = argc > 3 ? std::stoi(argv[3]) : 30;
+        int operators = argc > 4 ? std::stoi(argv[4]) : 1;
+        if (days <= 0) {
+            std::cout << "[ERROR] KPI period must be at least one day\n";
+            return 1;
+        }
+        TimestampNs now = systemNowNs();
+        printKpiReport(history.computeKpis(now - days * 24LL * 3600 * NS_PER_SECOND, now + 1, operators),
+                       nullptr);
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--config") {
+        return runConfig(argv[2], argc > 4 && std::string(argv[3]) == "--snapshot" ? argv[4] : "");
+    }
+    if (argc > 1 && std::string(argv[1]) == "--impact") {
+        return runImpact(argc > 2 ? argv[2] : "FT303");
+    }
+    if (argc > 2 && std::string(argv[1]) == "--render") {
+        std::vector<JournalRecord> records;
+        if (!readJournal(argv[2], records)) {
+            std::cout << "[ERROR] Not an alarm journal: " << argv[2] << "\n";
+            return 1;
+        }
+        renderJournal(records, std::cout);
+        return 0;
+    }
+
     std::cout << "ISA-18.2 Alarm Management System Simulation\n";
     std::cout << "===========================================\n\n";
     
     // Create an alarm management system
     AlarmManagementSystem alarmSystem;
     
+    // Optionally journal alarm events instead of logging them to the console
+    // (history is declared first so it outlives the journal writer that feeds it)
+    AlarmHistory history;
+    AlarmJournal journal;
+    if (argc > 2 && std::string(argv[1]) == "--journal") {
+        if (argc > 4 && std::string(argv[3]) == "--history") {
+            if (!history.open(argv[4])) {
+                std::cout << "[ERROR] Cannot open history directory: " << argv[4] << "\n";
+                return 1;
+            }
+            journal.setBatchListener([&history](const JournalRecord* records, size_t count) {
+                history.append(records, count);
+            });
+        }
+        if (!journal.open(argv[2])) {
+            std::cout << "[ERROR] Cannot open journal file: " << argv[2] << "\n";
+            return 1;
+        }
+        alarmSystem.attachJournal(&journal);
+    }
+    
     // Configure alarms according to ISA-18.2 principles
-    alarmSystem.addAlarm(Alarm("TT101", "Reactor Temperature High", AlarmPriority::HIGH, 150.0, 2.0));
-    alarmSystem.addAlarm(Alarm("PT202", "Feed Pressure Low", AlarmPriority::MEDIUM, 50.0, 5.0));
-    alarmSystem.addAlarm(Alarm("FT303", "Coolant Flow Low", AlarmPriority::CRITICAL, 20.0, 1.0));
-    alarmSystem.addAlarm(Alarm("LT404", "Tank Level High", AlarmPriority::LOW, 80.0, 3.0));
+    alarmSystem.emplaceAlarm("TT101", "Reactor Temperature High", AlarmPriority::HIGH, 150.0, 2.0);
+    alarmSystem.emplaceAlarm("PT202", "Feed Pressure Low", AlarmPriority::MEDIUM, 50.0, 5.0);
+    alarmSystem.emplaceAlarm("FT303", "Coolant Flow Low", AlarmPriority::CRITICAL, 20.0, 1.0);
+    alarmSystem.emplaceAlarm("LT404", "Tank Level High", AlarmPriority::LOW, 80.0, 3.0);
     
     // Print initial configuration
     alarmSystem.printAllAlarms();
     
+    // Resolve tag handles once; scan-rate updates then skip the name lookup
+    TagId reactorTemp = alarmSystem.resolveTag("TT101");
+    
     // Simulate process values that trigger alarms
     std::cout << "Simulating process values...\n";
-    alarmSystem.updateProcessValue("TT101", 155.0); // Triggers high temperature alarm
+    alarmSystem.updateProcessValue(reactorTemp, 155.0); // Triggers high temperature alarm
     alarmSystem.updateProcessValue("FT303", 15.0);  // Triggers critical flow alarm
     
     // Print alarm summary
@@ -338,7 +1701,7 @@ int main() {
     alarmSystem.acknowledgeAlarm("TT101");
     
     // Return to normal for acknowledged alarm
-    alarmSystem.updateProcessValue("TT101", 145.0);
+    alarmSystem.updateProcessValue(reactorTemp, 145.0);
     
     // Shelve an alarm
     alarmSystem.shelveAlarm("FT303");
@@ -346,5 +1709,21 @@ int main() {
     // Print final alarm summary
     alarmSystem.printAlarmSummary();
     
+    if (journal.isOpen()) {
+        journal.close();
+        if (journal.droppedCount() != 0 || journal.hasWriteError()) {
+            std::cout << "[ERROR] Alarm journal incomplete: " << journal.droppedCount() << " records dropped"
+                      << (journal.hasWriteError() ? ", write failed" : "") << "\n";
+        }
+        if (!history.close()) {
+            std::cout << "[ERROR] Alarm history write failed: " << argv[4] << "\n";
+        }
+        std::vector<JournalRecord> records;
+        readJournal(argv[2], records);
+        std::cout << "=== ALARM JOURNAL ===\n";
+        renderJournal(records, std::cout, &alarmSystem.getTagRegistry());
+        std::cout << "=====================\n\n";
+    }
+    
     return 0;
 }
\ No newline at end of file
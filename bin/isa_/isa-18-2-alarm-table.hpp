@@ -0,0 +1,275 @@
+/**
+ * ISA-18.2 Columnar Alarm Table
+ * Structure-of-arrays alarm store for scan-rate evaluation. Setpoints,
+ * deadbands and states live in contiguous columns and the enable/shelve/
+ * suppress flags are kept as 64-slot bitmasks, so a whole scan is evaluated
+ * with vector compares (AVX2 when compiled with -mavx2, SSE2 otherwise) and
+ * only the slots that actually change state are visited.
+ *
+ * State transitions are identical to Alarm::trigger / Alarm::acknowledge.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "isa-tag-registry.hpp"
+#include "isa-18-2-alarm-types.hpp"
+
+// A single state change produced by AlarmTable::evaluateBatch
+struct AlarmTransition {
+    std::uint32_t slot;
+    AlarmState oldState;
+    AlarmState newState;
+};
+
+class AlarmTable {
+private:
+    // Hot columns, indexed by slot
+    std::vector<double> setpoints;
+    std::vector<double> deadbands;
+    std::vector<double> clearLimits;     // setpoint - deadband, precomputed for the kernel
+    std::vector<AlarmState> states;
+    std::vector<AlarmPriority> priorities;
+    std::vector<std::uint32_t> occurrenceCounts;
+    std::vector<TagId> tagIds;
+
+    // Flag bitmasks, one bit per slot
+    std::vector<std::uint64_t> enabledMask;
+    std::vector<std::uint64_t> shelvedMask;
+    std::vector<std::uint64_t> suppressedMask;
+
+    // Bitmasks derived from states: NORMAL, and active (UNACKNOWLEDGED or ACKNOWLEDGED)
+    std::vector<std::uint64_t> normalMask;
+    std::vector<std::uint64_t> activeMask;
+
+    std::vector<AlarmTransition> transitions;
+
+    static void setBit(std::vector<std::uint64_t>& mask, std::uint32_t slot, bool value) {
+        std::uint64_t bit = std::uint64_t(1) << (slot & 63);
+        if (value) {
+            mask[slot >> 6] |= bit;
+        } else {
+            mask[slot >> 6] &= ~bit;
+        }
+    }
+
+    static bool testBit(const std::vector<std::uint64_t>& mask, std::uint32_t slot) {
+        return (mask[slot >> 6] >> (slot & 63)) & 1;
+    }
+
+    void setState(std::uint32_t slot, AlarmState state) {
+        states[slot] = state;
+        setBit(normalMask, slot, state == AlarmState::NORMAL);
+        setBit(activeMask, slot, state == AlarmState::UNACKNOWLEDGED ||
+                                 state == AlarmState::ACKNOWLEDGED);
+    }
+
+    // Compare up to 64 values against their limits, returning one bit per slot
+    // for "value >= setpoint" (hi) and "value < setpoint - deadband" (lo)
+    static void compareWord(const double* values, const double* sp, const double* clr,
+                            std::size_t count, std::uint64_t& hi, std::uint64_t& lo) {
+        hi = 0;
+        lo = 0;
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 4 <= count; i += 4) {
+            __m256d v = _mm256_loadu_pd(values + i);
+            __m256d h = _mm256_cmp_pd(v, _mm256_loadu_pd(sp + i), _CMP_GE_OQ);
+            __m256d l = _mm256_cmp_pd(v, _mm256_loadu_pd(clr + i), _CMP_LT_OQ);
+            hi |= std::uint64_t(_mm256_movemask_pd(h)) << i;
+            lo |= std::uint64_t(_mm256_movemask_pd(l)) << i;
+        }
+#elif defined(__SSE2__)
+        for (; i + 2 <= count; i += 2) {
+            __m128d v = _mm_loadu_pd(values + i);
+            __m128d h = _mm_cmpge_pd(v, _mm_loadu_pd(sp + i));
+            __m128d l = _mm_cmplt_pd(v, _mm_loadu_pd(clr + i));
+            hi |= std::uint64_t(_mm_movemask_pd(h)) << i;
+            lo |= std::uint64_t(_mm_movemask_pd(l)) << i;
+        }
+#endif
+        for (; i < count; i++) {
+            hi |= std::uint64_t(values[i] >= sp[i]) << i;
+            lo |= std::uint64_t(values[i] < clr[i]) << i;
+        }
+    }
+
+public:
+    // Add an alarm, returning its slot
+    std::uint32_t addAlarm(TagId tag, AlarmPriority prio, double sp, double db) {
+        std::uint32_t slot = static_cast<std::uint32_t>(setpoints.size());
+        setpoints.push_back(sp);
+        deadbands.push_back(db);
+        clearLimits.push_back(sp - db);
+        states.push_back(AlarmState::NORMAL);
+        priorities.push_back(prio);
+        occurrenceCounts.push_back(0);
+        tagIds.push_back(tag);
+        if ((slot & 63) == 0) {
+            enabledMask.push_back(0);
+            shelvedMask.push_back(0);
+            suppressedMask.push_back(0);
+            normalMask.push_back(0);
+            activeMask.push_back(0);
+        }
+        setBit(enabledMask, slot, true);
+        setState(slot, AlarmState::NORMAL);
+        return slot;
+    }
+
+    void reserve(std::size_t count) {
+        setpoints.reserve(count);
+        deadbands.reserve(count);
+        clearLimits.reserve(count);
+        states.reserve(count);
+        priorities.reserve(count);
+        occurrenceCounts.reserve(count);
+        tagIds.reserve(count);
+        std::size_t words = (count + 63) / 64;
+        enabledMask.reserve(words);
+        shelvedMask.reserve(words);
+        suppressedMask.reserve(words);
+        normalMask.reserve(words);
+        activeMask.reserve(words);
+    }
+
+    std::size_t size() const { return setpoints.size(); }
+
+    // Evaluate one scan. values[i] is the process value for slot i; slots at
+    // or beyond n are skipped. Returns the transitions made by this call (the
+    // buffer is reused by the next call).
+    const std::vector<AlarmTransition>& evaluateBatch(const double* values, std::size_t n) {
+        transitions.clear();
+        if (n > size()) {
+            n = size();
+        }
+
+        for (std::size_t word = 0; word * 64 < n; word++) {
+            std::size_t base = word * 64;
+            std::size_t count = (n - base < 64) ? n - base : 64;
+
+            std::uint64_t eligible = enabledMask[word] & ~shelvedMask[word] & ~suppressedMask[word];
+            std::uint64_t watching = eligible & (normalMask[word] | activeMask[word]);
+            if (watching == 0) {
+                continue;
+            }
+
+            std::uint64_t hi, lo;
+            compareWord(values + base, setpoints.data() + base, clearLimits.data() + base,
+                        count, hi, lo);
+
+            std::uint64_t activate = hi & normalMask[word] & eligible;
+            std::uint64_t clear = lo & activeMask[word] & eligible;
+
+            for (std::uint64_t bits = activate; bits != 0; bits &= bits - 1) {
+                std::uint32_t slot = static_cast<std::uint32_t>(base + __builtin_ctzll(bits));
+                transitions.push_back({slot, AlarmState::NORMAL, AlarmState::UNACKNOWLEDGED});
+                setState(slot, AlarmState::UNACKNOWLEDGED);
+                occurrenceCounts[slot]++;
+            }
+            for (std::uint64_t bits = clear; bits != 0; bits &= bits - 1) {
+                std::uint32_t slot = static_cast<std::uint32_t>(base + __builtin_ctzll(bits));
+                transitions.push_back({slot, states[slot], AlarmState::RETURNED_UNACKNOWLEDGED});
+                setState(slot, AlarmState::RETURNED_UNACKNOWLEDGED);
+            }
+        }
+        return transitions;
+    }
+
+    // Transitions made by the most recent evaluateBatch call
+    const std::vector<AlarmTransition>& lastTransitions() const { return transitions; }
+
+    // Acknowledge an alarm (same transitions as Alarm::acknowledge)
+    void acknowledge(std::uint32_t slot) {
+        if (states[slot] == AlarmState::UNACKNOWLEDGED) {
+            setState(slot, AlarmState::ACKNOWLEDGED);
+        } else if (states[slot] == AlarmState::RETURNED_UNACKNOWLEDGED) {
+            setState(slot, AlarmState::NORMAL);
+        }
+    }
+
+    void shelve(std::uint32_t slot) {
+        if (states[slot] != AlarmState::OUT_OF_SERVICE) {
+            setBit(shelvedMask, slot, true);
+            setState(slot, AlarmState::SHELVED);
+        }
+    }
+
+    void unshelve(std::uint32_t slot) {
+        if (states[slot] == AlarmState::SHELVED) {
+            setBit(shelvedMask, slot, false);
+            setState(slot, AlarmState::NORMAL);
+        }
+    }
+
+    void suppress(std::uint32_t slot) {
+        setBit(suppressedMask, slot, true);
+        if (states[slot] != AlarmState::OUT_OF_SERVICE) {
+            setState(slot, AlarmState::SUPPRESSED);
+        }
+    }
+
+    void unsuppress(std::uint32_t slot) {
+        setBit(suppressedMask, slot, false);
+        if (states[slot] == AlarmState::SUPPRESSED) {
+            setState(slot, AlarmState::NORMAL);
+        }
+    }
+
+    void enable(std::uint32_t slot, bool enable) {
+        setBit(enabledMask, slot, enable);
+        if (!enable) {
+            setState(slot, AlarmState::OUT_OF_SERVICE);
+        } else if (states[slot] == AlarmState::OUT_OF_SERVICE) {
+            setState(slot, AlarmState::NORMAL);
+        }
+    }
+
+    // Bulk suppression: replace the suppression flags of one 64-slot word.
+    // Slots whose flag changes move to/from SUPPRESSED exactly as suppress()/
+    // unsuppress() would; their transitions are appended to changes.
+    void setSuppressionWord(std::size_t word, std::uint64_t bits, std::vector<AlarmTransition>& changes) {
+        std::uint64_t base = word * 64;
+        std::uint64_t valid = (size() - base >= 64) ? ~std::uint64_t(0)
+                                                    : (std::uint64_t(1) << (size() - base)) - 1;
+        bits &= valid;
+        std::uint64_t changed = suppressedMask[word] ^ bits;
+        suppressedMask[word] = bits;
+        for (; changed != 0; changed &= changed - 1) {
+            std::uint32_t slot = static_cast<std::uint32_t>(base + __builtin_ctzll(changed));
+            AlarmState before = states[slot];
+            if ((bits >> (slot & 63)) & 1) {
+                if (before != AlarmState::OUT_OF_SERVICE) {
+                    setState(slot, AlarmState::SUPPRESSED);
+                }
+            } else if (before == AlarmState::SUPPRESSED) {
+                setState(slot, AlarmState::NORMAL);
+            }
+            if (states[slot] != before) {
+                changes.push_back({slot, before, states[slot]});
+            }
+        }
+    }
+
+    std::size_t wordCount() const { return suppressedMask.size(); }
+    std::uint64_t suppressionWord(std::size_t word) const { return suppressedMask[word]; }
+
+    AlarmState getState(std::uint32_t slot) const { return states[slot]; }
+    AlarmPriority getPriority(std::uint32_t slot) const { return priorities[slot]; }
+    TagId getTagId(std::uint32_t slot) const { return tagIds[slot]; }
+    double getSetpoint(std::uint32_t slot) const { return setpoints[slot]; }
+    double getDeadband(std::uint32_t slot) const { return deadbands[slot]; }
+    std::uint32_t getOccurrenceCount(std::uint32_t slot) const { return occurrenceCounts[slot]; }
+    bool isEnabled(std::uint32_t slot) const { return testBit(enabledMask, slot); }
+    bool isShelved(std::uint32_t slot) const { return testBit(shelvedMask, slot); }
+    bool isSuppressed(std::uint32_t slot) const { return testBit(suppressedMask, slot); }
+};
@@ -0,0 +1,53 @@
+/**
+ * ISA-18.2 alarm priority and state definitions
+ * Shared by the object-based Alarm model and the columnar alarm table.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// ISA-18.2 defined alarm priorities
+enum class AlarmPriority : std::uint8_t {
+    LOW,
+    MEDIUM,
+    HIGH,
+    CRITICAL
+};
+
+// ISA-18.2 alarm states
+enum class AlarmState : std::uint8_t {
+    NORMAL,
+    UNACKNOWLEDGED,
+    ACKNOWLEDGED,
+    RETURNED_UNACKNOWLEDGED,
+    SHELVED,
+    SUPPRESSED,
+    OUT_OF_SERVICE
+};
+
+// Convert alarm priority to string
+inline std::string priorityToString(AlarmPriority priority) {
+    switch (priority) {
+        case AlarmPriority::LOW: return "LOW";
+        case AlarmPriority::MEDIUM: return "MEDIUM";
+        case AlarmPriority::HIGH: return "HIGH";
+        case AlarmPriority::CRITICAL: return "CRITICAL";
+        default: return "UNKNOWN";
+    }
+}
+
+// Convert alarm state to string
+inline std::string stateToString(AlarmState state) {
+    switch (state) {
+        case AlarmState::NORMAL: return "NORMAL";
+        case AlarmState::UNACKNOWLEDGED: return "UNACKNOWLEDGED";
+        case AlarmState::ACKNOWLEDGED: return "ACKNOWLEDGED";
+        case AlarmState::RETURNED_UNACKNOWLEDGED: return "RETURNED_UNACKNOWLEDGED";
+        case AlarmState::SHELVED: return "SHELVED";
+        case AlarmState::SUPPRESSED: return "SUPPRESSED";
+        case AlarmState::OUT_OF_SERVICE: return "OUT_OF_SERVICE";
+        default: return "UNKNOWN";
+    }
+}
@@ -0,0 +1,301 @@
+/**
+ * ISA-18.2 Process-Value Ingestion
+ * Bounded lock-free multi-producer ring buffer of (tagId, value, timestamp)
+ * samples, drained in batches by a dedicated evaluation thread. I/O driver
+ * threads never block on alarm evaluation or console output: a full ring is
+ * reported through the drop/backpressure counters instead. Samples submitted
+ * before start() or after stop() are rejected and counted as drops; every
+ * accepted sample is evaluated.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "isa-clock.hpp"
+#include "isa-tag-registry.hpp"
+
+// One process-value sample from an I/O driver
+struct ProcessSample {
+    TagId tag;
+    double value;
+    TimestampNs timestamp;
+};
+
+inline std::int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Bounded MPSC ring (sequence-numbered cells, D. Vyukov's bounded queue).
+// Any number of threads may push; exactly one thread may pop.
+template <typename T>
+class BoundedMpscQueue {
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    std::vector<Cell> cells;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> enqueuePos;
+    alignas(64) std::size_t dequeuePos;
+
+public:
+    // Capacity is rounded up to a power of two
+    explicit BoundedMpscQueue(std::size_t capacity) : enqueuePos(0), dequeuePos(0) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells = std::vector<Cell>(size);
+        for (std::size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        mask = size - 1;
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+
+    // Producer side: returns false if the ring is full
+    bool tryPush(const T& item) {
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = item;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer side: pop up to maxItems into out, returning the count
+    std::size_t popBatch(T* out, std::size_t maxItems) {
+        std::size_t count = 0;
+        while (count < maxItems) {
+            Cell& cell = cells[dequeuePos & mask];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (seq != dequeuePos + 1) {
+                break;
+            }
+            out[count++] = cell.data;
+            cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+            dequeuePos++;
+        }
+        return count;
+    }
+};
+
+// Log-linear latency histogram (8 sub-buckets per power of two, ~12% resolution).
+// One writer, any number of concurrent readers.
+class LatencyHistogram {
+private:
+    static constexpr int SUB_BITS = 3;
+    static constexpr int LINEAR = 1 << (SUB_BITS + 1);
+    static constexpr int BUCKETS = LINEAR + (64 - SUB_BITS - 1) * (1 << SUB_BITS);
+
+    std::array<std::atomic<std::uint64_t>, BUCKETS> counts{};
+    std::atomic<std::uint64_t> total{0};
+
+    static int bucketOf(std::uint64_t value) {
+        if (value < static_cast<std::uint64_t>(LINEAR)) {
+            return static_cast<int>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int sub = static_cast<int>((value >> (msb - SUB_BITS)) & ((1 << SUB_BITS) - 1));
+        return LINEAR + (msb - SUB_BITS - 1) * (1 << SUB_BITS) + sub;
+    }
+
+    // Upper bound of the values that fall into a bucket
+    static std::uint64_t bucketLimit(int bucket) {
+        if (bucket < LINEAR) {
+            return static_cast<std::uint64_t>(bucket);
+        }
+        int msb = (bucket - LINEAR) / (1 << SUB_BITS) + SUB_BITS + 1;
+        std::uint64_t sub = static_cast<std::uint64_t>((bucket - LINEAR) % (1 << SUB_BITS));
+        std::uint64_t base = (std::uint64_t(1) << msb) | (sub << (msb - SUB_BITS));
+        return base + (std::uint64_t(1) << (msb - SUB_BITS)) - 1;
+    }
+
+public:
+    void record(std::uint64_t value) {
+        counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::uint64_t count() const { return total.load(std::memory_order_relaxed); }
+
+    // Value at quantile q (0..1), reported as the upper bound of its bucket
+    std::uint64_t percentile(double q) const {
+        std::uint64_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+        std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(n - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            seen += counts[b].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return bucketLimit(b);
+            }
+        }
+        return bucketLimit(BUCKETS - 1);
+    }
+};
+
+// Counters exposed by the ingestor (snapshot)
+struct IngestStatistics {
+    std::uint64_t enqueued;
+    std::uint64_t dropped;            // rejected: ring full, or ingestor not running
+    std::uint64_t backpressureWaits;  // retries by blocking producers on a full ring
+    std::uint64_t evaluated;
+    std::uint64_t batches;
+    std::uint64_t latencyP50Ns;       // enqueue-to-evaluation latency
+    std::uint64_t latencyP99Ns;
+};
+
+// Multi-producer front end with a dedicated evaluation thread.
+// The batch handler runs only on the evaluation thread, so it may call into
+// single-threaded code such as AlarmManagementSystem.
+class ProcessValueIngestor {
+public:
+    using BatchHandler = std::function<void(const ProcessSample*, std::size_t)>;
+
+private:
+    struct Entry {
+        ProcessSample sample;
+        std::int64_t enqueuedAt;    // steady clock, for latency only
+    };
+
+    BoundedMpscQueue<Entry> queue;
+    BatchHandler handler;
+    std::size_t batchSize;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<int> submitting{0};     // producers between the running check and their push
+
+    alignas(64) std::atomic<std::uint64_t> enqueued{0};
+    alignas(64) std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint64_t> backpressureWaits{0};
+    alignas(64) std::atomic<std::uint64_t> evaluated{0};
+    std::atomic<std::uint64_t> batches{0};
+    LatencyHistogram latency;
+
+    std::size_t drainOnce(std::vector<Entry>& entries, std::vector<ProcessSample>& samples) {
+        std::size_t count = queue.popBatch(entries.data(), entries.size());
+        if (count == 0) {
+            return 0;
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            samples[i] = entries[i].sample;
+        }
+        handler(samples.data(), count);
+
+        std::int64_t now = steadyNowNs();
+        for (std::size_t i = 0; i < count; i++) {
+            std::int64_t waited = now - entries[i].enqueuedAt;
+            latency.record(waited > 0 ? static_cast<std::uint64_t>(waited) : 0);
+        }
+        evaluated.fetch_add(count, std::memory_order_relaxed);
+        batches.fetch_add(1, std::memory_order_relaxed);
+        return count;
+    }
+
+    void run() {
+        std::vector<Entry> entries(batchSize);
+        std::vector<ProcessSample> samples(batchSize);
+        int idlePolls = 0;
+        while (running.load(std::memory_order_acquire)) {
+            if (drainOnce(entries, samples) != 0) {
+                idlePolls = 0;
+            } else if (++idlePolls < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+        // Evaluate whatever was accepted before stop(), once no producer that
+        // saw the ingestor running is still pushing
+        while (submitting.load() != 0) {
+            std::this_thread::yield();
+        }
+        while (drainOnce(entries, samples) != 0) {
+        }
+    }
+
+public:
+    ProcessValueIngestor(BatchHandler batchHandler, std::size_t capacity = 65536,
+                         std::size_t maxBatch = 1024)
+        : queue(capacity), handler(std::move(batchHandler)), batchSize(maxBatch) {}
+
+    ~ProcessValueIngestor() { stop(); }
+
+    ProcessValueIngestor(const ProcessValueIngestor&) = delete;
+    ProcessValueIngestor& operator=(const ProcessValueIngestor&) = delete;
+
+    void start() {
+        if (!running.exchange(true)) {
+            worker = std::thread(&ProcessValueIngestor::run, this);
+        }
+    }
+
+    // Stop accepting work, evaluate everything already queued and join
+    void stop() {
+        if (running.exchange(false)) {
+            worker.join();
+        }
+    }
+
+    // Non-blocking submit from any thread; returns false (and counts a drop)
+    // if the ring is full or the ingestor is not running
+    bool submit(TagId tag, double value, TimestampNs timestamp = 0) {
+        Entry entry{{tag, value, timestamp != 0 ? timestamp : clockNowNs()}, steadyNowNs()};
+        submitting.fetch_add(1);
+        bool accepted = running.load() && queue.tryPush(entry);
+        submitting.fetch_sub(1);
+        (accepted ? enqueued : dropped).fetch_add(1, std::memory_order_relaxed);
+        return accepted;
+    }
+
+    // Submit that waits for space instead of dropping (backpressure on the
+    // producer); false (a drop) only if the ingestor is not running or stops
+    bool submitWait(TagId tag, double value, TimestampNs timestamp = 0) {
+        Entry entry{{tag, value, timestamp != 0 ? timestamp : clockNowNs()}, steadyNowNs()};
+        submitting.fetch_add(1);
+        bool accepted = false;
+        while (running.load() && !(accepted = queue.tryPush(entry))) {
+            backpressureWaits.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+        submitting.fetch_sub(1);
+        (accepted ? enqueued : dropped).fetch_add(1, std::memory_order_relaxed);
+        return accepted;
+    }
+
+    IngestStatistics statistics() const {
+        return {enqueued.load(std::memory_order_relaxed),
+                dropped.load(std::memory_order_relaxed),
+                backpressureWaits.load(std::memory_order_relaxed),
+                evaluated.load(std::memory_order_relaxed),
+                batches.load(std::memory_order_relaxed),
+                latency.percentile(0.50),
+                latency.percentile(0.99)};
+    }
+};
@@ -0,0 +1,309 @@
+/**
+ * ISA-18.2 Sharded Alarm Evaluation Engine
+ * Partitions the alarm set into AlarmTable shards by tag ID and evaluates a
+ * scan on a work-stealing thread pool. There are several shards per worker,
+ * so when one area of the plant is in an upset and its shards produce many
+ * transitions, idle workers steal the remaining shards instead of waiting.
+ *
+ * Each shard keeps its own priority and active counters on its own cache
+ * line; totals are merged by summing the shards, without a global lock.
+ * State transitions are those of AlarmTable, i.e. identical to Alarm.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "isa-tag-registry.hpp"
+#include "isa-18-2-alarm-types.hpp"
+#include "isa-18-2-alarm-table.hpp"
+
+// Fixed-size pool of workers with one task deque each. Owners pop from the
+// back of their own deque; idle workers steal from the front of others.
+class WorkStealingPool {
+private:
+    struct alignas(64) WorkerQueue {
+        std::mutex lock;
+        std::deque<std::uint32_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+    const std::function<void(std::uint32_t)>* job = nullptr;
+
+    std::mutex stateLock;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    std::uint64_t epoch = 0;
+    std::size_t remaining = 0;
+    bool stopping = false;
+    std::atomic<std::uint64_t> steals{0};
+
+    bool takeTask(std::size_t worker, std::uint32_t& task) {
+        {
+            WorkerQueue& own = *queues[worker];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (std::size_t i = 1; i < queues.size(); i++) {
+            WorkerQueue& victim = *queues[(worker + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Run tasks until every deque is empty (all tasks are queued before workers wake)
+    void workLoop(std::size_t worker) {
+        std::uint32_t task;
+        std::size_t completed = 0;
+        while (takeTask(worker, task)) {
+            (*job)(task);
+            completed++;
+        }
+        if (completed != 0) {
+            std::lock_guard<std::mutex> guard(stateLock);
+            remaining -= completed;
+            if (remaining == 0) {
+                workDone.notify_all();
+            }
+        }
+    }
+
+    void workerMain(std::size_t worker) {
+        std::uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> guard(stateLock);
+                workReady.wait(guard, [&]() { return stopping || epoch != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = epoch;
+            }
+            workLoop(worker);
+        }
+    }
+
+public:
+    // The calling thread acts as worker 0, so N workers start N-1 threads
+    explicit WorkStealingPool(std::size_t workers) {
+        workers = std::max<std::size_t>(workers, 1);
+        for (std::size_t i = 0; i < workers; i++) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (std::size_t i = 1; i < workers; i++) {
+            threads.emplace_back(&WorkStealingPool::workerMain, this, i);
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            stopping = true;
+        }
+        workReady.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t workerCount() const { return queues.size(); }
+    std::uint64_t stealCount() const { return steals.load(std::memory_order_relaxed); }
+
+    // Run fn(0..taskCount-1) across the pool and wait for completion
+    void run(std::uint32_t taskCount, const std::function<void(std::uint32_t)>& fn) {
+        if (taskCount == 0) {
+            return;
+        }
+        // Publish the job before any task becomes visible: a worker still
+        // draining from the previous run may pick up a task immediately
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            job = &fn;
+            remaining = taskCount;
+        }
+        for (std::uint32_t task = 0; task < taskCount; task++) {
+            WorkerQueue& queue = *queues[task % queues.size()];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            queue.tasks.push_back(task);
+        }
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            epoch++;
+        }
+        workReady.notify_all();
+        workLoop(0);
+
+        std::unique_lock<std::mutex> guard(stateLock);
+        workDone.wait(guard, [&]() { return remaining == 0; });
+        job = nullptr;
+    }
+};
+
+// Location of an alarm inside the sharded engine
+struct AlarmHandle {
+    std::uint32_t shard;
+    std::uint32_t slot;
+};
+
+class ShardedAlarmEngine {
+private:
+    static constexpr std::size_t PRIORITY_COUNT = 4;
+
+    // Per-shard counters, written only by the worker evaluating the shard
+    struct alignas(64) ShardCounters {
+        std::array<std::atomic<int>, PRIORITY_COUNT> byPriority{};
+        std::atomic<int> active{0};
+    };
+
+    struct Shard {
+        AlarmTable table;
+        std::vector<double> gathered;     // this scan's values in slot order
+        ShardCounters counters;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    WorkStealingPool pool;
+
+    // States counted as active alarms (annunciated and not yet cleared by acknowledgement)
+    static bool isCounted(AlarmState state) {
+        return state == AlarmState::UNACKNOWLEDGED ||
+               state == AlarmState::ACKNOWLEDGED ||
+               state == AlarmState::RETURNED_UNACKNOWLEDGED;
+    }
+
+    static void adjustCounters(Shard& shard, AlarmPriority priority, AlarmState before, AlarmState after) {
+        int delta = int(isCounted(after)) - int(isCounted(before));
+        if (delta != 0) {
+            shard.counters.active.fetch_add(delta, std::memory_order_relaxed);
+            shard.counters.byPriority[static_cast<std::size_t>(priority)].fetch_add(
+                delta, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename Operation>
+    void apply(AlarmHandle handle, Operation operation) {
+        Shard& shard = *shards[handle.shard];
+        AlarmState before = shard.table.getState(handle.slot);
+        operation(shard.table, handle.slot);
+        adjustCounters(shard, shard.table.getPriority(handle.slot), before,
+                       shard.table.getState(handle.slot));
+    }
+
+    void evaluateShard(std::uint32_t index, const double* tagValues, std::size_t tagCount) {
+        Shard& shard = *shards[index];
+        std::size_t n = shard.table.size();
+        for (std::size_t slot = 0; slot < n; slot++) {
+            TagId tag = shard.table.getTagId(static_cast<std::uint32_t>(slot));
+            shard.gathered[slot] = tag < tagCount ? tagValues[tag]
+                                                  : std::numeric_limits<double>::quiet_NaN();
+        }
+        for (const AlarmTransition& change : shard.table.evaluateBatch(shard.gathered.data(), n)) {
+            adjustCounters(shard, shard.table.getPriority(change.slot), change.oldState, change.newState);
+        }
+    }
+
+public:
+    // workers: evaluation threads (including the caller); shardCount: 0 = 8 per worker
+    explicit ShardedAlarmEngine(std::size_t workers, std::size_t shardCount = 0)
+        : pool(workers) {
+        if (shardCount == 0) {
+            shardCount = pool.workerCount() * 8;
+        }
+        for (std::size_t i = 0; i < shardCount; i++) {
+            shards.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    // Alarms are placed by tag ID, so all alarms of one tag share a shard
+    AlarmHandle addAlarm(TagId tag, AlarmPriority prio, double sp, double db) {
+        std::uint32_t index = static_cast<std::uint32_t>(tag % shards.size());
+        Shard& shard = *shards[index];
+        std::uint32_t slot = shard.table.addAlarm(tag, prio, sp, db);
+        shard.gathered.push_back(0.0);
+        return {index, slot};
+    }
+
+    // Evaluate one scan; tagValues is indexed by TagId
+    void evaluateScan(const double* tagValues, std::size_t tagCount) {
+        pool.run(static_cast<std::uint32_t>(shards.size()), [&](std::uint32_t index) {
+            evaluateShard(index, tagValues, tagCount);
+        });
+    }
+
+    // Transitions produced by a shard in the last scan
+    const std::vector<AlarmTransition>& lastTransitions(std::uint32_t shard) {
+        return shards[shard]->table.lastTransitions();
+    }
+
+    // Operator actions (call between scans, not concurrently with evaluateScan)
+    void acknowledge(AlarmHandle handle) {
+        apply(handle, [](AlarmTable& table, std::uint32_t slot) { table.acknowledge(slot); });
+    }
+    void shelve(AlarmHandle handle) {
+        apply(handle, [](AlarmTable& table, std::uint32_t slot) { table.shelve(slot); });
+    }
+    void unshelve(AlarmHandle handle) {
+        apply(handle, [](AlarmTable& table, std::uint32_t slot) { table.unshelve(slot); });
+    }
+    void suppress(AlarmHandle handle) {
+        apply(handle, [](AlarmTable& table, std::uint32_t slot) { table.suppress(slot); });
+    }
+    void unsuppress(AlarmHandle handle) {
+        apply(handle, [](AlarmTable& table, std::uint32_t slot) { table.unsuppress(slot); });
+    }
+    void enable(AlarmHandle handle, bool enable) {
+        apply(handle, [enable](AlarmTable& table, std::uint32_t slot) { table.enable(slot, enable); });
+    }
+
+    AlarmState getState(AlarmHandle handle) const {
+        return shards[handle.shard]->table.getState(handle.slot);
+    }
+
+    // Merged counters: a lock-free sum over the shards
+    int activeAlarmCount() const {
+        int total = 0;
+        for (const auto& shard : shards) {
+            total += shard->counters.active.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    int alarmCount(AlarmPriority priority) const {
+        int total = 0;
+        for (const auto& shard : shards) {
+            total += shard->counters.byPriority[static_cast<std::size_t>(priority)].load(
+                std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    std::size_t shardCount() const { return shards.size(); }
+    std::size_t workerCount() const { return pool.workerCount(); }
+    std::uint64_t stealCount() const { return pool.stealCount(); }
+};
@@ -0,0 +1,230 @@
+/**
+ * ISA-18.2 Alarm Flood and State-Based Suppression
+ * Rule engine over an AlarmTable:
+ *  - flood detection from a sliding-window annunciation rate, with
+ *    hysteresis; while flooded, alarms below a priority floor are suppressed
+ *  - state-based (dynamic) suppression groups, e.g. every alarm downstream
+ *    of a unit while that unit is shut down; a group can follow the state of
+ *    a trigger alarm (the unit trip) or be switched explicitly
+ *  - manual per-alarm suppression
+ * The effective suppression of each alarm is the OR of these sources, kept
+ * as 64-slot bitmasks and applied to the table word by word, so a plant trip
+ * costs a handful of word operations per 64 alarms rather than per-alarm
+ * searches. Rules are re-evaluated only when an input changes.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "isa-clock.hpp"
+#include "isa-18-2-alarm-types.hpp"
+#include "isa-18-2-alarm-table.hpp"
+
+// Sliding-window annunciation rate (ring of fixed-width buckets, O(1) per event)
+class FloodDetector {
+private:
+    std::vector<std::uint32_t> buckets;
+    TimestampNs bucketLength;
+    std::int64_t currentBucket = INT64_MIN;
+    std::uint64_t windowCount = 0;
+    std::uint64_t enterThreshold;
+    std::uint64_t exitThreshold;
+    bool flooded = false;
+
+    void advanceTo(std::int64_t bucket) {
+        if (currentBucket == INT64_MIN || bucket - currentBucket >= static_cast<std::int64_t>(buckets.size())) {
+            std::fill(buckets.begin(), buckets.end(), 0);
+            windowCount = 0;
+        } else {
+            for (std::int64_t b = currentBucket + 1; b <= bucket; b++) {
+                std::uint32_t& slot = buckets[static_cast<std::size_t>(b) % buckets.size()];
+                windowCount -= slot;
+                slot = 0;
+            }
+        }
+        currentBucket = bucket;
+    }
+
+public:
+    // Flood starts above enterCount annunciations per window and ends below exitCount
+    FloodDetector(TimestampNs window = 600 * NS_PER_SECOND, std::size_t bucketCount = 60,
+                  std::uint64_t enterCount = 10, std::uint64_t exitCount = 5)
+        : buckets(bucketCount, 0), bucketLength(window / static_cast<TimestampNs>(bucketCount)),
+          enterThreshold(enterCount), exitThreshold(exitCount) {}
+
+    // Record annunciations at time now; returns true if the flood state changed
+    bool record(TimestampNs now, std::uint32_t count) {
+        std::int64_t bucket = now / bucketLength;
+        if (bucket > currentBucket) {
+            advanceTo(bucket);
+        }
+        buckets[static_cast<std::size_t>(currentBucket) % buckets.size()] += count;
+        windowCount += count;
+
+        bool wasFlooded = flooded;
+        if (!flooded && windowCount > enterThreshold) {
+            flooded = true;
+        } else if (flooded && windowCount < exitThreshold) {
+            flooded = false;
+        }
+        return flooded != wasFlooded;
+    }
+
+    bool inFlood() const { return flooded; }
+    std::uint64_t rate() const { return windowCount; }
+};
+
+class SuppressionEngine {
+public:
+    using GroupId = std::uint32_t;
+    static constexpr std::uint32_t NO_TRIGGER = 0xFFFFFFFFu;
+
+private:
+    struct Group {
+        std::string name;
+        std::vector<std::uint64_t> members;
+        std::uint32_t triggerSlot = NO_TRIGGER;
+        bool active = false;
+    };
+
+    AlarmTable& table;
+    FloodDetector flood;
+    AlarmPriority floodFloor;       // while flooded, suppress alarms below this priority
+
+    std::vector<Group> groups;
+    std::vector<std::uint64_t> manual;
+    std::vector<std::uint64_t> belowFloor;
+    std::size_t belowFloorSlots = 0;    // table size when belowFloor was built
+    bool dirty = true;
+    std::vector<AlarmTransition> changes;
+
+    static void setBit(std::vector<std::uint64_t>& mask, std::uint32_t slot, bool value) {
+        if (mask.size() <= slot / 64) {
+            mask.resize(slot / 64 + 1, 0);
+        }
+        std::uint64_t bit = std::uint64_t(1) << (slot & 63);
+        if (value) {
+            mask[slot / 64] |= bit;
+        } else {
+            mask[slot / 64] &= ~bit;
+        }
+    }
+
+    static std::uint64_t wordOf(const std::vector<std::uint64_t>& mask, std::size_t word) {
+        return word < mask.size() ? mask[word] : 0;
+    }
+
+    void refreshPriorityMask() {
+        if (belowFloorSlots == table.size()) {
+            return;
+        }
+        belowFloor.assign(table.wordCount(), 0);
+        for (std::uint32_t slot = 0; slot < table.size(); slot++) {
+            if (table.getPriority(slot) < floodFloor) {
+                belowFloor[slot / 64] |= std::uint64_t(1) << (slot & 63);
+            }
+        }
+        belowFloorSlots = table.size();
+    }
+
+    static bool isAnnunciated(AlarmState state) {
+        return state == AlarmState::UNACKNOWLEDGED || state == AlarmState::ACKNOWLEDGED;
+    }
+
+public:
+    explicit SuppressionEngine(AlarmTable& alarmTable, FloodDetector detector = FloodDetector(),
+                               AlarmPriority floodPriorityFloor = AlarmPriority::HIGH)
+        : table(alarmTable), flood(detector), floodFloor(floodPriorityFloor) {}
+
+    // Create a state-based suppression group. If triggerSlot is given, the
+    // group is active while that alarm is annunciated (e.g. "unit tripped").
+    GroupId addGroup(const std::string& name, std::uint32_t triggerSlot = NO_TRIGGER) {
+        groups.push_back({name, {}, triggerSlot, false});
+        return static_cast<GroupId>(groups.size() - 1);
+    }
+
+    void addToGroup(GroupId group, std::uint32_t slot) {
+        setBit(groups[group].members, slot, true);
+        dirty |= groups[group].active;
+    }
+
+    // Explicit unit state, e.g. from the PLC sequence ("unit shut down")
+    void setGroupActive(GroupId group, bool active) {
+        if (groups[group].active != active) {
+            groups[group].active = active;
+            dirty = true;
+        }
+    }
+
+    void suppress(std::uint32_t slot) {
+        setBit(manual, slot, true);
+        dirty = true;
+    }
+
+    void unsuppress(std::uint32_t slot) {
+        setBit(manual, slot, false);
+        dirty = true;
+    }
+
+    // Call after each AlarmTable::evaluateBatch. Feeds the flood detector,
+    // follows trigger alarms, and re-applies suppression if any rule changed.
+    // Returns the SUPPRESSED/NORMAL transitions this caused.
+    const std::vector<AlarmTransition>& update(TimestampNs now, const std::vector<AlarmTransition>& scan) {
+        changes.clear();
+        std::uint32_t annunciated = 0;
+        for (const AlarmTransition& change : scan) {
+            annunciated += change.newState == AlarmState::UNACKNOWLEDGED;
+        }
+        dirty |= flood.record(now, annunciated);
+
+        for (Group& group : groups) {
+            if (group.triggerSlot != NO_TRIGGER) {
+                bool active = isAnnunciated(table.getState(group.triggerSlot));
+                if (active != group.active) {
+                    group.active = active;
+                    dirty = true;
+                }
+            }
+        }
+        if (dirty) {
+            apply();
+        }
+        return changes;
+    }
+
+    // Recompute effective suppression and push it into the table word by word
+    void apply() {
+        refreshPriorityMask();
+        bool flooded = flood.inFlood();
+        for (std::size_t word = 0; word < table.wordCount(); word++) {
+            std::uint64_t bits = wordOf(manual, word);
+            if (flooded) {
+                bits |= belowFloor[word];
+            }
+            for (const Group& group : groups) {
+                if (group.active) {
+                    std::uint64_t members = wordOf(group.members, word);
+                    // A trigger alarm is never suppressed by its own group
+                    if (group.triggerSlot != NO_TRIGGER && group.triggerSlot / 64 == word) {
+                        members &= ~(std::uint64_t(1) << (group.triggerSlot & 63));
+                    }
+                    bits |= members;
+                }
+            }
+            if (bits != table.suppressionWord(word)) {
+                table.setSuppressionWord(word, bits, changes);
+            }
+        }
+        dirty = false;
+    }
+
+    bool inFlood() const { return flood.inFlood(); }
+    std::uint64_t floodRate() const { return flood.rate(); }
+    bool isGroupActive(GroupId group) const { return groups[group].active; }
+    const std::string& groupName(GroupId group) const { return groups[group].name; }
+};
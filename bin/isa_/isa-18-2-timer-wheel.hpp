@@ -0,0 +1,183 @@
+/**
+ * ISA-18.2 Hierarchical Timer Wheel
+ * Drives alarm timers (shelving expiry, on-delay/off-delay, re-trigger
+ * suppression) without polling every alarm. Five levels of 64 slots cover
+ * 2^30 ticks (about 124 days at 10 ms); scheduling and cancelling are O(1)
+ * and each tick only touches the timers that are due or cascade down a level.
+ *
+ * Timers are identified by caller-assigned dense IDs (for example
+ * alarmIndex * kinds + kind) and live in a node array linked into the slots
+ * intrusively, so arming a timer never allocates.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class TimerWheel {
+public:
+    using TimerId = std::uint32_t;
+
+private:
+    static constexpr int LEVELS = 5;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr std::uint32_t SLOTS = 1u << SLOT_BITS;
+    static constexpr std::uint32_t SLOT_MASK = SLOTS - 1;
+    static constexpr TimerId NONE = 0xFFFFFFFFu;
+    static constexpr std::uint64_t MAX_DELAY = (std::uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+
+    struct Node {
+        std::uint64_t expiry = 0;
+        TimerId next = NONE;
+        TimerId prev = NONE;
+        std::uint16_t slot = 0;     // level * SLOTS + index while scheduled
+        bool scheduled = false;
+    };
+
+    std::vector<Node> nodes;
+    TimerId heads[LEVELS * SLOTS];
+    std::uint64_t occupied[LEVELS] = {};   // one bit per non-empty slot
+    std::uint64_t current = 0;
+    std::size_t scheduledCount = 0;
+
+    void link(TimerId id) {
+        Node& node = nodes[id];
+        std::uint64_t delta = node.expiry > current ? node.expiry - current : 0;
+        if (delta > MAX_DELAY) {
+            delta = MAX_DELAY;      // re-cascaded until it is in range
+        }
+        std::uint64_t due = current + delta;
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= (std::uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+            level++;
+        }
+        std::uint32_t index = static_cast<std::uint32_t>((due >> (SLOT_BITS * level)) & SLOT_MASK);
+        std::uint16_t slot = static_cast<std::uint16_t>(level * SLOTS + index);
+
+        node.slot = slot;
+        node.prev = NONE;
+        node.next = heads[slot];
+        if (node.next != NONE) {
+            nodes[node.next].prev = id;
+        }
+        heads[slot] = id;
+        occupied[level] |= std::uint64_t(1) << index;
+    }
+
+    void unlink(TimerId id) {
+        Node& node = nodes[id];
+        if (node.prev != NONE) {
+            nodes[node.prev].next = node.next;
+        } else {
+            heads[node.slot] = node.next;
+            if (node.next == NONE) {
+                occupied[node.slot / SLOTS] &= ~(std::uint64_t(1) << (node.slot & SLOT_MASK));
+            }
+        }
+        if (node.next != NONE) {
+            nodes[node.next].prev = node.prev;
+        }
+    }
+
+    // Move every timer of a higher-level slot down to where it now belongs
+    void cascade(int level, std::uint32_t index) {
+        std::uint16_t slot = static_cast<std::uint16_t>(level * SLOTS + index);
+        TimerId id = heads[slot];
+        heads[slot] = NONE;
+        occupied[level] &= ~(std::uint64_t(1) << index);
+        while (id != NONE) {
+            TimerId next = nodes[id].next;
+            link(id);
+            id = next;
+        }
+    }
+
+public:
+    explicit TimerWheel(std::size_t capacity = 0) : nodes(capacity) {
+        for (TimerId& head : heads) {
+            head = NONE;
+        }
+    }
+
+    // Grow the ID space (existing timers are unaffected)
+    void resize(std::size_t capacity) {
+        if (capacity > nodes.size()) {
+            nodes.resize(capacity);
+        }
+    }
+
+    std::size_t capacity() const { return nodes.size(); }
+    std::uint64_t now() const { return current; }
+    std::size_t size() const { return scheduledCount; }
+    bool isScheduled(TimerId id) const { return nodes[id].scheduled; }
+    std::uint64_t expiryOf(TimerId id) const { return nodes[id].expiry; }
+
+    // Arm (or re-arm) a timer to fire delayTicks from now
+    void schedule(TimerId id, std::uint64_t delayTicks) {
+        cancel(id);
+        Node& node = nodes[id];
+        node.expiry = current + (delayTicks == 0 ? 1 : delayTicks);
+        node.scheduled = true;
+        scheduledCount++;
+        link(id);
+    }
+
+    void cancel(TimerId id) {
+        Node& node = nodes[id];
+        if (node.scheduled) {
+            unlink(id);
+            node.scheduled = false;
+            scheduledCount--;
+        }
+    }
+
+    // Advance the wheel, calling fire(id) for each expired timer in expiry order
+    template <typename Fire>
+    void advance(std::uint64_t ticks, Fire fire) {
+        std::uint64_t target = current + ticks;
+        while (current < target) {
+            if (scheduledCount == 0) {
+                current = target;
+                return;
+            }
+            // Skip empty slots: on the lowest non-empty level, jump to its next
+            // occupied slot or its next wrap (where the level above cascades),
+            // whichever comes first. Idle stretches cost one step per slot.
+            int lowest = 0;
+            while (lowest < LEVELS - 1 && occupied[lowest] == 0) {
+                lowest++;
+            }
+            int shift = SLOT_BITS * lowest;
+            std::uint32_t position = static_cast<std::uint32_t>((current >> shift) & SLOT_MASK);
+            std::uint64_t step = SLOTS - position;
+            std::uint64_t ahead = position == SLOT_MASK ? 0 : occupied[lowest] >> (position + 1);
+            if (ahead != 0) {
+                step = static_cast<std::uint64_t>(__builtin_ctzll(ahead)) + 1;
+            }
+            std::uint64_t next = ((current >> shift) + step) << shift;
+            if (next > target) {
+                current = target;
+                return;
+            }
+            current = next;
+            std::uint32_t index = static_cast<std::uint32_t>(current & SLOT_MASK);
+            for (int level = 1; index == 0 && level < LEVELS; level++) {
+                index = static_cast<std::uint32_t>((current >> (SLOT_BITS * level)) & SLOT_MASK);
+                if (occupied[level] & (std::uint64_t(1) << index)) {
+                    cascade(level, index);
+                }
+            }
+
+            // After cascading, everything in the current level-0 slot is due.
+            // Pop one at a time so fire() may cancel or re-arm any timer.
+            std::uint32_t slot0 = static_cast<std::uint32_t>(current & SLOT_MASK);
+            while (heads[slot0] != NONE) {
+                TimerId id = heads[slot0];
+                cancel(id);
+                fire(id);
+            }
+        }
+    }
+};
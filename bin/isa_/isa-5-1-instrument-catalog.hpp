@@ -0,0 +1,375 @@
+/**
+ * ISA-5.1 Instrument Catalog
+ * Each instrument tag (measurement letter, device letter, loop number) is
+ * packed into one 64-bit InstrumentKey, ordered so that keys sort by
+ * measurement, device, then loop. Tags are parsed from text into keys and
+ * formatted back into a caller's buffer without touching the heap. The
+ * catalog stores keys in a flat array, finds them through an open-addressing
+ * hash table, and answers range queries ("loop 101", "PT*", "P*") from two
+ * sorted ID indexes that are rebuilt only after the catalog has changed.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Define symbol types according to ISA-5.1
+enum class MeasurementType {
+    FLOW,           // F
+    TEMPERATURE,    // T
+    PRESSURE,       // P
+    LEVEL,          // L
+    ANALYSIS        // A
+};
+
+enum class DeviceType {
+    INDICATOR,      // I
+    TRANSMITTER,    // T
+    CONTROLLER,     // C
+    VALVE,          // V
+    SWITCH          // S
+};
+
+constexpr char measurementLetter(MeasurementType type) {
+    switch (type) {
+        case MeasurementType::FLOW: return 'F';
+        case MeasurementType::TEMPERATURE: return 'T';
+        case MeasurementType::PRESSURE: return 'P';
+        case MeasurementType::LEVEL: return 'L';
+        case MeasurementType::ANALYSIS: return 'A';
+    }
+    return '?';
+}
+
+constexpr char deviceLetter(DeviceType type) {
+    switch (type) {
+        case DeviceType::INDICATOR: return 'I';
+        case DeviceType::TRANSMITTER: return 'T';
+        case DeviceType::CONTROLLER: return 'C';
+        case DeviceType::VALVE: return 'V';
+        case DeviceType::SWITCH: return 'S';
+    }
+    return '?';
+}
+
+// Packed tag: measurement letter | device letter | loop number | digit count.
+// The digit count keeps leading zeros ("FT0101" and "FT101" are different tags).
+class InstrumentKey {
+public:
+    static constexpr std::size_t MAX_DIGITS = 9;
+    static constexpr std::size_t MAX_LENGTH = 2 + MAX_DIGITS;     // without the terminating NUL
+
+private:
+    std::uint64_t packed = 0;      // 0 is never a valid key
+
+    static bool isLetter(char c) { return c >= 'A' && c <= 'Z'; }
+
+    // Largest loop number that fits in the digit count
+    static std::uint64_t loopLimit(unsigned digits) {
+        std::uint64_t limit = 1;
+        for (unsigned i = 0; i < digits; i++) {
+            limit *= 10;
+        }
+        return limit - 1;
+    }
+
+public:
+    InstrumentKey() = default;
+
+    // Invalid (valid() == false) unless both letters are A-Z, 1 <= digits <=
+    // MAX_DIGITS and the loop number fits in the digits
+    InstrumentKey(char measurement, char device, std::uint32_t loop, unsigned digits)
+        : packed(isLetter(measurement) && isLetter(device) && digits >= 1 && digits <= MAX_DIGITS &&
+                         loop <= loopLimit(digits)
+                     ? std::uint64_t(std::uint8_t(measurement)) << 56 | std::uint64_t(std::uint8_t(device)) << 48 |
+                           std::uint64_t(loop) << 8 | digits
+                     : 0) {}
+
+    InstrumentKey(MeasurementType measurement, DeviceType device, std::uint32_t loop, unsigned digits)
+        : InstrumentKey(measurementLetter(measurement), deviceLetter(device), loop, digits) {}
+
+    // Parse "FT101" (or "FT-101"); returns an invalid key for anything else
+    static InstrumentKey parse(std::string_view text) {
+        if (text.size() < 3 || !isLetter(text[0]) || !isLetter(text[1])) {
+            return {};
+        }
+        std::size_t i = text[2] == '-' ? 3 : 2;
+        std::size_t digits = text.size() - i;
+        if (digits == 0 || digits > MAX_DIGITS) {
+            return {};
+        }
+        std::uint32_t loop = 0;
+        for (; i < text.size(); i++) {
+            unsigned digit = static_cast<unsigned char>(text[i]) - '0';
+            if (digit > 9) {
+                return {};
+            }
+            loop = loop * 10 + digit;
+        }
+        return InstrumentKey(text[0], text[1], loop, static_cast<unsigned>(digits));
+    }
+
+    // Parse just the loop part ("101"); digits only
+    static bool parseLoop(std::string_view text, std::uint32_t& loop, unsigned& digits) {
+        if (text.empty() || text.size() > MAX_DIGITS) {
+            return false;
+        }
+        loop = 0;
+        for (char c : text) {
+            unsigned digit = static_cast<unsigned char>(c) - '0';
+            if (digit > 9) {
+                return false;
+            }
+            loop = loop * 10 + digit;
+        }
+        digits = static_cast<unsigned>(text.size());
+        return true;
+    }
+
+    bool valid() const { return packed != 0; }
+    std::uint64_t value() const { return packed; }
+    char measurement() const { return static_cast<char>(packed >> 56); }
+    char device() const { return static_cast<char>(packed >> 48); }
+    std::uint32_t loop() const { return static_cast<std::uint32_t>(packed >> 8); }
+    unsigned digits() const { return static_cast<unsigned>(packed & 0xFF); }
+
+    // Write the tag into buffer (at least MAX_LENGTH + 1 bytes); returns its length
+    std::size_t format(char* buffer) const {
+        std::size_t n = digits();
+        buffer[0] = measurement();
+        buffer[1] = device();
+        std::uint32_t loop = this->loop();
+        for (std::size_t i = n; i > 0; i--) {
+            buffer[1 + i] = static_cast<char>('0' + loop % 10);
+            loop /= 10;
+        }
+        buffer[2 + n] = '\0';
+        return 2 + n;
+    }
+
+    std::string str() const {
+        char buffer[MAX_LENGTH + 1];
+        return std::string(buffer, format(buffer));
+    }
+
+    bool operator==(InstrumentKey other) const { return packed == other.packed; }
+    bool operator!=(InstrumentKey other) const { return packed != other.packed; }
+    bool operator<(InstrumentKey other) const { return packed < other.packed; }
+};
+
+using InstrumentId = std::uint32_t;
+constexpr InstrumentId INVALID_INSTRUMENT_ID = 0xFFFFFFFFu;
+
+// Result of a range query: a view into one of the catalog's sorted indexes,
+// valid until the catalog is next modified
+struct InstrumentRange {
+    const InstrumentId* first = nullptr;
+    const InstrumentId* last = nullptr;
+
+    const InstrumentId* begin() const { return first; }
+    const InstrumentId* end() const { return last; }
+    std::size_t size() const { return static_cast<std::size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+class InstrumentCatalog {
+private:
+    // Instruments by ID, in insertion order
+    std::vector<InstrumentKey> keys;
+    std::vector<std::uint8_t> fieldMounted;
+
+    // Open addressing with linear probing; a zero key marks an empty slot
+    std::vector<std::uint64_t> slotKeys;
+    std::vector<InstrumentId> slotIds;
+    unsigned shift = 64;
+
+    // IDs sorted by key, and by (loop, key)
+    std::vector<InstrumentId> byKey;
+    std::vector<InstrumentId> byLoop;
+    std::vector<std::pair<std::uint64_t, InstrumentId>> sortBuffer;
+    bool indexed = true;
+
+    std::size_t home(std::uint64_t key) const {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+
+    void rehash(std::size_t capacity) {
+        std::size_t size = 16;
+        unsigned bits = 4;
+        while (size < capacity * 2) {       // keep the load factor at or below 1/2
+            size *= 2;
+            bits++;
+        }
+        if (size <= slotKeys.size()) {
+            return;
+        }
+        slotKeys.assign(size, 0);
+        slotIds.assign(size, INVALID_INSTRUMENT_ID);
+        shift = 64 - bits;
+        for (InstrumentId id = 0; id < keys.size(); id++) {
+            place(keys[id].value(), id);
+        }
+    }
+
+    void place(std::uint64_t key, InstrumentId id) {
+        std::size_t mask = slotKeys.size() - 1;
+        std::size_t slot = home(key);
+        while (slotKeys[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slotKeys[slot] = key;
+        slotIds[slot] = id;
+    }
+
+    // Sort IDs by a 64-bit sort key through a reused (key, ID) buffer
+    template <typename SortKey>
+    void buildIndex(std::vector<InstrumentId>& index, SortKey sortKey) {
+        sortBuffer.resize(keys.size());
+        for (InstrumentId id = 0; id < keys.size(); id++) {
+            sortBuffer[id] = {sortKey(keys[id]), id};
+        }
+        std::sort(sortBuffer.begin(), sortBuffer.end());
+        index.resize(keys.size());
+        for (std::size_t i = 0; i < sortBuffer.size(); i++) {
+            index[i] = sortBuffer[i].second;
+        }
+    }
+
+    static std::uint64_t loopOrder(InstrumentKey key) {
+        // loop (32) | measurement (8) | device (8) | digits (8)
+        return std::uint64_t(key.loop()) << 32 | (key.value() >> 40) | key.digits();
+    }
+
+    void ensureIndexed() {
+        if (!indexed) {
+            buildIndex(byKey, [](InstrumentKey key) { return key.value(); });
+            buildIndex(byLoop, loopOrder);
+            indexed = true;
+        }
+    }
+
+    // IDs whose sort key lies in [lo, hi] within an index sorted by sortKey
+    template <typename SortKey>
+    InstrumentRange range(const std::vector<InstrumentId>& index, SortKey sortKey,
+                          std::uint64_t lo, std::uint64_t hi) const {
+        auto first = std::lower_bound(index.begin(), index.end(), lo,
+            [&](InstrumentId id, std::uint64_t bound) { return sortKey(keys[id]) < bound; });
+        auto last = std::upper_bound(first, index.end(), hi,
+            [&](std::uint64_t bound, InstrumentId id) { return bound < sortKey(keys[id]); });
+        return {index.data() + (first - index.begin()), index.data() + (last - index.begin())};
+    }
+
+public:
+    void reserve(std::size_t count) {
+        keys.reserve(count);
+        fieldMounted.reserve(count);
+        rehash(count);
+    }
+
+    // Add an instrument and return its ID; an existing tag keeps its ID
+    InstrumentId add(InstrumentKey key, bool isFieldMounted = true) {
+        if (!key.valid()) {
+            return INVALID_INSTRUMENT_ID;
+        }
+        InstrumentId existing = find(key);
+        if (existing != INVALID_INSTRUMENT_ID) {
+            return existing;
+        }
+        rehash(keys.size() + 1);
+        InstrumentId id = static_cast<InstrumentId>(keys.size());
+        keys.push_back(key);
+        fieldMounted.push_back(isFieldMounted);
+        place(key.value(), id);
+        indexed = false;
+        return id;
+    }
+
+    InstrumentId add(std::string_view tag, bool isFieldMounted = true) {
+        return add(InstrumentKey::parse(tag), isFieldMounted);
+    }
+
+    // Bulk import of whitespace-separated tags; returns how many were
+    // rejected (malformed), duplicates are not counted as rejected
+    std::size_t import(std::string_view text, bool isFieldMounted = true) {
+        std::size_t rejected = 0;
+        std::size_t i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && (text[i] == ' ' || text[i] == '\t' || text[i] == '\r' || text[i] == '\n')) {
+                i++;
+            }
+            std::size_t start = i;
+            while (i < text.size() && text[i] != ' ' && text[i] != '\t' && text[i] != '\r' && text[i] != '\n') {
+                i++;
+            }
+            if (i > start && add(text.substr(start, i - start), isFieldMounted) == INVALID_INSTRUMENT_ID) {
+                rejected++;
+            }
+        }
+        return rejected;
+    }
+
+    InstrumentId find(InstrumentKey key) const {
+        if (slotKeys.empty() || !key.valid()) {
+            return INVALID_INSTRUMENT_ID;
+        }
+        std::size_t mask = slotKeys.size() - 1;
+        for (std::size_t slot = home(key.value()); slotKeys[slot] != 0; slot = (slot + 1) & mask) {
+            if (slotKeys[slot] == key.value()) {
+                return slotIds[slot];
+            }
+        }
+        return INVALID_INSTRUMENT_ID;
+    }
+
+    InstrumentId find(std::string_view tag) const { return find(InstrumentKey::parse(tag)); }
+
+    // Every instrument in a loop, ordered by measurement and device letter
+    InstrumentRange loop(std::uint32_t number) {
+        ensureIndexed();
+        std::uint64_t base = std::uint64_t(number) << 32;
+        return range(byLoop, loopOrder, base, base | 0xFFFFFFFFu);
+    }
+
+    // Every instrument whose tag starts with one or two letters ("P", "PT"),
+    // a trailing '*' is accepted ("PT*"); ordered by tag
+    InstrumentRange withPrefix(std::string_view prefix) {
+        if (!prefix.empty() && prefix.back() == '*') {
+            prefix.remove_suffix(1);
+        }
+        if (prefix.empty() || prefix.size() > 2) {
+            return {};
+        }
+        ensureIndexed();
+        std::uint64_t lo = std::uint64_t(std::uint8_t(prefix[0])) << 56;
+        std::uint64_t hi = lo | 0x00FFFFFFFFFFFFFFull;
+        if (prefix.size() == 2) {
+            lo |= std::uint64_t(std::uint8_t(prefix[1])) << 48;
+            hi = lo | 0x0000FFFFFFFFFFFFull;
+        }
+        return range(byKey, [](InstrumentKey key) { return key.value(); }, lo, hi);
+    }
+
+    // IDs in tag order
+    InstrumentRange all() {
+        ensureIndexed();
+        return {byKey.data(), byKey.data() + byKey.size()};
+    }
+
+    InstrumentKey key(InstrumentId id) const { return keys[id]; }
+    bool isFieldMounted(InstrumentId id) const { return fieldMounted[id] != 0; }
+    std::size_t size() const { return keys.size(); }
+
+    // Heap bytes held by the catalog (keys, flags, hash table, indexes)
+    std::size_t memoryBytes() const {
+        return keys.capacity() * sizeof(InstrumentKey) + fieldMounted.capacity() +
+               slotKeys.capacity() * sizeof(std::uint64_t) + slotIds.capacity() * sizeof(InstrumentId) +
+               (byKey.capacity() + byLoop.capacity()) * sizeof(InstrumentId) +
+               sortBuffer.capacity() * sizeof(sortBuffer[0]);
+    }
+};
@@ -1,70 +1,52 @@
 /**
  * ISA-5.1 Simulation - Instrumentation Symbols and Identification
  * This program simulates a system that represents and manages process instrumentation symbols
+ *
+ * Build: g++ -std=c++17 -O2 isa-5-1-symbols-simulation.cpp
+ * Usage: isa-5-1-symbols-simulation                 display the P&ID
+ *        isa-5-1-symbols-simulation --bench [tags]  bulk import and query a site-sized catalog
  */
 
 #include <iostream>
 #include <string>
 #include <map>
 #include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
 
-// Define symbol types according to ISA-5.1
-enum class MeasurementType {
-    FLOW,           // F
-    TEMPERATURE,    // T
-    PRESSURE,       // P
-    LEVEL,          // L
-    ANALYSIS        // A
-};
-
-enum class DeviceType {
-    INDICATOR,      // I
-    TRANSMITTER,    // T
-    CONTROLLER,     // C
-    VALVE,          // V
-    SWITCH          // S
-};
+#include "isa-5-1-instrument-catalog.hpp"
 
 // Class representing an ISA-5.1 instrument tag
 class ISATag {
 private:
-    std::string loopNumber;
-    MeasurementType measurementType;
-    DeviceType deviceType;
+    InstrumentKey key;
     bool isFieldMounted;
 
 public:
-    ISATag(MeasurementType mt, DeviceType dt, std::string loop, bool fieldMounted = true) 
-        : measurementType(mt), deviceType(dt), loopNumber(loop), isFieldMounted(fieldMounted) {}
+    // The loop number must be numeric (e.g. "101"); otherwise the tag is left
+    // invalid, which callers check with valid() before using it
+    ISATag(MeasurementType mt, DeviceType dt, const std::string& loop, bool fieldMounted = true)
+        : isFieldMounted(fieldMounted) {
+        std::uint32_t number = 0;
+        unsigned digits = 0;
+        if (InstrumentKey::parseLoop(loop, number, digits)) {
+            key = InstrumentKey(mt, dt, number, digits);
+        } else {
+            std::cout << "[ERROR] Invalid loop number: " << loop << "\n";
+        }
+    }
 
     // Generate the tag according to ISA-5.1 format
     std::string getTagString() const {
-        std::string tag;
-        
-        // Add measurement type letter
-        switch (measurementType) {
-            case MeasurementType::FLOW: tag += "F"; break;
-            case MeasurementType::TEMPERATURE: tag += "T"; break;
-            case MeasurementType::PRESSURE: tag += "P"; break;
-            case MeasurementType::LEVEL: tag += "L"; break;
-            case MeasurementType::ANALYSIS: tag += "A"; break;
-        }
-        
-        // Add device type letter
-        switch (deviceType) {
-            case DeviceType::INDICATOR: tag += "I"; break;
-            case DeviceType::TRANSMITTER: tag += "T"; break;
-            case DeviceType::CONTROLLER: tag += "C"; break;
-            case DeviceType::VALVE: tag += "V"; break;
-            case DeviceType::SWITCH: tag += "S"; break;
-        }
-        
-        // Add loop number
-        tag += loopNumber;
-        
-        return tag;
+        return key.str();
     }
-    
+
+    InstrumentKey getKey() const { return key; }
+    bool fieldMounted() const { return isFieldMounted; }
+    bool valid() const { return key.valid(); }
+
     void displaySymbol() const {
         std::string tag = getTagString();
         std::cout << "---------------------\n";
@@ -85,14 +67,33 @@ public:
 class PIDDiagram {
 private:
     std::vector<ISATag> instruments;
+    InstrumentCatalog catalog;
+    std::vector<std::size_t> positions;     // catalog ID -> first instrument with that tag
     std::string diagramName;
 
 public:
     PIDDiagram(const std::string& name) : diagramName(name) {}
     
-    void addInstrument(const ISATag& instrument) {
+    // Invalid tags (see ISATag::valid()) are refused
+    bool addInstrument(const ISATag& instrument) {
+        if (!instrument.valid()) {
+            return false;
+        }
         instruments.push_back(instrument);
+        InstrumentId id = catalog.add(instrument.getKey(), instrument.fieldMounted());
+        if (id == positions.size()) {
+            positions.push_back(instruments.size() - 1);
+        }
+        return true;
     }
+
+    // Look up an instrument by tag, e.g. "FT101"
+    const ISATag* findInstrument(std::string_view tag) const {
+        InstrumentId id = catalog.find(tag);
+        return id == INVALID_INSTRUMENT_ID ? nullptr : &instruments[positions[id]];
+    }
+
+    InstrumentCatalog& getCatalog() { return catalog; }
     
     void display() const {
         std::cout << "P&ID Diagram: " << diagramName << "\n";
@@ -105,7 +106,87 @@ public:
     }
 };
 
-int main() {
+// Benchmark: bulk import and lookup of a site-wide instrument index
+int benchmarkCatalog(std::size_t count) {
+    if (count == 0) {
+        std::cout << "[ERROR] Catalog benchmark needs at least one tag\n";
+        return 1;
+    }
+    // Loops 100 .. lastLoop, four tags each, all with as many digits as the last loop needs
+    const std::uint64_t lastLoop = 100 + (count - 1) / 4;
+    unsigned digits = 1;
+    for (std::uint64_t rest = lastLoop / 10; rest != 0; rest /= 10) {
+        digits++;
+    }
+    if (digits > InstrumentKey::MAX_DIGITS) {
+        std::cout << "[ERROR] Too many tags for " << InstrumentKey::MAX_DIGITS << "-digit loop numbers\n";
+        return 1;
+    }
+    const std::size_t width = 2 + digits;
+
+    const char measurements[] = "FTPLA";
+    const char devices[] = "ITCVS";
+    std::string text;
+    text.reserve(count * (width + 1));
+    std::uint64_t state = 42;
+    for (std::size_t i = 0; i < count; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        char tag[InstrumentKey::MAX_LENGTH + 1];
+        std::size_t length = InstrumentKey(measurements[(state >> 33) % 5], devices[(state >> 41) % 5],
+                                           static_cast<std::uint32_t>(100 + i / 4), digits).format(tag);
+        text.append(tag, length).push_back('\n');
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto rate = [&](Clock::time_point start, std::size_t operations) {
+        return operations / std::chrono::duration<double>(Clock::now() - start).count() / 1e6;
+    };
+
+    InstrumentCatalog catalog;
+    catalog.reserve(count);
+    auto start = Clock::now();
+    std::size_t rejected = catalog.import(text);
+    double importRate = rate(start, count);
+
+    std::size_t found = 0;
+    start = Clock::now();
+    for (std::size_t at = 0; at < text.size(); at += width + 1) {
+        found += catalog.find(std::string_view(text.data() + at, width)) != INVALID_INSTRUMENT_ID;
+    }
+    double lookupRate = rate(start, count);
+
+    start = Clock::now();
+    catalog.all();
+    double indexMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::size_t inLoops = 0;
+    start = Clock::now();
+    for (std::uint64_t loop = 100; loop <= lastLoop; loop++) {
+        inLoops += catalog.loop(static_cast<std::uint32_t>(loop)).size();
+    }
+    double loopRate = rate(start, static_cast<std::size_t>(lastLoop - 99));
+
+    std::cout << "Instrument catalog, " << count << " tags (" << catalog.size() << " unique, " << rejected
+              << " rejected, " << catalog.memoryBytes() / std::max<std::size_t>(catalog.size(), 1)
+              << " bytes/tag):\n";
+    std::cout << "  Import: " << importRate << " M tags/s, lookup: " << lookupRate << " M tags/s ("
+              << found << " found), index build: " << indexMs << " ms\n";
+    std::cout << "  Loop queries: " << loopRate << " M/s (" << inLoops << " instruments)\n";
+
+    std::cout << "  Loop 101:";
+    for (InstrumentId id : catalog.loop(101)) {
+        std::cout << " " << catalog.key(id).str();
+    }
+    std::cout << "\n  PT*: " << catalog.withPrefix("PT*").size() << ", P*: " << catalog.withPrefix("P").size()
+              << ", FT*: " << catalog.withPrefix("FT").size() << "\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return benchmarkCatalog(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000);
+    }
+
     std::cout << "ISA-5.1 Instrumentation Symbols and Identification Simulation\n\n";
     
     // Create a P&ID diagram
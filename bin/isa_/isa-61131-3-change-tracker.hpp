@@ -0,0 +1,211 @@
+/**
+ * ISA-61131-3 Change Tracking and Delta Publishing
+ * After each scan the process image is compared with a shadow copy of the
+ * previous one, a 64-bit word at a time: bit areas by XOR, INT/REAL cells
+ * by raw bit pattern (so -0.0 and NaN payload changes count), BOOL bytes
+ * eight at a time. Only the points that changed go into a DeltaBatch of
+ * 8-byte records, which is handed to subscribers (HMI, historian, alarm
+ * system); nothing is sent for a scan that changed nothing. Cost and
+ * volume therefore follow the change rate rather than the tag count. A
+ * subscriber that joins late or loses a batch asks for snapshot() - a full
+ * batch of every point - and continues from there with deltas.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "isa-clock.hpp"
+#include "isa-61131-3-process-image.hpp"
+
+// One changed point: area and index packed in 32 bits, value as raw bits
+struct PointChange {
+    static constexpr std::uint32_t INDEX_BITS = 29;
+
+    std::uint32_t point;        // area << INDEX_BITS | index
+    std::uint32_t value;        // 0/1 for bits and BOOL, INT value, REAL bit pattern
+
+    static PointChange make(PLCArea area, std::uint32_t index, std::uint32_t value) {
+        return {static_cast<std::uint32_t>(area) << INDEX_BITS | index, value};
+    }
+
+    PLCAddress address() const {
+        return {static_cast<PLCArea>(point >> INDEX_BITS), point & ((1u << INDEX_BITS) - 1)};
+    }
+
+    bool asBool() const { return value != 0; }
+    std::int32_t asInt() const { return static_cast<std::int32_t>(value); }
+    float asReal() const {
+        float real;
+        std::memcpy(&real, &value, sizeof(real));
+        return real;
+    }
+};
+
+static_assert(sizeof(PointChange) == 8, "point changes are 8-byte records");
+
+struct DeltaBatch {
+    std::uint64_t sequence = 0;     // delivered batches are consecutive, so a gap means a lost
+                                    // batch; a snapshot carries the last delivered sequence
+    TimestampNs time = 0;
+    bool full = false;              // snapshot of every point rather than a delta
+    std::vector<PointChange> changes;
+
+    std::size_t bytes() const { return sizeof(sequence) + sizeof(time) + changes.size() * sizeof(PointChange); }
+};
+
+class ChangeTracker {
+public:
+    using Subscriber = std::function<void(const DeltaBatch&)>;
+
+private:
+    ProcessImage previous;
+    DeltaBatch batch;
+    std::vector<Subscriber> subscribers;
+    std::uint64_t sequence = 0;     // of the last delivered batch
+    std::uint64_t collected = 0;
+
+    template <typename T>
+    static std::uint32_t bits(T value) {
+        std::uint32_t raw = 0;
+        std::memcpy(&raw, &value, sizeof(T));
+        return raw;
+    }
+
+    static std::uint64_t load64(const void* data) {
+        std::uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        return word;
+    }
+
+    // Bit area: XOR whole words, then walk the set bits
+    void diffBits(PLCArea area, std::uint32_t count, const std::vector<std::uint64_t>& now,
+                  const std::vector<std::uint64_t>& before) {
+        for (std::size_t w = 0; w < now.size(); w++) {
+            // a word the shadow does not have yet reports every bit once
+            std::uint64_t changed = w < before.size() ? now[w] ^ before[w] : ~std::uint64_t(0);
+            while (changed != 0) {
+                unsigned bit = static_cast<unsigned>(__builtin_ctzll(changed));
+                changed &= changed - 1;
+                std::uint32_t index = static_cast<std::uint32_t>(w * 64 + bit);
+                if (index < count) {
+                    batch.changes.push_back(PointChange::make(area, index, (now[w] >> bit) & 1));
+                }
+            }
+        }
+    }
+
+    // 32-bit cells (INT or REAL): compare two cells per 64-bit load
+    template <typename T>
+    void diffCells(PLCArea area, const std::vector<T>& now, const std::vector<T>& before) {
+        static_assert(sizeof(T) == 4, "cells are 32-bit");
+        std::size_t common = before.size() < now.size() ? before.size() : now.size();
+        std::size_t i = 0;
+        for (; i + 2 <= common; i += 2) {
+            if (load64(&now[i]) == load64(&before[i])) {
+                continue;
+            }
+            for (std::size_t j = i; j < i + 2; j++) {
+                if (bits(now[j]) != bits(before[j])) {
+                    batch.changes.push_back(PointChange::make(area, static_cast<std::uint32_t>(j), bits(now[j])));
+                }
+            }
+        }
+        for (; i < now.size(); i++) {
+            if (i >= before.size() || bits(now[i]) != bits(before[i])) {
+                batch.changes.push_back(PointChange::make(area, static_cast<std::uint32_t>(i), bits(now[i])));
+            }
+        }
+    }
+
+    // BOOL bytes, eight per 64-bit load
+    void diffBytes(const std::vector<std::uint8_t>& now, const std::vector<std::uint8_t>& before) {
+        std::size_t common = before.size() < now.size() ? before.size() : now.size();
+        std::size_t i = 0;
+        for (; i + 8 <= common; i += 8) {
+            if (load64(&now[i]) == load64(&before[i])) {
+                continue;
+            }
+            for (std::size_t j = i; j < i + 8; j++) {
+                if (now[j] != before[j]) {
+                    batch.changes.push_back(PointChange::make(PLCArea::BOOL, static_cast<std::uint32_t>(j), now[j]));
+                }
+            }
+        }
+        for (; i < now.size(); i++) {
+            if (i >= before.size() || now[i] != before[i]) {
+                batch.changes.push_back(PointChange::make(PLCArea::BOOL, static_cast<std::uint32_t>(i), now[i]));
+            }
+        }
+    }
+
+    void begin(TimestampNs now, bool full) {
+        batch.changes.clear();
+        batch.sequence = sequence;
+        batch.time = now;
+        batch.full = full;
+    }
+
+    void deliver() {
+        batch.sequence = ++sequence;
+        for (const Subscriber& subscriber : subscribers) {
+            subscriber(batch);
+        }
+    }
+
+public:
+    void subscribe(Subscriber subscriber) { subscribers.push_back(std::move(subscriber)); }
+
+    // Points changed since the previous call (every point on the first);
+    // the image becomes the new reference
+    const DeltaBatch& collect(const ProcessImage& image, TimestampNs now) {
+        begin(now, false);
+        collected++;
+        diffBits(PLCArea::INPUT, image.inputCount, image.inputs, previous.inputs);
+        diffBits(PLCArea::OUTPUT, image.outputCount, image.outputs, previous.outputs);
+        diffCells(PLCArea::INT, image.integers, previous.integers);
+        diffCells(PLCArea::REAL, image.reals, previous.reals);
+        diffBytes(image.booleans, previous.booleans);
+        previous = image;           // reuses the shadow's capacity
+        return batch;
+    }
+
+    // Collect and hand a non-empty batch to every subscriber; returns the change count
+    std::size_t publish(const ProcessImage& image, TimestampNs now = clockNowNs()) {
+        collect(image, now);
+        if (!batch.changes.empty()) {
+            deliver();
+        }
+        return batch.changes.size();
+    }
+
+    // Every point of the image, for a subscriber that (re)joins; does not
+    // move the reference used for deltas. Its sequence is that of the last
+    // delivered batch, so the subscriber expects sequence + 1 next.
+    const DeltaBatch& snapshot(const ProcessImage& image, TimestampNs now = clockNowNs()) {
+        begin(now, true);
+        for (std::uint32_t i = 0; i < image.inputCount; i++) {
+            batch.changes.push_back(PointChange::make(PLCArea::INPUT, i, image.input(i)));
+        }
+        for (std::uint32_t i = 0; i < image.outputCount; i++) {
+            batch.changes.push_back(PointChange::make(PLCArea::OUTPUT, i, image.output(i)));
+        }
+        for (std::size_t i = 0; i < image.integers.size(); i++) {
+            batch.changes.push_back(PointChange::make(PLCArea::INT, static_cast<std::uint32_t>(i), bits(image.integers[i])));
+        }
+        for (std::size_t i = 0; i < image.reals.size(); i++) {
+            batch.changes.push_back(PointChange::make(PLCArea::REAL, static_cast<std::uint32_t>(i), bits(image.reals[i])));
+        }
+        for (std::size_t i = 0; i < image.booleans.size(); i++) {
+            batch.changes.push_back(PointChange::make(PLCArea::BOOL, static_cast<std::uint32_t>(i), image.booleans[i]));
+        }
+        return batch;
+    }
+
+    std::uint64_t batches() const { return sequence; }     // delivered
+    std::uint64_t scans() const { return collected; }      // collect() calls, quiet ones included
+};
@@ -0,0 +1,307 @@
+/**
+ * ISA-61131-3 Batched Function Block Execution
+ * Runs one compiled function block over many instances at once. Instance
+ * frames are stored structure-of-arrays in groups of LANES instances:
+ * cell c of every instance in a group is one contiguous row, so a load,
+ * store or ALU instruction is a fixed-width loop over lanes that the
+ * compiler turns into vector instructions, and dispatch is paid once per
+ * group instead of once per instance.
+ *
+ * Lanes that branch differently are handled SIMT-style: each lane keeps
+ * its own pc, the group always executes the lowest pending pc with the
+ * lanes waiting there active, and lanes reconverge when the others catch
+ * up. The compiler emits structured code in which, at any jump target,
+ * only registers below the statement's base (FOR end values of enclosing
+ * loops) are live, so register writes need no mask; frame stores are
+ * masked per lane. Instance state matches the scalar VM exactly; a store
+ * to the shared process image takes the last active lane's value.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "isa-61131-3-function-block.hpp"
+#include "isa-61131-3-process-image.hpp"
+#include "isa-61131-3-st-vm.hpp"
+
+class STBatchMachine {
+public:
+    static constexpr std::size_t LANES = 16;
+
+private:
+    static constexpr std::uint32_t DONE = UINT32_MAX;
+
+    using Row = STCell[LANES];
+
+    // Execute an ALU opcode on every lane
+    template <OpCode op>
+    static void alu(Row& dst, const Row& a, const Row& b) {
+        for (std::size_t l = 0; l < LANES; l++) {
+            dst[l] = STVirtualMachine::apply<op>(a[l], b[l]);
+        }
+    }
+
+    // The value a store to shared memory takes: the last active lane's, as
+    // if the instances had run one after another
+    static STCell lastActive(const Row& value, const bool* active) {
+        std::size_t lane = LANES - 1;
+        while (!active[lane]) {
+            lane--;
+        }
+        return value[lane];
+    }
+
+public:
+    // Execute one pass of the program for the first `lanes` instances of a
+    // group; frame points at the group's rows ([cell][lane])
+    static void run(const STProgram& program, ProcessImage& image, STCell* frame, std::size_t lanes) {
+        alignas(64) Row r[STVirtualMachine::REGISTER_COUNT];
+        std::uint32_t lanePc[LANES];        // pc of each lane while it is waiting
+        bool active[LANES];
+        for (std::size_t l = 0; l < LANES; l++) {
+            lanePc[l] = l < lanes ? 0 : DONE;
+            active[l] = l < lanes;
+        }
+        std::uint32_t pc = 0;
+        std::uint32_t waitPc = DONE;        // lowest pc a waiting lane is parked at
+
+        const std::uint64_t* inputs = image.inputs.data();
+        std::uint64_t* outputs = image.outputs.data();
+        std::int32_t* integers = image.integers.data();
+        float* reals = image.reals.data();
+        std::uint8_t* booleans = image.booleans.data();
+        const Instruction* code = program.code.data();
+
+        for (;;) {
+            const Instruction& in = code[pc];
+            bool jumped = false;
+            switch (in.op) {
+                case OpCode::LOAD_CONST:
+                    for (std::size_t l = 0; l < LANES; l++) {
+                        r[in.dst][l].i = in.operand;
+                    }
+                    break;
+                case OpCode::LOAD_INPUT:
+                case OpCode::LOAD_OUTPUT: {
+                    const std::uint64_t* bits = in.op == OpCode::LOAD_INPUT ? inputs : outputs;
+                    std::int32_t bit = static_cast<std::int32_t>((bits[in.operand >> 6] >> (in.operand & 63)) & 1);
+                    for (std::size_t l = 0; l < LANES; l++) {
+                        r[in.dst][l].i = bit;
+                    }
+                    break;
+                }
+                case OpCode::STORE_OUTPUT: {
+                    std::uint64_t mask = std::uint64_t(1) << (in.operand & 63);
+                    std::uint64_t& word = outputs[in.operand >> 6];
+                    word = (word & ~mask) | (-static_cast<std::uint64_t>(lastActive(r[in.lhs], active).i & 1) & mask);
+                    break;
+                }
+                case OpCode::LOAD_INT:
+                case OpCode::LOAD_REAL:
+                case OpCode::LOAD_BOOL: {
+                    STCell value;
+                    if (in.op == OpCode::LOAD_INT) {
+                        value.i = integers[in.operand];
+                    } else if (in.op == OpCode::LOAD_REAL) {
+                        value.r = reals[in.operand];
+                    } else {
+                        value.i = booleans[in.operand];
+                    }
+                    for (std::size_t l = 0; l < LANES; l++) {
+                        r[in.dst][l] = value;
+                    }
+                    break;
+                }
+                case OpCode::STORE_INT: integers[in.operand] = lastActive(r[in.lhs], active).i; break;
+                case OpCode::STORE_REAL: reals[in.operand] = lastActive(r[in.lhs], active).r; break;
+                case OpCode::STORE_BOOL:
+                    booleans[in.operand] = static_cast<std::uint8_t>(lastActive(r[in.lhs], active).i);
+                    break;
+
+                case OpCode::LOAD_LOCAL: {
+                    const STCell* row = frame + std::size_t(in.operand) * LANES;
+                    for (std::size_t l = 0; l < LANES; l++) {
+                        r[in.dst][l] = row[l];
+                    }
+                    break;
+                }
+                case OpCode::STORE_LOCAL: {
+                    STCell* row = frame + std::size_t(in.operand) * LANES;
+                    for (std::size_t l = 0; l < LANES; l++) {
+                        row[l].i = active[l] ? r[in.lhs][l].i : row[l].i;
+                    }
+                    break;
+                }
+                case OpCode::LOAD_LOCAL_INDEXED: {
+                    std::uint32_t packed = static_cast<std::uint32_t>(in.operand);
+                    for (std::size_t l = 0; l < LANES; l++) {
+                        std::uint32_t element = static_cast<std::uint32_t>(r[in.lhs][l].i);
+                        r[in.dst][l].i = element < (packed >> 16)
+                            ? frame[((packed & 0xFFFF) + element) * LANES + l].i : 0;
+                    }
+                    break;
+                }
+                case OpCode::STORE_LOCAL_INDEXED: {
+                    std::uint32_t packed = static_cast<std::uint32_t>(in.operand);
+                    for (std::size_t l = 0; l < LANES; l++) {
+                        std::uint32_t element = static_cast<std::uint32_t>(r[in.rhs][l].i);
+                        if (active[l] && element < (packed >> 16)) {
+                            frame[((packed & 0xFFFF) + element) * LANES + l] = r[in.lhs][l];
+                        }
+                    }
+                    break;
+                }
+
+                case OpCode::ADD_INT: alu<OpCode::ADD_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::SUB_INT: alu<OpCode::SUB_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::MUL_INT: alu<OpCode::MUL_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::DIV_INT: alu<OpCode::DIV_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::MOD_INT: alu<OpCode::MOD_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::NEG_INT: alu<OpCode::NEG_INT>(r[in.dst], r[in.lhs], r[in.lhs]); break;
+
+                case OpCode::ADD_REAL: alu<OpCode::ADD_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::SUB_REAL: alu<OpCode::SUB_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::MUL_REAL: alu<OpCode::MUL_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::DIV_REAL: alu<OpCode::DIV_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::NEG_REAL: alu<OpCode::NEG_REAL>(r[in.dst], r[in.lhs], r[in.lhs]); break;
+
+                case OpCode::EQ_INT: alu<OpCode::EQ_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::NE_INT: alu<OpCode::NE_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::LT_INT: alu<OpCode::LT_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::LE_INT: alu<OpCode::LE_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::GT_INT: alu<OpCode::GT_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::GE_INT: alu<OpCode::GE_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+
+                case OpCode::EQ_REAL: alu<OpCode::EQ_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::NE_REAL: alu<OpCode::NE_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::LT_REAL: alu<OpCode::LT_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::LE_REAL: alu<OpCode::LE_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::GT_REAL: alu<OpCode::GT_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::GE_REAL: alu<OpCode::GE_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+
+                case OpCode::AND: alu<OpCode::AND>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::OR: alu<OpCode::OR>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::XOR: alu<OpCode::XOR>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::NOT: alu<OpCode::NOT>(r[in.dst], r[in.lhs], r[in.lhs]); break;
+
+                case OpCode::INT_TO_REAL: alu<OpCode::INT_TO_REAL>(r[in.dst], r[in.lhs], r[in.lhs]); break;
+                case OpCode::REAL_TO_INT: alu<OpCode::REAL_TO_INT>(r[in.dst], r[in.lhs], r[in.lhs]); break;
+                case OpCode::TRUNC_REAL: alu<OpCode::TRUNC_REAL>(r[in.dst], r[in.lhs], r[in.lhs]); break;
+
+                case OpCode::ABS_INT: alu<OpCode::ABS_INT>(r[in.dst], r[in.lhs], r[in.lhs]); break;
+                case OpCode::ABS_REAL: alu<OpCode::ABS_REAL>(r[in.dst], r[in.lhs], r[in.lhs]); break;
+
+                case OpCode::MIN_INT: alu<OpCode::MIN_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::MAX_INT: alu<OpCode::MAX_INT>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::MIN_REAL: alu<OpCode::MIN_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+                case OpCode::MAX_REAL: alu<OpCode::MAX_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+
+                case OpCode::SQRT_REAL: alu<OpCode::SQRT_REAL>(r[in.dst], r[in.lhs], r[in.lhs]); break;
+                case OpCode::SQUARE_REAL: alu<OpCode::SQUARE_REAL>(r[in.dst], r[in.lhs], r[in.lhs]); break;
+                case OpCode::EXPT_REAL: alu<OpCode::EXPT_REAL>(r[in.dst], r[in.lhs], r[in.rhs]); break;
+
+                case OpCode::JUMP:
+                    for (std::size_t l = 0; l < LANES; l++) {
+                        lanePc[l] = active[l] ? static_cast<std::uint32_t>(in.operand) : lanePc[l];
+                    }
+                    jumped = true;
+                    break;
+                case OpCode::JUMP_IF_FALSE:
+                    for (std::size_t l = 0; l < LANES; l++) {
+                        std::uint32_t target = r[in.lhs][l].i == 0 ? static_cast<std::uint32_t>(in.operand) : pc + 1;
+                        lanePc[l] = active[l] ? target : lanePc[l];
+                    }
+                    jumped = true;
+                    break;
+                case OpCode::HALT:
+                    for (std::size_t l = 0; l < LANES; l++) {
+                        lanePc[l] = active[l] ? DONE : lanePc[l];
+                    }
+                    jumped = true;
+                    break;
+            }
+
+            if (!jumped) {
+                pc++;
+                if (pc != waitPc) {
+                    continue;       // no lane is waiting here: keep the same active set
+                }
+                for (std::size_t l = 0; l < LANES; l++) {
+                    lanePc[l] = active[l] ? pc : lanePc[l];
+                }
+            }
+            // Continue at the lowest pending pc with the lanes parked there
+            pc = DONE;
+            for (std::size_t l = 0; l < LANES; l++) {
+                pc = lanePc[l] < pc ? lanePc[l] : pc;
+            }
+            if (pc == DONE) {
+                return;
+            }
+            waitPc = DONE;
+            for (std::size_t l = 0; l < LANES; l++) {
+                active[l] = lanePc[l] == pc;
+                waitPc = (!active[l] && lanePc[l] < waitPc) ? lanePc[l] : waitPc;
+            }
+        }
+    }
+};
+
+// Instances of one function block in structure-of-arrays groups of LANES
+class FBBatch {
+public:
+    static constexpr std::size_t LANES = STBatchMachine::LANES;
+
+private:
+    const STFunctionBlock& block;
+    std::vector<STCell> cells;      // [group][cell][lane]
+    std::size_t count = 0;
+
+    std::size_t groupSize() const { return block.frameSize() * LANES; }
+
+    STCell& cell(std::size_t instance, std::int32_t slot) {
+        return cells[(instance / LANES) * groupSize() + std::size_t(slot) * LANES + instance % LANES];
+    }
+
+    const STCell& cell(std::size_t instance, std::int32_t slot) const {
+        return cells[(instance / LANES) * groupSize() + std::size_t(slot) * LANES + instance % LANES];
+    }
+
+public:
+    explicit FBBatch(const STFunctionBlock& functionBlock) : block(functionBlock) {}
+
+    // Add instances initialized from the declared initial values; returns the first index
+    std::size_t add(std::size_t instances = 1) {
+        std::size_t first = count;
+        count += instances;
+        std::size_t groups = (count + LANES - 1) / LANES;
+        while (cells.size() < groups * groupSize()) {
+            for (const STCell& initial : block.initialFrame) {
+                cells.insert(cells.end(), LANES, initial);
+            }
+        }
+        return first;
+    }
+
+    std::size_t size() const { return count; }
+    const STFunctionBlock& functionBlock() const { return block; }
+
+    // Typed access by slot (resolve slots once with STFunctionBlock::slot)
+    void setReal(std::size_t instance, std::int32_t slot, float value) { cell(instance, slot).r = value; }
+    float getReal(std::size_t instance, std::int32_t slot) const { return cell(instance, slot).r; }
+    void setInteger(std::size_t instance, std::int32_t slot, std::int32_t value) { cell(instance, slot).i = value; }
+    std::int32_t getInteger(std::size_t instance, std::int32_t slot) const { return cell(instance, slot).i; }
+    void setBoolean(std::size_t instance, std::int32_t slot, bool value) { cell(instance, slot).i = value; }
+    bool getBoolean(std::size_t instance, std::int32_t slot) const { return cell(instance, slot).i != 0; }
+
+    // Call every instance once
+    void scan(ProcessImage& image) {
+        for (std::size_t first = 0; first < count; first += LANES) {
+            std::size_t lanes = count - first < LANES ? count - first : LANES;
+            STBatchMachine::run(block.program, image, cells.data() + (first / LANES) * groupSize(), lanes);
+        }
+    }
+};
@@ -0,0 +1,117 @@
+/**
+ * ISA-61131-3 Function Blocks and Instance Arrays
+ * A compiled FUNCTION_BLOCK is one bytecode program plus a frame layout:
+ * every input, output, in-out, static and temporary variable gets a fixed
+ * offset (arrays take consecutive cells) in a frame of 32-bit cells, while
+ * VAR CONSTANT values are folded into the code and take no space. An
+ * instance is just a frame. FBInstanceArray packs the frames of many
+ * instances back to back and runs the same code over each in turn, so a
+ * site with thousands of fans or enclosures is one contiguous array.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "isa-61131-3-process-image.hpp"
+#include "isa-61131-3-st-parser.hpp"
+#include "isa-61131-3-st-vm.hpp"
+
+// A variable in the instance frame
+struct STVariable {
+    std::string name;
+    STType type;
+    VarSection section;
+    std::uint32_t offset;       // first cell in the frame
+    std::uint32_t length;       // cells: 1, or the array length
+    std::int32_t lower;         // array lower bound
+    bool array;
+};
+
+struct STFunctionBlock {
+    static constexpr std::int32_t NO_SLOT = -1;
+
+    std::string name;
+    std::vector<STVariable> variables;
+    std::vector<STCell> initialFrame;       // declared initial values; size is the frame size
+    STProgram program;
+
+    std::size_t frameSize() const { return initialFrame.size(); }
+
+    const STVariable* find(const std::string& variable) const {
+        for (const STVariable& v : variables) {
+            if (v.name == variable) {
+                return &v;
+            }
+        }
+        return nullptr;
+    }
+
+    // Frame offset of a scalar or of an array element, or NO_SLOT
+    std::int32_t slot(const std::string& variable, std::int32_t index = 0) const {
+        const STVariable* v = find(variable);
+        if (v == nullptr) {
+            return NO_SLOT;
+        }
+        std::int64_t element = v->array ? std::int64_t(index) - v->lower : 0;
+        if (element < 0 || element >= v->length) {
+            return NO_SLOT;
+        }
+        return static_cast<std::int32_t>(v->offset + element);
+    }
+
+    void clear() {
+        name.clear();
+        variables.clear();
+        initialFrame.clear();
+        program.clear();
+    }
+};
+
+// Instances of one function block stored as consecutive frames
+class FBInstanceArray {
+private:
+    const STFunctionBlock& block;
+    std::vector<STCell> frames;
+    std::size_t count = 0;
+
+public:
+    explicit FBInstanceArray(const STFunctionBlock& functionBlock) : block(functionBlock) {}
+
+    // Add instances initialized from the declared initial values; returns the first index
+    std::size_t add(std::size_t instances = 1) {
+        std::size_t first = count;
+        frames.reserve(frames.size() + instances * block.frameSize());
+        for (std::size_t i = 0; i < instances; i++) {
+            frames.insert(frames.end(), block.initialFrame.begin(), block.initialFrame.end());
+        }
+        count += instances;
+        return first;
+    }
+
+    std::size_t size() const { return count; }
+    const STFunctionBlock& functionBlock() const { return block; }
+
+    STCell* frame(std::size_t instance) { return frames.data() + instance * block.frameSize(); }
+    const STCell* frame(std::size_t instance) const { return frames.data() + instance * block.frameSize(); }
+
+    // Typed access by slot (resolve slots once with STFunctionBlock::slot)
+    void setReal(std::size_t instance, std::int32_t slot, float value) { frame(instance)[slot].r = value; }
+    float getReal(std::size_t instance, std::int32_t slot) const { return frame(instance)[slot].r; }
+    void setInteger(std::size_t instance, std::int32_t slot, std::int32_t value) { frame(instance)[slot].i = value; }
+    std::int32_t getInteger(std::size_t instance, std::int32_t slot) const { return frame(instance)[slot].i; }
+    void setBoolean(std::size_t instance, std::int32_t slot, bool value) { frame(instance)[slot].i = value; }
+    bool getBoolean(std::size_t instance, std::int32_t slot) const { return frame(instance)[slot].i != 0; }
+
+    // Call every instance once, in order
+    void scan(ProcessImage& image) {
+        std::size_t size = block.frameSize();
+        STCell* instanceFrame = frames.data();
+        for (std::size_t i = 0; i < count; i++, instanceFrame += size) {
+            STVirtualMachine::run(block.program, image, instanceFrame);
+        }
+    }
+};
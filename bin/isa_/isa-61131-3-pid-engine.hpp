@@ -0,0 +1,406 @@
+/**
+ * ISA-61131-3 PID Engine (fb_pid)
+ * Native implementation of the fb_pid block (documentation/function_blocks/
+ * fb_pid.md) for many loops at once. Inputs, tuning, state and outputs are
+ * kept as one array per field (structure of arrays) and a scan steps every
+ * loop with the same straight-line code: the operating modes are per-loop
+ * bit masks that select between the candidate outputs, so there is no
+ * branch on a mode flag and 8 (AVX2) or 4 (SSE2) loops advance per
+ * instruction. Every path - SIMD, scalar tail and stepScalar() - runs the
+ * same templated kernel, so results are bit-identical.
+ *
+ * Per loop and scan (dt seconds):
+ *   e      = SP - PV (reverse acting) or PV - SP (direct acting)
+ *   e'     = e outside the dead band, 0 inside
+ *   P      = Kp * e'            D = Kp * Td * (e' - e'[previous]) / dt
+ *   I      = I[previous] + Kp * dt / Ti * e'     (no integral when Ti = 0)
+ *   CV     = P + I + D (auto) or the manual value, rate limited to
+ *            CVRoC * dt per scan (CVRoC = 0: unlimited), then clamped to
+ *            [CVLoLimit, CVHiLimit]; hold keeps the previous CV and track
+ *            follows the (clamped) track value. Priority: track, hold,
+ *            manual, auto.
+ * Anti-windup is by back-calculation with conditional integration: when
+ * the auto output is limited (windup), or the loop is not in auto, the
+ * integral is reset so that P + I + D equals the CV actually output. The
+ * same rule gives bumpless transfer back to auto, and in auto the manual
+ * value tracks CV so switching to manual is bumpless as well.
+ *
+ * Loops can be bound to process-image slots (SP/PV/manual/track REAL,
+ * mode BOOLs, CV REAL); scan() gathers the inputs, steps and writes back.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "isa-61131-3-process-image.hpp"
+
+// Configuration parameters; defaults as in fb_pid.md
+struct PIDTuning {
+    float kp = 1.0f;            // i_rKp
+    float ti = 60.0f;           // i_rTi (s), 0 = no integral action
+    float td = 0.0f;            // i_rTd (s)
+    float deadBand = 0.0f;      // i_rDeadBand
+    bool directAction = false;  // i_bDirectAction
+    float cvHiLimit = 100.0f;   // i_rCVHiLimit
+    float cvLoLimit = 0.0f;     // i_rCVLoLimit
+    float cvRoC = 10.0f;        // i_rCVRoC (%/s), 0 = unlimited
+};
+
+// Process-image slots of one loop; unbound (NONE) inputs keep their column value
+struct PIDBinding {
+    PLCAddress sp;              // REAL
+    PLCAddress pv;              // REAL
+    PLCAddress cv;              // REAL, written
+    PLCAddress manualMode;      // BOOL
+    PLCAddress manualValue;     // REAL, written (tracks CV in auto)
+    PLCAddress trackMode;       // BOOL
+    PLCAddress trackValue;      // REAL
+    PLCAddress hold;            // BOOL
+};
+
+class PIDEngine {
+public:
+    // Mode bits (modes column)
+    static constexpr std::uint32_t MANUAL = 1;
+    static constexpr std::uint32_t TRACK = 2;
+    static constexpr std::uint32_t HOLD = 4;
+    static constexpr std::uint32_t DIRECT = 8;
+
+    // Status bits (o_bHiLimit, o_bLoLimit, o_bWindup, o_bManMode)
+    static constexpr std::uint32_t HI_LIMIT = 1;
+    static constexpr std::uint32_t LO_LIMIT = 2;
+    static constexpr std::uint32_t WINDUP = 4;
+    static constexpr std::uint32_t IN_MANUAL = 8;
+
+private:
+    static constexpr std::uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+    // Inputs
+    std::vector<float> sp, pv, manualValue, trackValue;
+    std::vector<std::uint32_t> modes;
+    // Tuning, stored in the form the kernel uses
+    std::vector<float> kp, kd, kpOverTi, deadBand, cvHi, cvLo, roc;
+    // State and outputs
+    std::vector<float> integral, lastError, cv, error, pTerm, dTerm;
+    std::vector<std::uint32_t> status;
+    // Bindings, one slot column per field
+    std::vector<std::uint32_t> spSlot, pvSlot, cvSlot, manualModeSlot, manualValueSlot,
+                               trackModeSlot, trackValueSlot, holdSlot;
+
+    struct ScalarLanes {
+        static constexpr std::size_t WIDTH = 1;
+        using F = float;
+        using M = bool;
+        using S = std::uint32_t;
+        static F load(const float* p) { return *p; }
+        static void store(float* p, F v) { *p = v; }
+        static F set(float v) { return v; }
+        static F add(F a, F b) { return a + b; }
+        static F sub(F a, F b) { return a - b; }
+        static F mul(F a, F b) { return a * b; }
+        static F min(F a, F b) { return a < b ? a : b; }
+        static F max(F a, F b) { return a > b ? a : b; }
+        static F abs(F a) { return std::fabs(a); }
+        static M gt(F a, F b) { return a > b; }
+        static M ge(F a, F b) { return a >= b; }
+        static M le(F a, F b) { return a <= b; }
+        static M ne(F a, F b) { return a != b; }
+        static M both(M a, M b) { return a && b; }
+        static M either(M a, M b) { return a || b; }
+        static M invert(M a) { return !a; }
+        static F select(M m, F a, F b) { return m ? a : b; }
+        static S loadBits(const std::uint32_t* p) { return *p; }
+        static void storeBits(std::uint32_t* p, S v) { *p = v; }
+        static M test(S bits, std::uint32_t bit) { return (bits & bit) != 0; }
+        static S flag(M m, std::uint32_t bit) { return m ? bit : 0; }
+        static S join(S a, S b) { return a | b; }
+    };
+
+#if defined(__AVX2__)
+    struct VectorLanes {
+        static constexpr std::size_t WIDTH = 8;
+        using F = __m256;
+        using M = __m256;
+        using S = __m256i;
+        static F load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, F v) { _mm256_storeu_ps(p, v); }
+        static F set(float v) { return _mm256_set1_ps(v); }
+        static F add(F a, F b) { return _mm256_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+        static F min(F a, F b) { return _mm256_min_ps(a, b); }
+        static F max(F a, F b) { return _mm256_max_ps(a, b); }
+        static F abs(F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        static M gt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static M ge(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+        static M le(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+        static M ne(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+        static M both(M a, M b) { return _mm256_and_ps(a, b); }
+        static M either(M a, M b) { return _mm256_or_ps(a, b); }
+        static M invert(M a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+        static F select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+        static S loadBits(const std::uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static void storeBits(std::uint32_t* p, S v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+        static M test(S bits, std::uint32_t bit) {
+            __m256i b = _mm256_set1_epi32(static_cast<int>(bit));
+            return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(bits, b), b));
+        }
+        static S flag(M m, std::uint32_t bit) {
+            return _mm256_and_si256(_mm256_castps_si256(m), _mm256_set1_epi32(static_cast<int>(bit)));
+        }
+        static S join(S a, S b) { return _mm256_or_si256(a, b); }
+    };
+#elif defined(__SSE2__)
+    struct VectorLanes {
+        static constexpr std::size_t WIDTH = 4;
+        using F = __m128;
+        using M = __m128;
+        using S = __m128i;
+        static F load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, F v) { _mm_storeu_ps(p, v); }
+        static F set(float v) { return _mm_set1_ps(v); }
+        static F add(F a, F b) { return _mm_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+        static F min(F a, F b) { return _mm_min_ps(a, b); }
+        static F max(F a, F b) { return _mm_max_ps(a, b); }
+        static F abs(F a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        static M gt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+        static M ge(F a, F b) { return _mm_cmpge_ps(a, b); }
+        static M le(F a, F b) { return _mm_cmple_ps(a, b); }
+        static M ne(F a, F b) { return _mm_cmpneq_ps(a, b); }
+        static M both(M a, M b) { return _mm_and_ps(a, b); }
+        static M either(M a, M b) { return _mm_or_ps(a, b); }
+        static M invert(M a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+        static F select(M m, F a, F b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+        static S loadBits(const std::uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+        static void storeBits(std::uint32_t* p, S v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+        static M test(S bits, std::uint32_t bit) {
+            __m128i b = _mm_set1_epi32(static_cast<int>(bit));
+            return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(bits, b), b));
+        }
+        static S flag(M m, std::uint32_t bit) {
+            return _mm_and_si128(_mm_castps_si128(m), _mm_set1_epi32(static_cast<int>(bit)));
+        }
+        static S join(S a, S b) { return _mm_or_si128(a, b); }
+    };
+#endif
+
+    // Step loops [i, count) in groups of V::WIDTH; returns where it stopped
+    template <typename V>
+    std::size_t stepLanes(std::size_t i, std::size_t count, float dt) {
+        using F = typename V::F;
+        using M = typename V::M;
+        const F zero = V::set(0.0f);
+        const F step = V::set(dt);
+        const F invDt = V::set(1.0f / dt);
+        for (; i + V::WIDTH <= count; i += V::WIDTH) {
+            typename V::S mode = V::loadBits(&modes[i]);
+            M manual = V::test(mode, MANUAL);
+            M track = V::test(mode, TRACK);
+            M hold = V::test(mode, HOLD);
+            M direct = V::test(mode, DIRECT);
+            M automatic = V::invert(V::either(V::either(manual, track), hold));
+
+            F setpoint = V::load(&sp[i]);
+            F process = V::load(&pv[i]);
+            F e = V::select(direct, V::sub(process, setpoint), V::sub(setpoint, process));
+            F eBand = V::select(V::gt(V::abs(e), V::load(&deadBand[i])), e, zero);
+
+            F p = V::mul(V::load(&kp[i]), eBand);
+            F d = V::mul(V::mul(V::load(&kd[i]), V::sub(eBand, V::load(&lastError[i]))), invDt);
+            F integ = V::add(V::load(&integral[i]), V::mul(V::mul(V::load(&kpOverTi[i]), step), eBand));
+            F unlimited = V::add(V::add(p, integ), d);
+
+            F hi = V::load(&cvHi[i]);
+            F lo = V::load(&cvLo[i]);
+            F previous = V::load(&cv[i]);
+            F manualCv = V::load(&manualValue[i]);
+            F maxStep = V::mul(V::load(&roc[i]), step);
+            F target = V::select(manual, manualCv, unlimited);
+            F ramped = V::min(V::max(target, V::sub(previous, maxStep)), V::add(previous, maxStep));
+            F limited = V::min(V::max(ramped, lo), hi);
+            F tracked = V::min(V::max(V::load(&trackValue[i]), lo), hi);
+            F out = V::select(track, tracked, V::select(hold, previous, limited));
+
+            M windup = V::both(automatic, V::ne(limited, unlimited));
+            M backCalculate = V::either(windup, V::invert(automatic));
+            V::store(&integral[i], V::select(backCalculate, V::sub(V::sub(out, p), d), integ));
+            V::store(&lastError[i], eBand);
+            V::store(&cv[i], out);
+            V::store(&manualValue[i], V::select(manual, manualCv, out));
+            V::store(&error[i], e);
+            V::store(&pTerm[i], p);
+            V::store(&dTerm[i], d);
+            V::storeBits(&status[i], V::join(V::join(V::flag(V::ge(out, hi), HI_LIMIT), V::flag(V::le(out, lo), LO_LIMIT)),
+                                             V::join(V::flag(windup, WINDUP), V::flag(manual, IN_MANUAL))));
+        }
+        return i;
+    }
+
+    static bool check(PLCAddress address, PLCArea area, const char* field) {
+        if (address.valid() && address.area != area) {
+            std::cout << "[ERROR] PID " << field << " must be a " << (area == PLCArea::REAL ? "REAL" : "BOOL")
+                      << " slot\n";
+            return false;
+        }
+        return true;
+    }
+
+    static std::uint32_t slotOf(PLCAddress address) { return address.valid() ? address.index : NO_SLOT; }
+
+public:
+    // Add a loop in automatic mode with CV at its low limit; returns its index
+    std::size_t add(const PIDTuning& tuning = {}) {
+        std::size_t loop = cv.size();
+        for (auto* column : {&sp, &pv, &manualValue, &trackValue, &kp, &kd, &kpOverTi, &deadBand, &cvHi, &cvLo,
+                             &roc, &integral, &lastError, &cv, &error, &pTerm, &dTerm}) {
+            column->push_back(0.0f);
+        }
+        for (auto* column : {&modes, &status, &spSlot, &pvSlot, &cvSlot, &manualModeSlot, &manualValueSlot,
+                             &trackModeSlot, &trackValueSlot, &holdSlot}) {
+            column->push_back(column == &modes || column == &status ? 0 : NO_SLOT);
+        }
+        tune(loop, tuning);
+        cv[loop] = tuning.cvLoLimit;
+        manualValue[loop] = tuning.cvLoLimit;
+        integral[loop] = tuning.cvLoLimit;
+        return loop;
+    }
+
+    void reserve(std::size_t loops) {
+        for (auto* column : {&sp, &pv, &manualValue, &trackValue, &kp, &kd, &kpOverTi, &deadBand, &cvHi, &cvLo,
+                             &roc, &integral, &lastError, &cv, &error, &pTerm, &dTerm}) {
+            column->reserve(loops);
+        }
+        for (auto* column : {&modes, &status, &spSlot, &pvSlot, &cvSlot, &manualModeSlot, &manualValueSlot,
+                             &trackModeSlot, &trackValueSlot, &holdSlot}) {
+            column->reserve(loops);
+        }
+    }
+
+    // Change tuning; takes effect at the next scan without a bump in CV
+    void tune(std::size_t loop, const PIDTuning& tuning) {
+        kp[loop] = tuning.kp;
+        kd[loop] = tuning.kp * tuning.td;
+        kpOverTi[loop] = tuning.ti > 0.0f ? tuning.kp / tuning.ti : 0.0f;
+        deadBand[loop] = tuning.deadBand;
+        cvHi[loop] = tuning.cvHiLimit;
+        cvLo[loop] = tuning.cvLoLimit;
+        roc[loop] = tuning.cvRoC > 0.0f ? tuning.cvRoC : std::numeric_limits<float>::infinity();
+        modes[loop] = (modes[loop] & ~DIRECT) | (tuning.directAction ? DIRECT : 0);
+    }
+
+    // Connect a loop to process-image slots; returns false for a slot of the wrong type
+    bool bind(std::size_t loop, const PIDBinding& binding) {
+        if (!check(binding.sp, PLCArea::REAL, "SP") || !check(binding.pv, PLCArea::REAL, "PV") ||
+            !check(binding.cv, PLCArea::REAL, "CV") || !check(binding.manualValue, PLCArea::REAL, "manual value") ||
+            !check(binding.trackValue, PLCArea::REAL, "track value") ||
+            !check(binding.manualMode, PLCArea::BOOL, "manual mode") ||
+            !check(binding.trackMode, PLCArea::BOOL, "track mode") || !check(binding.hold, PLCArea::BOOL, "hold")) {
+            return false;
+        }
+        spSlot[loop] = slotOf(binding.sp);
+        pvSlot[loop] = slotOf(binding.pv);
+        cvSlot[loop] = slotOf(binding.cv);
+        manualModeSlot[loop] = slotOf(binding.manualMode);
+        manualValueSlot[loop] = slotOf(binding.manualValue);
+        trackModeSlot[loop] = slotOf(binding.trackMode);
+        trackValueSlot[loop] = slotOf(binding.trackValue);
+        holdSlot[loop] = slotOf(binding.hold);
+        return true;
+    }
+
+    // Slots scan() writes, for a scheduler's copy-out
+    std::vector<PLCAddress> writtenSlots() const {
+        std::vector<PLCAddress> slots;
+        for (std::size_t loop = 0; loop < cv.size(); loop++) {
+            for (std::uint32_t slot : {cvSlot[loop], manualValueSlot[loop]}) {
+                if (slot != NO_SLOT) {
+                    slots.push_back({PLCArea::REAL, slot});
+                }
+            }
+        }
+        return slots;
+    }
+
+    // Read the bound inputs from the image
+    void gather(const ProcessImage& image) {
+        for (std::size_t loop = 0; loop < cv.size(); loop++) {
+            if (spSlot[loop] != NO_SLOT) sp[loop] = image.reals[spSlot[loop]];
+            if (pvSlot[loop] != NO_SLOT) pv[loop] = image.reals[pvSlot[loop]];
+            if (manualValueSlot[loop] != NO_SLOT) manualValue[loop] = image.reals[manualValueSlot[loop]];
+            if (trackValueSlot[loop] != NO_SLOT) trackValue[loop] = image.reals[trackValueSlot[loop]];
+            std::uint32_t mode = modes[loop];
+            if (manualModeSlot[loop] != NO_SLOT) {
+                mode = (mode & ~MANUAL) | (image.booleans[manualModeSlot[loop]] ? MANUAL : 0);
+            }
+            if (trackModeSlot[loop] != NO_SLOT) {
+                mode = (mode & ~TRACK) | (image.booleans[trackModeSlot[loop]] ? TRACK : 0);
+            }
+            if (holdSlot[loop] != NO_SLOT) {
+                mode = (mode & ~HOLD) | (image.booleans[holdSlot[loop]] ? HOLD : 0);
+            }
+            modes[loop] = mode;
+        }
+    }
+
+    // Write CV (and the tracking manual value) to the bound slots
+    void scatter(ProcessImage& image) const {
+        for (std::size_t loop = 0; loop < cv.size(); loop++) {
+            if (cvSlot[loop] != NO_SLOT) image.reals[cvSlot[loop]] = cv[loop];
+            if (manualValueSlot[loop] != NO_SLOT) image.reals[manualValueSlot[loop]] = manualValue[loop];
+        }
+    }
+
+    // Advance every loop by dt seconds
+    void step(float dt) {
+        std::size_t i = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+        i = stepLanes<VectorLanes>(i, cv.size(), dt);
+#endif
+        stepLanes<ScalarLanes>(i, cv.size(), dt);
+    }
+
+    // The same step one loop at a time (reference for the vector path)
+    void stepScalar(float dt) { stepLanes<ScalarLanes>(0, cv.size(), dt); }
+
+    // One scan against the process image: gather, step, scatter
+    void scan(ProcessImage& image, float dt) {
+        gather(image);
+        step(dt);
+        scatter(image);
+    }
+
+    // Unbound inputs and mode control
+    void setSetpoint(std::size_t loop, float value) { sp[loop] = value; }
+    void setProcessValue(std::size_t loop, float value) { pv[loop] = value; }
+    void setManualValue(std::size_t loop, float value) { manualValue[loop] = value; }
+    void setTrackValue(std::size_t loop, float value) { trackValue[loop] = value; }
+    void setMode(std::size_t loop, std::uint32_t mode, bool on) {
+        modes[loop] = on ? (modes[loop] | mode) : (modes[loop] & ~mode);
+    }
+
+    // Outputs
+    float getCV(std::size_t loop) const { return cv[loop]; }
+    float getError(std::size_t loop) const { return error[loop]; }
+    float getPTerm(std::size_t loop) const { return pTerm[loop]; }
+    float getITerm(std::size_t loop) const { return integral[loop]; }
+    float getDTerm(std::size_t loop) const { return dTerm[loop]; }
+    std::uint32_t getStatus(std::size_t loop) const { return status[loop]; }
+    float getManualValue(std::size_t loop) const { return manualValue[loop]; }
+
+    std::size_t size() const { return cv.size(); }
+};
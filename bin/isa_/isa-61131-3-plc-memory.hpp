@@ -0,0 +1,166 @@
+/**
+ * ISA-61131-3 PLC Memory
+ * Simulated PLC I/O and variable storage. Values live in a flat
+ * ProcessImage; this class adds the name directory. Compiled programs
+ * resolve names once via find()/define() and then use image() directly;
+ * the by-name accessors remain as a slow-path compatibility layer.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "isa-61131-3-process-image.hpp"
+
+// Simulated PLC memory and I/O
+class PLCMemory {
+private:
+    static constexpr std::size_t AREA_COUNT = 5;
+
+    ProcessImage process;
+    std::array<std::unordered_map<std::string, std::uint32_t>, AREA_COUNT> directory;
+
+    const std::unordered_map<std::string, std::uint32_t>& names(PLCArea area) const {
+        return directory[static_cast<std::size_t>(area)];
+    }
+
+    PLCAddress lookup(PLCArea area, const std::string& name) const {
+        const auto& index = names(area);
+        auto it = index.find(name);
+        return (it != index.end()) ? PLCAddress{area, it->second} : PLCAddress{};
+    }
+
+    // Names of an area in sorted order, for display
+    std::vector<std::pair<std::string, std::uint32_t>> sorted(PLCArea area) const {
+        std::vector<std::pair<std::string, std::uint32_t>> entries(names(area).begin(), names(area).end());
+        std::sort(entries.begin(), entries.end());
+        return entries;
+    }
+
+public:
+    PLCMemory() {
+        // Initialize default I/O
+        setDigitalInput("I0.0", false);
+        setDigitalInput("I0.1", false);
+        setDigitalInput("I0.2", false);
+
+        setDigitalOutput("Q0.0", false);
+        setDigitalOutput("Q0.1", false);
+
+        // Initialize variables
+        setInteger("Counter", 0);
+        setReal("Temperature", 25.0f);
+        setBoolean("MotorRunning", false);
+    }
+
+    ProcessImage& image() { return process; }
+    const ProcessImage& image() const { return process; }
+
+    // Resolve a name: inputs, outputs, then INT, REAL and BOOL variables
+    PLCAddress find(const std::string& name) const {
+        for (PLCArea area : {PLCArea::INPUT, PLCArea::OUTPUT, PLCArea::INT, PLCArea::REAL, PLCArea::BOOL}) {
+            PLCAddress address = lookup(area, name);
+            if (address.valid()) {
+                return address;
+            }
+        }
+        return {};
+    }
+
+    // Pre-size an area's directory and storage before a bulk load
+    void reserve(PLCArea area, std::size_t count) {
+        directory[static_cast<std::size_t>(area)].reserve(count);
+        switch (area) {
+            case PLCArea::INT: process.integers.reserve(count); break;
+            case PLCArea::REAL: process.reals.reserve(count); break;
+            case PLCArea::BOOL: process.booleans.reserve(count); break;
+            default: break;
+        }
+    }
+
+    // Address of a name in an area, allocating a zeroed slot on first use
+    PLCAddress define(PLCArea area, const std::string& name) {
+        PLCAddress address = lookup(area, name);
+        if (!address.valid()) {
+            address = process.allocate(area);
+            directory[static_cast<std::size_t>(area)].emplace(name, address.index);
+        }
+        return address;
+    }
+
+    void setDigitalInput(const std::string& name, bool value) {
+        process.setInput(define(PLCArea::INPUT, name).index, value);
+    }
+
+    bool getDigitalInput(const std::string& name) const {
+        PLCAddress address = lookup(PLCArea::INPUT, name);
+        return address.valid() ? process.input(address.index) : false;
+    }
+
+    void setDigitalOutput(const std::string& name, bool value) {
+        process.setOutput(define(PLCArea::OUTPUT, name).index, value);
+    }
+
+    bool getDigitalOutput(const std::string& name) const {
+        PLCAddress address = lookup(PLCArea::OUTPUT, name);
+        return address.valid() ? process.output(address.index) : false;
+    }
+
+    void setInteger(const std::string& name, int value) {
+        process.integers[define(PLCArea::INT, name).index] = value;
+    }
+
+    int getInteger(const std::string& name) const {
+        PLCAddress address = lookup(PLCArea::INT, name);
+        return address.valid() ? process.integers[address.index] : 0;
+    }
+
+    void setReal(const std::string& name, float value) {
+        process.reals[define(PLCArea::REAL, name).index] = value;
+    }
+
+    float getReal(const std::string& name) const {
+        PLCAddress address = lookup(PLCArea::REAL, name);
+        return address.valid() ? process.reals[address.index] : 0.0f;
+    }
+
+    void setBoolean(const std::string& name, bool value) {
+        process.booleans[define(PLCArea::BOOL, name).index] = value;
+    }
+
+    bool getBoolean(const std::string& name) const {
+        PLCAddress address = lookup(PLCArea::BOOL, name);
+        return address.valid() ? process.booleans[address.index] != 0 : false;
+    }
+
+    void displayState() const {
+        std::cout << "PLC State:\n";
+        std::cout << "Digital Inputs:\n";
+        for (const auto& input : sorted(PLCArea::INPUT)) {
+            std::cout << "  " << input.first << ": " << (process.input(input.second) ? "ON" : "OFF") << "\n";
+        }
+
+        std::cout << "Digital Outputs:\n";
+        for (const auto& output : sorted(PLCArea::OUTPUT)) {
+            std::cout << "  " << output.first << ": " << (process.output(output.second) ? "ON" : "OFF") << "\n";
+        }
+
+        std::cout << "Variables:\n";
+        for (const auto& var : sorted(PLCArea::INT)) {
+            std::cout << "  INT " << var.first << ": " << process.integers[var.second] << "\n";
+        }
+        for (const auto& var : sorted(PLCArea::REAL)) {
+            std::cout << "  REAL " << var.first << ": " << process.reals[var.second] << "\n";
+        }
+        for (const auto& var : sorted(PLCArea::BOOL)) {
+            std::cout << "  BOOL " << var.first << ": " << (process.booleans[var.second] ? "TRUE" : "FALSE") << "\n";
+        }
+    }
+};
@@ -2,124 +2,100 @@
  * ISA-61131-3 Simulation - PLC Programming Languages
  * This program simulates a basic PLC execution environment supporting 
  * Structured Text (ST) language as defined in ISA-61131-3
+ *
+ * Build: g++ -std=c++17 -O2 isa-61131-3-plc-simulation.cpp -pthread -ldl
+ * Usage: isa-61131-3-plc-simulation                run the simulation
+ *        isa-61131-3-plc-simulation --tasks [seconds]
+ *                                                  run programs as cyclic 1/10/100 ms tasks
+ *        isa-61131-3-plc-simulation --virtual [hours] [forks]
+ *                                                  run the tasks free-running on plant time,
+ *                                                  then fork what-if runs from a snapshot
+ *        isa-61131-3-plc-simulation --bench [scans]
+ *                                                  run the performance benchmarks
+ *        isa-61131-3-plc-simulation --sweep [runs] [threads] [LM2500_ENCLOSURE_CONTROL.scl] [outdir]
+ *                                                  tune a PID (grid) and the LM2500 tables
+ *                                                  (random samples) in closed loop; result
+ *                                                  files are kept only when outdir is given
+ *        isa-61131-3-plc-simulation --fb file.scl [instances] [scans]
+ *                                                  run a FUNCTION_BLOCK over many instances,
+ *                                                  scalar and batched
+ *        isa-61131-3-plc-simulation --pid [loops] [hours]
+ *                                                  run closed temperature loops on the native
+ *                                                  PID engine, free-running on plant time
  */
 
 #include <iostream>
 #include <string>
 #include <vector>
-#include <map>
-#include <functional>
-#include <regex>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <sstream>
 
-// Simulated PLC memory and I/O
-class PLCMemory {
+#include "isa-61131-3-change-tracker.hpp"
+#include "isa-61131-3-fb-batch.hpp"
+#include "isa-61131-3-function-block.hpp"
+#include "isa-61131-3-pid-engine.hpp"
+#include "isa-61131-3-plc-memory.hpp"
+#include "isa-61131-3-st-parser.hpp"
+#include "isa-61131-3-st-vm.hpp"
+#include "isa-61131-3-st-compiler.hpp"
+#include "isa-61131-3-st-native.hpp"
+#include "isa-61131-3-scan-scheduler.hpp"
+#include "isa-61131-3-snapshot.hpp"
+#include "isa-61131-3-sweep.hpp"
+#include "isa-61131-3-timers.hpp"
+
+// Simplified ST interpreter for ISA-61131-3
+class STInterpreter {
 private:
-    std::map<std::string, bool> digitalInputs;
-    std::map<std::string, bool> digitalOutputs;
-    std::map<std::string, int> integers;
-    std::map<std::string, float> reals;
-    std::map<std::string, bool> booleans;
+    PLCMemory& memory;
+    STProgram compiled;
 
 public:
-    PLCMemory() {
-        // Initialize default I/O
-        digitalInputs["I0.0"] = false;
-        digitalInputs["I0.1"] = false;
-        digitalInputs["I0.2"] = false;
-        
-        digitalOutputs["Q0.0"] = false;
-        digitalOutputs["Q0.1"] = false;
-        
-        // Initialize variables
-        integers["Counter"] = 0;
-        reals["Temperature"] = 25.0f;
-        booleans["MotorRunning"] = false;
-    }
-    
-    void setDigitalInput(const std::string& name, bool value) {
-        digitalInputs[name] = value;
-    }
-    
-    bool getDigitalInput(const std::string& name) const {
-        auto it = digitalInputs.find(name);
-        return (it != digitalInputs.end()) ? it->second : false;
-    }
-    
-    void setDigitalOutput(const std::string& name, bool value) {
-        digitalOutputs[name] = value;
-    }
-    
-    bool getDigitalOutput(const std::string& name) const {
-        auto it = digitalOutputs.find(name);
-        return (it != digitalOutputs.end()) ? it->second : false;
-    }
-    
-    void setInteger(const std::string& name, int value) {
-        integers[name] = value;
-    }
-    
-    int getInteger(const std::string& name) const {
-        auto it = integers.find(name);
-        return (it != integers.end()) ? it->second : 0;
-    }
-    
-    void setReal(const std::string& name, float value) {
-        reals[name] = value;
-    }
+    STInterpreter(PLCMemory& mem) : memory(mem) {}
     
-    float getReal(const std::string& name) const {
-        auto it = reals.find(name);
-        return (it != reals.end()) ? it->second : 0.0f;
+    // Compile a Structured Text program once; runScan() then executes it
+    bool compile(const std::vector<std::string>& program) {
+        std::string source;
+        for (const auto& line : program) {
+            source += line;
+            source += '\n';
+        }
+        STCompiler compiler(memory, compiled);
+        if (!compiler.compile(source)) {
+            std::cout << "[ERROR] ST compile failed: " << compiler.error() << "\n";
+            return false;
+        }
+        return true;
     }
     
-    void setBoolean(const std::string& name, bool value) {
-        booleans[name] = value;
+    // Execute one scan of the compiled program directly on the process image
+    void runScan() {
+        if (compiled.code.empty()) {
+            return;
+        }
+        STVirtualMachine::run(compiled, memory.image());
     }
     
-    bool getBoolean(const std::string& name) const {
-        auto it = booleans.find(name);
-        return (it != booleans.end()) ? it->second : false;
-    }
+    const STProgram& program() const { return compiled; }
     
-    void displayState() const {
-        std::cout << "PLC State:\n";
-        std::cout << "Digital Inputs:\n";
-        for (const auto& input : digitalInputs) {
-            std::cout << "  " << input.first << ": " << (input.second ? "ON" : "OFF") << "\n";
-        }
-        
-        std::cout << "Digital Outputs:\n";
-        for (const auto& output : digitalOutputs) {
-            std::cout << "  " << output.first << ": " << (output.second ? "ON" : "OFF") << "\n";
-        }
-        
-        std::cout << "Variables:\n";
-        for (const auto& var : integers) {
-            std::cout << "  INT " << var.first << ": " << var.second << "\n";
-        }
-        for (const auto& var : reals) {
-            std::cout << "  REAL " << var.first << ": " << var.second << "\n";
+    // Execute a Structured Text program (simplified line-by-line interpretation)
+    void executeSTProgram(const std::vector<std::string>& program, bool echo = true) {
+        if (echo) {
+            std::cout << "Executing Structured Text Program:\n";
         }
-        for (const auto& var : booleans) {
-            std::cout << "  BOOL " << var.first << ": " << (var.second ? "TRUE" : "FALSE") << "\n";
-        }
-    }
-};
-
-// Simplified ST interpreter for ISA-61131-3
-class STInterpreter {
-private:
-    PLCMemory& memory;
-
-public:
-    STInterpreter(PLCMemory& mem) : memory(mem) {}
-    
-    // Execute a Structured Text program (simplified interpretation)
-    void executeSTProgram(const std::vector<std::string>& program) {
-        std::cout << "Executing Structured Text Program:\n";
         
         for (const auto& line : program) {
-            std::cout << "  " << line << "\n";
+            if (echo) {
+                std::cout << "  " << line << "\n";
+            }
             
             // Very simplified interpreter - just handle basic assignment and IF statements
             if (line.find("IF") != std::string::npos) {
@@ -130,7 +106,9 @@ public:
             }
         }
         
-        std::cout << "Program execution completed\n\n";
+        if (echo) {
+            std::cout << "Program execution completed\n\n";
+        }
     }
     
 private:
@@ -155,16 +133,18 @@ private:
                 memory.setBoolean(varName, valueStr == "TRUE");
             }
             else if (valueStr.find('.') != std::string::npos) {
-                memory.setReal(varName, std::stof(valueStr));
+                memory.setReal(varName, std::strtof(valueStr.c_str(), nullptr));
             }
             else {
-                try {
-                    memory.setInteger(varName, std::stoi(valueStr));
-                } catch (...) {
-                    // Handle variable references or expressions (simplified)
-                    if (valueStr.substr(0, 1) == "I") {
-                        memory.setBoolean(varName, memory.getDigitalInput(valueStr));
-                    }
+                // Parsed without exceptions: anything that is not an integer
+                // literal is treated as a (simplified) variable reference
+                char* end = nullptr;
+                long value = std::strtol(valueStr.c_str(), &end, 10);
+                if (!valueStr.empty() && *end == '\0') {
+                    memory.setInteger(varName, static_cast<int>(value));
+                }
+                else if (valueStr.substr(0, 1) == "I") {
+                    memory.setBoolean(varName, memory.getDigitalInput(valueStr));
                 }
             }
         }
@@ -183,8 +163,949 @@ private:
     }
 };
 
+// Demonstration program: motor control in Structured Text
+std::vector<std::string> motorControlProgram() {
+    return {
+        "// Motor control program in Structured Text",
+        "MotorRunning := FALSE;",
+        "IF I0.0 THEN",
+        "    Q0.0 := TRUE;    // Start motor if input I0.0 is active",
+        "    MotorRunning := TRUE;",
+        "ELSE",
+        "    Q0.0 := FALSE;   // Stop motor",
+        "    MotorRunning := FALSE;",
+        "END_IF;",
+        "",
+        "Counter := Counter + 1;  // Increment cycle counter",
+        "Temperature := 25.5;     // Set temperature reference"
+    };
+}
+
+// Benchmark: line-by-line text interpretation vs compiled bytecode scans
+void benchmarkScan(int scans) {
+    std::vector<std::string> program = motorControlProgram();
+
+    PLCMemory textMemory;
+    textMemory.setDigitalInput("I0.0", true);
+    STInterpreter textInterpreter(textMemory);
+    auto start = std::chrono::steady_clock::now();
+    for (int scan = 0; scan < scans; scan++) {
+        textInterpreter.executeSTProgram(program, false);
+    }
+    double textNs = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / scans;
+
+    PLCMemory vmMemory;
+    vmMemory.setDigitalInput("I0.0", true);
+    STInterpreter vm(vmMemory);
+    start = std::chrono::steady_clock::now();
+    vm.compile(program);
+    double compileUs = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int scan = 0; scan < scans; scan++) {
+        vm.runScan();
+    }
+    double vmNs = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / scans;
+
+    std::cout << "ST scan, motor control program, " << scans << " scans:\n";
+    std::cout << "  Text interpreter: " << textNs << " ns/scan\n";
+    std::cout << "  Bytecode VM:      " << vmNs << " ns/scan (" << vm.program().code.size()
+              << " instructions, compiled once in " << compileUs << " us), speedup "
+              << textNs / vmNs << "x\n";
+    std::cout << "  Counter after run: " << vmMemory.getInteger("Counter") << "\n\n";
+}
+
+// Benchmark: a program with a loop, built-ins and constant subexpressions
+void benchmarkExpressions(int scans) {
+    PLCMemory memory;
+    memory.setReal("Dx", 3.0f);
+    memory.setReal("Dy", 4.0f);
+    STInterpreter vm(memory);
+    if (!vm.compile({
+            "Sum := 0;",
+            "FOR i := 1 TO 100 DO",
+            "    Sum := Sum + i * (2 * 3 - 4);       // folds to i * 2",
+            "END_FOR;",
+            "Distance := SQRT(EXPT(Dx, 2.0) + Dy ** 2);",
+            "Scale := EXPT(10.0, 3) / (4 * 250);     // folds to 1.0"
+        })) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int scan = 0; scan < scans; scan++) {
+        vm.runScan();
+    }
+    double vmNs = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / scans;
+
+    std::cout << "ST scan, FOR loop (100 iterations) + SQRT/EXPT, " << scans << " scans:\n";
+    std::cout << "  Bytecode VM: " << vmNs << " ns/scan (" << vm.program().code.size() << " instructions)\n";
+
+    // The same program as native code, on a copy of the image
+    STNativeCompiler nativeCompiler;
+    STNativeProgram native;
+    auto build = std::chrono::steady_clock::now();
+    if (nativeCompiler.compile(vm.program(), native)) {
+        double buildMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - build).count();
+        ProcessImage image = memory.image();
+        start = std::chrono::steady_clock::now();
+        for (int scan = 0; scan < scans; scan++) {
+            native.run(image);
+        }
+        double nativeNs = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count() / scans;
+        bool identical = image.integers == memory.image().integers && image.outputs == memory.image().outputs &&
+                         std::memcmp(image.reals.data(), memory.image().reals.data(),
+                                     image.reals.size() * sizeof(float)) == 0;
+        std::cout << "  Native code: " << nativeNs << " ns/scan (" << vmNs / nativeNs << "x, "
+                  << (native.fromCache() ? "cached" : "built") << " in " << buildMs << " ms), results "
+                  << (identical ? "bit-identical" : "DIFFER") << "\n";
+    } else {
+        std::cout << "  Native code: unavailable (" << nativeCompiler.error() << ")\n";
+    }
+    std::cout << "  Sum = " << memory.getInteger("Sum") << ", Distance = " << memory.getReal("Distance")
+              << ", Scale = " << memory.getReal("Scale") << "\n\n";
+}
+
+// Benchmark: by-name access (compatibility path) vs addresses resolved once
+void benchmarkProcessImage(int variables, int passes) {
+    PLCMemory memory;
+    std::vector<std::string> inputNames;
+    std::vector<std::string> integerNames;
+    std::vector<PLCAddress> inputs;
+    std::vector<PLCAddress> integers;
+    for (int i = 0; i < variables; i++) {
+        inputNames.push_back("I" + std::to_string(i / 8) + "." + std::to_string(i % 8));
+        integerNames.push_back("Count" + std::to_string(i));
+        memory.setDigitalInput(inputNames.back(), i % 3 == 0);
+        memory.setInteger(integerNames.back(), 0);
+        inputs.push_back(memory.find(inputNames.back()));
+        integers.push_back(memory.find(integerNames.back()));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        for (int i = 0; i < variables; i++) {
+            if (memory.getDigitalInput(inputNames[i])) {
+                memory.setInteger(integerNames[i], memory.getInteger(integerNames[i]) + 1);
+            }
+        }
+    }
+    double byNameNs = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / (double(passes) * variables);
+
+    ProcessImage& image = memory.image();
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        for (int i = 0; i < variables; i++) {
+            if (image.input(inputs[i].index)) {
+                image.integers[integers[i].index]++;
+            }
+        }
+    }
+    double bySlotNs = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / (double(passes) * variables);
+
+    std::cout << "Process image, " << variables << " inputs + " << variables << " INT variables:\n";
+    std::cout << "  By name: " << byNameNs << " ns/variable, by resolved slot: " << bySlotNs
+              << " ns/variable (checksum " << memory.getInteger(integerNames[0]) << ")\n\n";
+}
+
+// Benchmark: per-scan change detection over a large image where about 1%
+// of the points change per scan, against shipping the full image
+void benchmarkChanges(int variables, int scans) {
+    ProcessImage image;
+    for (int i = 0; i < variables; i++) {
+        image.allocate(PLCArea::INPUT);
+        image.allocate(PLCArea::OUTPUT);
+        image.allocate(PLCArea::INT);
+        image.allocate(PLCArea::REAL);
+        image.allocate(PLCArea::BOOL);
+    }
+    std::size_t points = std::size_t(variables) * 5;
+    std::size_t perScan = points / 100;
+
+    ChangeTracker tracker;
+    std::uint64_t changes = 0;
+    std::uint64_t deltaBytes = 0;
+    tracker.subscribe([&](const DeltaBatch& batch) {
+        changes += batch.changes.size();
+        deltaBytes += batch.bytes();
+    });
+    std::size_t fullBytes = tracker.snapshot(image, 0).bytes();
+    tracker.collect(image, 0);
+
+    std::mt19937 random(42);
+    double diffNs = 0.0;
+    for (int scan = 0; scan < scans; scan++) {
+        for (std::size_t k = 0; k < perScan; k++) {
+            std::uint32_t index = static_cast<std::uint32_t>(random() % variables);
+            switch (random() % 5) {
+                case 0: image.setInput(index, !image.input(index)); break;
+                case 1: image.setOutput(index, !image.output(index)); break;
+                case 2: image.integers[index]++; break;
+                case 3: image.reals[index] += 0.5f; break;
+                default: image.booleans[index] ^= 1; break;
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        tracker.publish(image, scan);
+        diffNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int scan = 0; scan < scans; scan++) {
+        tracker.snapshot(image, scan);
+    }
+    double fullNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Change publishing, " << points << " points, ~" << perScan << " writes/scan:\n";
+    std::cout << "  Delta: " << diffNs / scans / 1000.0 << " us/scan, " << double(changes) / scans
+              << " points, " << deltaBytes / scans << " bytes/scan\n";
+    std::cout << "  Full image: " << fullNs / scans / 1000.0 << " us/scan, " << fullBytes << " bytes/scan\n\n";
+}
+
+// Run the motor program with two slower programs as cyclic tasks
+int runTasks(double seconds) {
+    PLCMemory plcMemory;
+    plcMemory.setDigitalInput("I0.0", true);
+    plcMemory.setReal("RunSeconds", 0.0f);
+    plcMemory.setReal("FilteredTemp", 0.0f);
+    plcMemory.setInteger("MotorTicks", 0);
+
+    STInterpreter motor(plcMemory);
+    STInterpreter temperature(plcMemory);
+    STInterpreter statistics(plcMemory);
+    bool compiled = motor.compile(motorControlProgram()) &&
+        temperature.compile({
+            "// First-order filter of the temperature reference, warm output",
+            "FilteredTemp := FilteredTemp * 0.9 + Temperature * 0.1;",
+            "IF FilteredTemp > 20.0 THEN",
+            "    Q0.1 := TRUE;",
+            "ELSE",
+            "    Q0.1 := FALSE;",
+            "END_IF;"
+        }) &&
+        statistics.compile({
+            "RunSeconds := RunSeconds + 0.1;",
+            "IF MotorRunning THEN MotorTicks := MotorTicks + 1; END_IF;"
+        });
+    if (!compiled) {
+        return 1;
+    }
+
+    ScanScheduler scheduler(plcMemory);
+    auto fast = scheduler.addTask("FAST", std::chrono::milliseconds(1), 0);
+    auto medium = scheduler.addTask("MEDIUM", std::chrono::milliseconds(10), 1);
+    auto slow = scheduler.addTask("SLOW", std::chrono::milliseconds(100), 2);
+    scheduler.addProgram(fast, motor.program());
+    scheduler.addProgram(medium, temperature.program());
+    scheduler.addProgram(slow, statistics.program());
+
+    // Stand-in for an HMI subscriber: count what it would receive
+    ChangeTracker tracker;
+    std::uint64_t deltaBatches = 0;
+    std::uint64_t deltaChanges = 0;
+    std::uint64_t deltaBytes = 0;
+    tracker.subscribe([&](const DeltaBatch& batch) {
+        deltaBatches++;
+        deltaChanges += batch.changes.size();
+        deltaBytes += batch.bytes();
+    });
+    std::size_t fullBytes = tracker.snapshot(plcMemory.image()).bytes();
+    scheduler.setChangeTracker(&tracker);
+
+    std::cout << "Running 3 cyclic tasks for " << seconds << " s...\n";
+    scheduler.run(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(seconds)));
+    scheduler.printReport();
+    std::cout << "Change publishing: " << deltaBatches << " batches over " << tracker.scans()
+              << " scans, " << deltaChanges << " points, " << deltaBytes << " bytes (full image every scan: "
+              << fullBytes * tracker.scans() << " bytes)\n\n";
+    plcMemory.displayState();
+    return 0;
+}
+
+// Run the task set on a virtual clock as fast as possible, checkpoint it,
+// then continue from the checkpoint in parallel what-if runs
+int runVirtual(double hours, int forks) {
+    PLCMemory plcMemory;
+    plcMemory.setDigitalInput("I0.0", true);
+    plcMemory.setReal("RunSeconds", 0.0f);
+    plcMemory.setReal("FilteredTemp", 0.0f);
+    plcMemory.setInteger("MotorTicks", 0);
+    plcMemory.setBoolean("MotorProven", false);
+    plcMemory.setInteger("ProvenMs", 0);
+    plcMemory.setBoolean("FanRunOn", false);
+
+    STInterpreter motor(plcMemory);
+    STInterpreter statistics(plcMemory);
+    bool compiled = motor.compile(motorControlProgram()) &&
+        statistics.compile({
+            "RunSeconds := RunSeconds + 0.1;",
+            "IF MotorRunning THEN MotorTicks := MotorTicks + 1; END_IF;"
+        });
+    if (!compiled) {
+        return 1;
+    }
+
+    // Motor proven 5 s after start; cooling fan runs on 60 s after stop
+    TimerBank timers;
+    timers.add(TimerKind::TON, plcMemory.find("I0.0"), plcMemory.find("MotorProven"),
+               5 * NS_PER_SECOND, plcMemory.find("ProvenMs"));
+    timers.add(TimerKind::TOF, plcMemory.find("Q0.0"), plcMemory.find("FanRunOn"), 60 * NS_PER_SECOND);
+
+    // Configured but not yet run: the template every fork starts from
+    const PLCMemory configuredMemory = plcMemory;
+    const TimerBank configuredTimers = timers;
+
+    VirtualClock clock(0);
+    auto schedule = [&](PLCMemory& memory, TimerBank& bank) {
+        ScanScheduler scheduler(memory);
+        auto fast = scheduler.addTask("FAST", std::chrono::milliseconds(1), 0);
+        auto slow = scheduler.addTask("SLOW", std::chrono::milliseconds(100), 1);
+        scheduler.addProgram(fast, motor.program());
+        scheduler.addTimers(fast, bank);
+        scheduler.addProgram(slow, statistics.program());
+        return scheduler;
+    };
+    auto plantTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double, std::ratio<3600>>(hours));
+
+    ScanScheduler scheduler = schedule(plcMemory, timers);
+    auto start = std::chrono::steady_clock::now();
+    scheduler.runFreeRunning(clock, plantTime);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Free-running: " << hours << " h of plant time in " << seconds << " s ("
+              << static_cast<double>(plantTime.count()) / 1e9 / seconds << "x real time), "
+              << scheduler.scanCount(0) + scheduler.scanCount(1) << " scans\n";
+
+    SnapshotLayout layout;
+    layout.add(plcMemory);
+    layout.add(timers);
+    layout.add(clock);
+    PLCSnapshot checkpoint;
+    layout.capture(checkpoint);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; i++) {
+        layout.capture(checkpoint);
+    }
+    double captureUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / 1000;
+    std::cout << "Checkpoint at " << clock.now() / NS_PER_SECOND << " s: " << checkpoint.size() << " bytes, "
+              << captureUs << " us to capture\n";
+
+    // What-if runs over the same plant time again: fork k keeps the motor
+    // stopped for the first k/forks of it
+    struct Fork {
+        PLCMemory memory;
+        TimerBank timers;
+        VirtualClock clock;
+        bool restored = false;
+    };
+    std::vector<Fork> runs(static_cast<std::size_t>(forks), Fork{configuredMemory, configuredTimers, VirtualClock(0)});
+    std::vector<std::thread> threads;
+    for (int k = 0; k < forks; k++) {
+        threads.emplace_back([&, k] {
+            Fork& run = runs[static_cast<std::size_t>(k)];
+            SnapshotLayout forkLayout;
+            forkLayout.add(run.memory);
+            forkLayout.add(run.timers);
+            forkLayout.add(run.clock);
+            run.restored = forkLayout.restore(checkpoint);
+            ScanScheduler forkScheduler = schedule(run.memory, run.timers);
+            auto stopped = plantTime * k / forks;
+            run.memory.setDigitalInput("I0.0", false);
+            forkScheduler.runFreeRunning(run.clock, stopped);
+            run.memory.setDigitalInput("I0.0", true);
+            forkScheduler.runFreeRunning(run.clock, plantTime - stopped);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (int k = 0; k < forks; k++) {
+        const Fork& run = runs[static_cast<std::size_t>(k)];
+        std::cout << "  Fork " << k << " (motor stopped " << k << "/" << forks << "): "
+                  << (run.restored ? "" : "[restore failed] ") << "t=" << run.clock.now() / NS_PER_SECOND
+                  << " s, MotorTicks=" << run.memory.getInteger("MotorTicks")
+                  << ", RunSeconds=" << run.memory.getReal("RunSeconds")
+                  << ", MotorProven=" << (run.memory.getBoolean("MotorProven") ? "TRUE" : "FALSE")
+                  << ", ProvenMs=" << run.memory.getInteger("ProvenMs") << "\n";
+    }
+    return 0;
+}
+
+// PID function block after documentation/function_blocks/fb_pid.md, with
+// conditional integration as anti-windup and bumpless manual transfer
+std::string pidControllerBlock() {
+    return R"(
+FUNCTION_BLOCK FB_PID_Controller
+VAR_INPUT
+    i_rSP          : REAL;          // Setpoint
+    i_rPV          : REAL;          // Process Variable
+    i_rManValue    : REAL;          // Manual Value
+    i_bManMode     : BOOL;          // Manual Mode
+    i_rKp          : REAL := 1.0;   // Proportional Gain
+    i_rTi          : REAL := 60.0;  // Integral Time (s), 0 = off
+    i_rTd          : REAL := 0.0;   // Derivative Time (s)
+    i_rCVHiLimit   : REAL := 100.0; // Output High Limit
+    i_rCVLoLimit   : REAL := 0.0;   // Output Low Limit
+    i_rCycleTime   : REAL := 0.1;   // Call interval (s)
+END_VAR
+VAR_OUTPUT
+    o_rCV          : REAL;          // Control Value
+    o_rError       : REAL;          // Control Error
+    o_bHiLimit     : BOOL;          // At High Limit
+    o_bLoLimit     : BOOL;          // At Low Limit
+END_VAR
+VAR
+    rIntegral      : REAL;          // Integral Term (error units)
+    rLastError     : REAL;          // Previous Error
+END_VAR
+VAR_TEMP
+    rOutput        : REAL;
+END_VAR
+BEGIN
+    o_rError := i_rSP - i_rPV;
+    IF i_bManMode THEN
+        o_rCV := i_rManValue;
+        rIntegral := i_rManValue / i_rKp - o_rError;    // bumpless return to auto
+    ELSE
+        rOutput := i_rKp * (o_rError + rIntegral + i_rTd * (o_rError - rLastError) / i_rCycleTime);
+        // Integrate only while the output is not driven further into a limit
+        IF i_rTi > 0.0 AND NOT ((rOutput >= i_rCVHiLimit AND o_rError > 0.0) OR
+                                (rOutput <= i_rCVLoLimit AND o_rError < 0.0)) THEN
+            rIntegral := rIntegral + o_rError * i_rCycleTime / i_rTi;
+        END_IF;
+        o_rCV := MIN(MAX(rOutput, i_rCVLoLimit), i_rCVHiLimit);
+    END_IF;
+    o_bHiLimit := o_rCV >= i_rCVHiLimit;
+    o_bLoLimit := o_rCV <= i_rCVLoLimit;
+    rLastError := o_rError;
+END_FUNCTION_BLOCK
+)";
+}
+
+// Print a sweep's throughput and its best runs (lowest IAE) from the results file
+void reportSweep(const std::string& path, const SweepRunner::Summary& summary, bool kept) {
+    SweepResults results;
+    if (!results.read(path)) {
+        std::cout << "[ERROR] cannot read sweep results " << path << "\n";
+        return;
+    }
+    std::uint64_t alarms = 0;
+    for (const SweepRecord& record : results.records) {
+        alarms += record.alarms;
+    }
+    std::cout << "  " << summary.runs << " runs on " << summary.threads << " threads in " << summary.seconds
+              << " s (" << static_cast<double>(summary.scans) / summary.seconds / 1e6 << " M FB calls/s), "
+              << alarms << " alarms";
+    if (kept) {
+        std::cout << ", results in " << path;
+    }
+    std::cout << "\n";
+
+    std::vector<std::size_t> order(results.records.size());
+    for (std::size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::size_t best = std::min<std::size_t>(3, order.size());
+    std::partial_sort(order.begin(), order.begin() + best, order.end(), [&](std::size_t a, std::size_t b) {
+        return results.records[a].iae < results.records[b].iae;
+    });
+    for (std::size_t i = 0; i < best; i++) {
+        const SweepRecord& record = results.records[order[i]];
+        std::cout << "  #" << i + 1 << " run " << record.run << ":";
+        for (std::size_t p = 0; p < results.labels.size(); p++) {
+            std::cout << " " << results.labels[p] << "=" << results.values[order[i] * results.labels.size() + p];
+        }
+        std::cout << " | IAE " << record.iae << ", overshoot " << record.overshoot << " %, settling "
+                  << record.settlingTime << " s, alarms " << record.alarms << "\n";
+    }
+}
+
+// Closed-loop tuning sweeps: a PID grid on a heat-exchanger-like plant and
+// random LM2500 fan/damper tables on an enclosure temperature model, with
+// the result files written to directory
+int runSweepIn(const std::string& directory, bool kept, std::uint64_t runs, unsigned threads,
+               const std::string& enclosurePath) {
+    PLCMemory plcMemory;
+    STFunctionBlock pid;
+    STCompiler compiler(plcMemory, pid.program);
+    if (!compiler.compileFunctionBlock(pidControllerBlock(), pid)) {
+        std::cout << "[ERROR] ST compile failed: " << compiler.error() << "\n";
+        return 1;
+    }
+
+    // Temperature loop: 0.8 degC per % valve, tau 40 s, 5 s dead time; step 20 -> 60 degC
+    SweepLoop loop;
+    loop.pv = pid.slot("i_rPV");
+    loop.cv = pid.slot("o_rCV");
+    loop.sp = pid.slot("i_rSP");
+    loop.gain = 0.8f;
+    loop.bias = 20.0f;
+    loop.timeConstant = 40.0f;
+    loop.deadTime = 5.0f;
+    loop.initialPv = 20.0f;
+    loop.setpoint = 60.0f;
+    loop.alarmLimit = 66.0f;
+    loop.step = 0.1f;
+    loop.steps = 6000;
+
+    // Grid as close to `runs` as a Kp x Ti x Td cube allows
+    std::uint32_t side = std::max<std::uint32_t>(2, static_cast<std::uint32_t>(std::cbrt(static_cast<double>(runs))));
+    SweepRunner pidSweep(pid, loop, plcMemory.image());
+    pidSweep.addParameter("Kp", pid.slot("i_rKp"), 0.5f, 6.0f, side);
+    pidSweep.addParameter("Ti", pid.slot("i_rTi"), 5.0f, 80.0f, side);
+    pidSweep.addParameter("Td", pid.slot("i_rTd"), 0.0f, 4.0f, side);
+    SweepRunner::Summary summary;
+    std::cout << "PID sweep, " << pidSweep.gridSize() << "-point grid over Kp, Ti, Td (600 s step response):\n";
+    std::string pidPath = directory + "/sweep-pid.bin";
+    if (!pidSweep.runGrid(pidPath, threads, summary)) {
+        std::cout << "[ERROR] PID sweep failed\n";
+        return 1;
+    }
+    reportSweep(pidPath, summary, kept);
+
+    if (enclosurePath.empty()) {
+        return 0;
+    }
+    std::ifstream file(enclosurePath);
+    std::stringstream source;
+    source << file.rdbuf();
+    STFunctionBlock enclosure;
+    STCompiler enclosureCompiler(plcMemory, enclosure.program);
+    if (!file || !enclosureCompiler.compileFunctionBlock(source.str(), enclosure)) {
+        std::cout << "[ERROR] cannot load " << enclosurePath << ": " << enclosureCompiler.error() << "\n";
+        return 1;
+    }
+
+    // Enclosure at 75 % load: 95 degC uncooled, -0.04 degC per fan RPM, tau 120 s
+    SweepLoop enclosureLoop;
+    enclosureLoop.pv = enclosure.slot("r_EnclosureTemp");
+    enclosureLoop.cv = enclosure.slot("r_FanSpeedSetpoint");
+    enclosureLoop.alarm = enclosure.slot("b_AlarmCondition");
+    enclosureLoop.gain = -0.04f;
+    enclosureLoop.bias = 95.0f;
+    enclosureLoop.timeConstant = 120.0f;
+    enclosureLoop.deadTime = 2.0f;
+    enclosureLoop.initialPv = 30.0f;
+    enclosureLoop.initialCv = 1100.0f;
+    enclosureLoop.setpoint = 38.0f;
+    enclosureLoop.step = 0.5f;
+    enclosureLoop.steps = 2400;
+
+    SweepRunner tableSweep(enclosure, enclosureLoop, plcMemory.image());
+    tableSweep.addParameter("load", enclosure.slot("r_TurbineLoad"), 75.0f, 75.0f);
+    tableSweep.addParameter("ambient", enclosure.slot("r_AmbientTemp"), 25.0f, 25.0f);
+    tableSweep.addParameter("exhaust", enclosure.slot("r_ExhaustTemp"), 550.0f, 550.0f);
+    for (std::int32_t i = 0; i < 4; i++) {
+        tableSweep.addParameter("a_rFanSpeed[" + std::to_string(i) + "]",
+                                enclosure.slot("a_rFanSpeed", i), 900.0f, 2000.0f);
+    }
+    std::cout << "LM2500 sweep, " << runs << " random fan speed tables (20 min from 30 degC):\n";
+    std::string tablePath = directory + "/sweep-lm2500.bin";
+    if (!tableSweep.runRandom(tablePath, runs, 61131, threads, summary)) {
+        std::cout << "[ERROR] LM2500 sweep failed\n";
+        return 1;
+    }
+    reportSweep(tablePath, summary, kept);
+    return 0;
+}
+
+// Run the sweeps into outputDirectory, or into a private temp directory that
+// is removed afterwards when none is given
+int runSweep(std::uint64_t runs, unsigned threads, const std::string& enclosurePath,
+             const std::string& outputDirectory) {
+    std::error_code error;
+    if (!outputDirectory.empty()) {
+        std::filesystem::create_directories(outputDirectory, error);
+        if (!std::filesystem::is_directory(outputDirectory, error)) {
+            std::cout << "[ERROR] cannot create sweep output directory " << outputDirectory << "\n";
+            return 1;
+        }
+        return runSweepIn(outputDirectory, true, runs, threads, enclosurePath);
+    }
+    std::filesystem::path temp = std::filesystem::temp_directory_path(error);
+    std::string pattern = ((error ? std::filesystem::path("/tmp") : temp) / "isa-sweep-XXXXXX").string();
+    if (::mkdtemp(pattern.data()) == nullptr) {
+        std::cout << "[ERROR] cannot create a temporary sweep directory\n";
+        return 1;
+    }
+    int result = runSweepIn(pattern, false, runs, threads, enclosurePath);
+    std::filesystem::remove_all(pattern, error);
+    return result;
+}
+
+// Load a FUNCTION_BLOCK (e.g. bin/fb_/MUAX_ML_CONTROL.scl), create many
+// instances with varied inputs and scan them all from the packed array
+int runFunctionBlock(const std::string& path, int instances, int scans) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "[ERROR] cannot open " << path << "\n";
+        return 1;
+    }
+    std::stringstream source;
+    source << file.rdbuf();
+
+    PLCMemory plcMemory;
+    STFunctionBlock block;
+    STCompiler compiler(plcMemory, block.program);
+    if (!compiler.compileFunctionBlock(source.str(), block)) {
+        std::cout << "[ERROR] ST compile failed: " << path << ": " << compiler.error() << "\n";
+        return 1;
+    }
+    std::cout << "Function block " << block.name << ": " << block.variables.size() << " variables, "
+              << block.frameSize() << "-cell frame, " << block.program.code.size() << " instructions\n";
+
+    // Inputs vary per instance: REAL/INT in [0, 100), BOOL set 1% of the time
+    FBInstanceArray site(block);
+    site.add(static_cast<std::size_t>(instances));
+    std::mt19937 random(61131);
+    std::uniform_real_distribution<float> analog(0.0f, 100.0f);
+    for (std::size_t i = 0; i < site.size(); i++) {
+        for (const STVariable& var : block.variables) {
+            if (var.section != VarSection::INPUT || var.array) {
+                continue;
+            }
+            float value = analog(random);
+            switch (var.type) {
+                case STType::REAL: site.setReal(i, static_cast<std::int32_t>(var.offset), value); break;
+                case STType::INT: site.setInteger(i, static_cast<std::int32_t>(var.offset), static_cast<int>(value)); break;
+                case STType::BOOL: site.setBoolean(i, static_cast<std::int32_t>(var.offset), value < 1.0f); break;
+            }
+        }
+    }
+
+    // The same instances in SoA groups, compiled as written and with
+    // squared distance comparisons
+    STFunctionBlock squaredBlock;
+    STCompiler squaredCompiler(plcMemory, squaredBlock.program);
+    squaredCompiler.setSquareDistances(true);
+    squaredCompiler.compileFunctionBlock(source.str(), squaredBlock);
+    FBBatch batch(block);
+    FBBatch squared(squaredBlock);
+    FBInstanceArray nativeSite(block);
+    batch.add(site.size());
+    squared.add(site.size());
+    nativeSite.add(site.size());
+    for (std::size_t i = 0; i < site.size(); i++) {
+        for (const STVariable& var : block.variables) {
+            for (std::uint32_t c = 0; var.section == VarSection::INPUT && c < var.length; c++) {
+                std::int32_t slot = static_cast<std::int32_t>(var.offset + c);
+                batch.setInteger(i, slot, site.getInteger(i, slot));
+                squared.setInteger(i, slot, site.getInteger(i, slot));
+                nativeSite.setInteger(i, slot, site.getInteger(i, slot));
+            }
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int scan = 0; scan < scans; scan++) {
+        site.scan(plcMemory.image());
+    }
+    double scanUs = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count() / scans;
+    std::cout << "  " << site.size() << " instances x " << scans << " scans: " << scanUs << " us/scan, "
+              << scanUs * 1000.0 / static_cast<double>(site.size()) << " ns/instance\n";
+
+    auto runBatch = [&](const char* label, FBBatch& instances) {
+        auto begin = std::chrono::steady_clock::now();
+        for (int scan = 0; scan < scans; scan++) {
+            instances.scan(plcMemory.image());
+        }
+        double us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - begin).count() / scans;
+        // Instance state (every non-temporary cell) against the scalar run
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < site.size(); i++) {
+            for (const STVariable& var : block.variables) {
+                for (std::uint32_t c = 0; var.section != VarSection::TEMP && c < var.length; c++) {
+                    std::int32_t slot = static_cast<std::int32_t>(var.offset + c);
+                    mismatches += instances.getInteger(i, slot) != site.getInteger(i, slot);
+                }
+            }
+        }
+        std::cout << "  " << label << " (" << instances.functionBlock().program.code.size() << " instructions): "
+                  << us << " us/scan, " << us * 1000.0 / static_cast<double>(site.size()) << " ns/instance, "
+                  << scanUs / us << "x scalar, " << mismatches << " cells differ\n";
+    };
+    runBatch("Batch", batch);
+    runBatch("Batch, squared distances", squared);
+
+    // Native code over the same instances
+    STNativeCompiler nativeCompiler;
+    STNativeProgram native;
+    if (!nativeCompiler.compile(block.program, native)) {
+        std::cout << "  Native: unavailable (" << nativeCompiler.error() << ")\n";
+    } else {
+        std::size_t frameSize = block.frameSize();
+        auto begin = std::chrono::steady_clock::now();
+        for (int scan = 0; scan < scans; scan++) {
+            STCell* frame = nativeSite.frame(0);
+            for (std::size_t i = 0; i < nativeSite.size(); i++, frame += frameSize) {
+                native.run(plcMemory.image(), frame);
+            }
+        }
+        double us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - begin).count() / scans;
+        bool identical = std::memcmp(nativeSite.frame(0), site.frame(0),
+                                     site.size() * frameSize * sizeof(STCell)) == 0;
+        std::cout << "  Native (" << (native.fromCache() ? "cached" : "built") << "): " << us << " us/scan, "
+                  << us * 1000.0 / static_cast<double>(site.size()) << " ns/instance, " << scanUs / us
+                  << "x scalar, frames " << (identical ? "bit-identical" : "DIFFER") << "\n";
+    }
+    for (std::size_t i = 0; i < site.size() && i < 3; i++) {
+        std::cout << "  Instance " << i << ":";
+        for (const STVariable& var : block.variables) {
+            if (var.array || (var.section != VarSection::INPUT && var.section != VarSection::OUTPUT)) {
+                continue;
+            }
+            std::int32_t slot = static_cast<std::int32_t>(var.offset);
+            std::cout << " " << var.name << "=";
+            switch (var.type) {
+                case STType::REAL: std::cout << site.getReal(i, slot); break;
+                case STType::INT: std::cout << site.getInteger(i, slot); break;
+                case STType::BOOL: std::cout << (site.getBoolean(i, slot) ? "TRUE" : "FALSE"); break;
+            }
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
+
+// Step the native PID engine against the ST FB_PID_Controller: vector and
+// scalar paths over mixed modes, checked for identical results
+void benchmarkPIDEngine(int loops, int scans) {
+    const float dt = 0.1f;
+    std::mt19937 random(25);
+    std::uniform_real_distribution<float> analog(0.0f, 100.0f);
+    PIDEngine vector;
+    vector.reserve(static_cast<std::size_t>(loops));
+    for (int i = 0; i < loops; i++) {
+        PIDTuning tuning;
+        tuning.kp = 0.5f + analog(random) / 20.0f;
+        tuning.ti = i % 7 == 0 ? 0.0f : 5.0f + analog(random);
+        tuning.td = i % 3 == 0 ? analog(random) / 50.0f : 0.0f;
+        tuning.deadBand = i % 5 == 0 ? 0.5f : 0.0f;
+        tuning.directAction = i % 2 == 1;
+        tuning.cvRoC = i % 4 == 0 ? 0.0f : 25.0f;
+        std::size_t loop = vector.add(tuning);
+        vector.setSetpoint(loop, analog(random));
+        vector.setProcessValue(loop, analog(random));
+        vector.setManualValue(loop, analog(random));
+        vector.setTrackValue(loop, analog(random));
+        vector.setMode(loop, PIDEngine::MANUAL, i % 8 == 1);
+        vector.setMode(loop, PIDEngine::TRACK, i % 8 == 2);
+        vector.setMode(loop, PIDEngine::HOLD, i % 8 == 3);
+    }
+    PIDEngine scalar = vector;
+
+    // Modes flip and PVs drift every scan, so every path is exercised
+    auto perturb = [&](PIDEngine& engine, int scan) {
+        for (int i = scan % 16; i < loops; i += 16) {
+            std::size_t loop = static_cast<std::size_t>(i);
+            engine.setMode(loop, PIDEngine::MANUAL, (i + scan) % 5 == 0);
+            engine.setProcessValue(loop, engine.getCV(loop) * 0.8f + 10.0f);
+        }
+    };
+    auto start = std::chrono::steady_clock::now();
+    for (int scan = 0; scan < scans; scan++) {
+        perturb(vector, scan);
+        vector.step(dt);
+    }
+    double vectorNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int scan = 0; scan < scans; scan++) {
+        perturb(scalar, scan);
+        scalar.stepScalar(dt);
+    }
+    double scalarNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::size_t mismatches = 0;
+    for (std::size_t loop = 0; loop < vector.size(); loop++) {
+        float a[3] = {vector.getCV(loop), vector.getITerm(loop), vector.getManualValue(loop)};
+        float b[3] = {scalar.getCV(loop), scalar.getITerm(loop), scalar.getManualValue(loop)};
+        mismatches += std::memcmp(a, b, sizeof(a)) != 0 || vector.getStatus(loop) != scalar.getStatus(loop);
+    }
+
+    // The ST block from the bytecode VM, one frame per loop
+    PLCMemory plcMemory;
+    STFunctionBlock block;
+    STCompiler compiler(plcMemory, block.program);
+    double blockNs = 0.0;
+    if (compiler.compileFunctionBlock(pidControllerBlock(), block)) {
+        FBInstanceArray site(block);
+        site.add(static_cast<std::size_t>(loops));
+        for (std::size_t i = 0; i < site.size(); i++) {
+            site.setReal(i, block.slot("i_rSP"), analog(random));
+            site.setReal(i, block.slot("i_rPV"), analog(random));
+        }
+        start = std::chrono::steady_clock::now();
+        for (int scan = 0; scan < scans; scan++) {
+            site.scan(plcMemory.image());
+        }
+        blockNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double steps = double(loops) * scans;
+    std::cout << "PID engine, " << loops << " loops x " << scans << " scans:\n";
+    std::cout << "  Vector: " << vectorNs / steps << " ns/loop, scalar: " << scalarNs / steps << " ns/loop ("
+              << scalarNs / vectorNs << "x), " << mismatches << " loops differ\n";
+    if (blockNs > 0.0) {
+        std::cout << "  ST FB_PID_Controller (VM): " << blockNs / steps << " ns/loop (" << blockNs / vectorNs
+                  << "x the engine)\n";
+    }
+    std::cout << "\n";
+}
+
+// Closed-loop plant: one temperature loop per controller, plant in ST and
+// controllers in the native PID engine, free-running on a virtual clock.
+// A third of the way in, a quarter of the loops go to manual, a quarter to
+// hold and every setpoint drops to 50 degC; at two thirds all return to
+// auto and the held loops must pick up the new setpoint without a bump.
+int runPID(int loops, double hours) {
+    if (loops <= 0 || !(hours > 0.0)) {
+        std::cout << "[ERROR] --pid needs a positive loop count and run time\n";
+        return 1;
+    }
+    PLCMemory plcMemory;
+    plcMemory.reserve(PLCArea::REAL, static_cast<std::size_t>(loops) * 4);
+    plcMemory.reserve(PLCArea::BOOL, static_cast<std::size_t>(loops) * 2);
+    std::vector<std::string> plant;
+    PIDEngine engine;
+    engine.reserve(static_cast<std::size_t>(loops));
+    for (int i = 0; i < loops; i++) {
+        std::string n = std::to_string(i);
+        plcMemory.setReal("SP_" + n, 60.0f);
+        plcMemory.setReal("PV_" + n, 20.0f);
+        plcMemory.setReal("CV_" + n, 0.0f);
+        plcMemory.setReal("MANVAL_" + n, 0.0f);
+        plcMemory.setBoolean("MAN_" + n, false);
+        plcMemory.setBoolean("HOLD_" + n, false);
+        // 0.8 degC per % output, tau 20-80 s, 100 ms steps
+        float timeConstant = 20.0f + static_cast<float>(i % 61);
+        plant.push_back("PV_" + n + " := PV_" + n + " + (20.0 + 0.8 * CV_" + n + " - PV_" + n + ") * " +
+                        std::to_string(0.1f / timeConstant) + ";");
+
+        PIDTuning tuning;
+        tuning.kp = 2.0f;
+        tuning.ti = timeConstant;
+        tuning.cvRoC = 25.0f;
+        PIDBinding binding;
+        binding.sp = plcMemory.find("SP_" + n);
+        binding.pv = plcMemory.find("PV_" + n);
+        binding.cv = plcMemory.find("CV_" + n);
+        binding.manualMode = plcMemory.find("MAN_" + n);
+        binding.manualValue = plcMemory.find("MANVAL_" + n);
+        binding.hold = plcMemory.find("HOLD_" + n);
+        if (!engine.bind(engine.add(tuning), binding)) {
+            return 1;
+        }
+    }
+    STInterpreter model(plcMemory);
+    if (!model.compile(plant)) {
+        return 1;
+    }
+
+    VirtualClock clock(0);
+    ScanScheduler scheduler(plcMemory);
+    auto task = scheduler.addTask("LOOPS", std::chrono::milliseconds(100), 0);
+    scheduler.addProgram(task, model.program());
+    scheduler.addPIDs(task, engine);
+
+    // Largest CV change over one scan across the loops of a group
+    std::vector<float> before(static_cast<std::size_t>(loops));
+    const ProcessImage& image = plcMemory.image();
+    auto cvStep = [&](auto inGroup) {
+        float largest = 0.0f;
+        for (std::size_t i = 0; i < engine.size(); i++) {
+            if (inGroup(i)) {
+                largest = std::max(largest, std::fabs(engine.getCV(i) - before[i]));
+            }
+        }
+        return largest;
+    };
+    auto switchModes = [&](bool manual, bool hold) {
+        for (std::size_t i = 0; i < engine.size(); i++) {
+            before[i] = engine.getCV(i);
+        }
+        for (int i = 0; i < loops; i++) {
+            plcMemory.setBoolean("MAN_" + std::to_string(i), manual && i % 4 == 1);
+            plcMemory.setBoolean("HOLD_" + std::to_string(i), hold && i % 4 == 2);
+            if (manual) {
+                plcMemory.setReal("SP_" + std::to_string(i), 50.0f);
+            }
+        }
+        scheduler.runFreeRunning(clock, std::chrono::milliseconds(100));
+    };
+    auto averageError = [&]() {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < engine.size(); i++) {
+            sum += std::fabs(engine.getError(i));
+        }
+        return sum / static_cast<double>(engine.size());
+    };
+    auto third = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double, std::ratio<3600>>(hours / 3.0));
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.runFreeRunning(clock, third);
+    double autoError = averageError();
+    switchModes(true, true);
+    float manualBump = cvStep([](std::size_t i) { return i % 4 == 1; });
+    float holdBump = cvStep([](std::size_t i) { return i % 4 == 2; });
+    scheduler.runFreeRunning(clock, third);
+    switchModes(false, false);
+    float returnBump = cvStep([](std::size_t i) { return i % 4 == 1 || i % 4 == 2; });
+    scheduler.runFreeRunning(clock, third);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double plantSeconds = static_cast<double>(clock.now()) / 1e9;
+    std::uint64_t loopScans = scheduler.scanCount(task) * static_cast<std::uint64_t>(loops);
+    std::cout << "Native PID, " << loops << " loops: " << plantSeconds / 3600.0 << " h of plant time in " << seconds
+              << " s (" << plantSeconds / seconds << "x real time), " << scheduler.scanCount(task) << " scans, "
+              << double(loopScans) / seconds / 1e6 << " M loop-scans/s\n";
+    std::cout << "  |SP - PV| after auto: " << autoError << ", at end: " << averageError() << "\n";
+    std::cout << "  Largest CV step at transfer: to manual " << manualBump << " %, to hold " << holdBump
+              << " %, back to auto " << returnBump << " %\n";
+    std::cout << "  Loop 0: PV=" << image.reals[plcMemory.find("PV_0").index] << " CV=" << engine.getCV(0)
+              << " I=" << engine.getITerm(0) << "\n\n";
+    benchmarkPIDEngine(loops, 2000);
+    return 0;
+}
+
 // Main PLC simulation program
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        benchmarkScan(argc > 2 ? std::stoi(argv[2]) : 100000);
+        benchmarkExpressions(argc > 2 ? std::stoi(argv[2]) : 100000);
+        benchmarkProcessImage(4096, 200);
+        benchmarkChanges(4096, 2000);
+        benchmarkPIDEngine(4096, 2000);
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--fb") {
+        return runFunctionBlock(argv[2], argc > 3 ? std::stoi(argv[3]) : 5000,
+                                argc > 4 ? std::stoi(argv[4]) : 100);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--virtual") {
+        return runVirtual(argc > 2 ? std::stod(argv[2]) : 1.0, argc > 3 ? std::stoi(argv[3]) : 4);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--sweep") {
+        return runSweep(argc > 2 ? std::stoull(argv[2]) : 2000,
+                        argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : std::thread::hardware_concurrency(),
+                        argc > 4 ? argv[4] : "", argc > 5 ? argv[5] : "");
+    }
+    if (argc > 1 && std::string(argv[1]) == "--pid") {
+        return runPID(argc > 2 ? std::stoi(argv[2]) : 1024, argc > 3 ? std::stod(argv[3]) : 1.0);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--tasks") {
+        return runTasks(argc > 2 ? std::stod(argv[2]) : 2.0);
+    }
+
     std::cout << "ISA-61131-3 PLC Programming Languages Simulation\n";
     std::cout << "================================================\n\n";
     
@@ -204,27 +1125,22 @@ int main() {
     STInterpreter stInterpreter(plcMemory);
     
     // Create a simple Structured Text program
-    std::vector<std::string> stProgram = {
-        "// Motor control program in Structured Text",
-        "MotorRunning := FALSE;",
-        "IF I0.0 THEN",
-        "    Q0.0 := TRUE;    // Start motor if input I0.0 is active",
-        "    MotorRunning := TRUE;",
-        "ELSE",
-        "    Q0.0 := FALSE;   // Stop motor",
-        "    MotorRunning := FALSE;",
-        "END_IF;",
-        "",
-        "Counter := Counter + 1;  // Increment cycle counter",
-        "Temperature := 25.5;     // Set temperature reference"
-    };
+    std::vector<std::string> stProgram = motorControlProgram();
     
-    // Execute the ST program
-    stInterpreter.executeSTProgram(stProgram);
+    // Compile the ST program once, then execute a scan
+    if (!stInterpreter.compile(stProgram)) {
+        return 1;
+    }
+    std::cout << "Executing Structured Text Program:\n";
+    for (const auto& line : stProgram) {
+        std::cout << "  " << line << "\n";
+    }
+    stInterpreter.runScan();
+    std::cout << "Program execution completed\n\n";
     
     // Display final state
     std::cout << "Final State:\n";
     plcMemory.displayState();
     
     return 0;
-}
\ No newline at end of file
+}
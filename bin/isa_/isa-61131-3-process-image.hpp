@@ -0,0 +1,83 @@
+/**
+ * ISA-61131-3 Process Image
+ * Contiguous, slot-addressed PLC memory: digital inputs and outputs are
+ * bit-packed into 64-bit words, INT/REAL/BOOL variables live in typed
+ * arrays. Programs resolve names to PLCAddress once at load time and then
+ * read and write by index, so a scan touches a few cache lines and never
+ * hashes or compares a string.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class PLCArea : std::uint8_t {
+    INPUT,      // digital inputs (bits)
+    OUTPUT,     // digital outputs (bits)
+    INT,        // INT variables
+    REAL,       // REAL variables
+    BOOL,       // BOOL variables
+    NONE
+};
+
+struct PLCAddress {
+    PLCArea area = PLCArea::NONE;
+    std::uint32_t index = 0;     // bit number for INPUT/OUTPUT, element otherwise
+
+    bool valid() const { return area != PLCArea::NONE; }
+};
+
+class ProcessImage {
+private:
+    static std::size_t words(std::uint32_t bits) { return (bits + 63) / 64; }
+
+    static bool getBit(const std::vector<std::uint64_t>& area, std::uint32_t bit) {
+        return (area[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    static void setBit(std::vector<std::uint64_t>& area, std::uint32_t bit, bool value) {
+        std::uint64_t mask = std::uint64_t(1) << (bit & 63);
+        std::uint64_t& word = area[bit >> 6];
+        word = (word & ~mask) | (-static_cast<std::uint64_t>(value) & mask);
+    }
+
+public:
+    std::vector<std::uint64_t> inputs;
+    std::vector<std::uint64_t> outputs;
+    std::vector<std::int32_t> integers;
+    std::vector<float> reals;
+    std::vector<std::uint8_t> booleans;
+    std::uint32_t inputCount = 0;
+    std::uint32_t outputCount = 0;
+
+    // Allocate one more slot in an area and return its address
+    PLCAddress allocate(PLCArea area) {
+        switch (area) {
+            case PLCArea::INPUT:
+                inputs.resize(words(inputCount + 1), 0);
+                return {area, inputCount++};
+            case PLCArea::OUTPUT:
+                outputs.resize(words(outputCount + 1), 0);
+                return {area, outputCount++};
+            case PLCArea::INT:
+                integers.push_back(0);
+                return {area, static_cast<std::uint32_t>(integers.size() - 1)};
+            case PLCArea::REAL:
+                reals.push_back(0.0f);
+                return {area, static_cast<std::uint32_t>(reals.size() - 1)};
+            case PLCArea::BOOL:
+                booleans.push_back(0);
+                return {area, static_cast<std::uint32_t>(booleans.size() - 1)};
+            case PLCArea::NONE:
+                break;
+        }
+        return {};
+    }
+
+    bool input(std::uint32_t bit) const { return getBit(inputs, bit); }
+    void setInput(std::uint32_t bit, bool value) { setBit(inputs, bit, value); }
+    bool output(std::uint32_t bit) const { return getBit(outputs, bit); }
+    void setOutput(std::uint32_t bit, bool value) { setBit(outputs, bit, value); }
+};
@@ -0,0 +1,380 @@
+/**
+ * ISA-61131-3 Cyclic Task Scheduler
+ * Runs compiled programs under IEC 61131-3 cyclic task semantics:
+ *  - each task has a period and a priority (0 is highest); releases follow
+ *    absolute deadlines (release += period), so there is no drift, and the
+ *    scheduler sleeps until the next release rather than for an interval
+ *  - on a single simulated CPU the highest-priority released task runs to
+ *    completion; ties go to the earlier release
+ *  - copy-in/copy-out: a task executes on its own copy of the process
+ *    image, taken when it starts, and only the slots its programs assign are
+ *    copied back when it ends, so a scan sees a consistent snapshot
+ *  - per task, scan time, release jitter and overrun are recorded in
+ *    log2 histograms; scans longer than the watchdog time are counted
+ *  - runFreeRunning() keeps the same release grid and priorities on a
+ *    VirtualClock but runs scans back to back: instead of sleeping, the
+ *    clock jumps to the next release, so plant time passes as fast as the
+ *    CPU can scan. The clock is bound to the thread meanwhile, so timers
+ *    and alarm timestamps follow plant time
+ *  - an optional ChangeTracker sees the shared image after every copy-out
+ *    and publishes only the points that scan changed
+ *  - native PID engines run after the timers with dt = the task period,
+ *    so their loops advance in plant time in either mode
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "isa-clock.hpp"
+#include "isa-61131-3-change-tracker.hpp"
+#include "isa-61131-3-pid-engine.hpp"
+#include "isa-61131-3-plc-memory.hpp"
+#include "isa-61131-3-process-image.hpp"
+#include "isa-61131-3-st-vm.hpp"
+#include "isa-61131-3-timers.hpp"
+
+// Power-of-two microsecond buckets: [0,1) [1,2) [2,4) ... [2^(n-2), inf)
+class ScanHistogram {
+public:
+    static constexpr std::size_t BUCKETS = 24;
+
+private:
+    std::uint64_t counts[BUCKETS] = {};
+    std::uint64_t total = 0;
+    std::int64_t maximum = 0;
+
+    static std::size_t bucketOf(std::int64_t us) {
+        std::size_t bucket = 0;
+        while (us > 0 && bucket < BUCKETS - 1) {
+            us >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+public:
+    void record(std::chrono::nanoseconds value) {
+        std::int64_t us = std::max<std::int64_t>(0, value.count() / 1000);
+        counts[bucketOf(us)]++;
+        total++;
+        maximum = std::max(maximum, us);
+    }
+
+    std::uint64_t count() const { return total; }
+    std::int64_t maxUs() const { return maximum; }
+
+    // Upper bound (us) of the bucket holding quantile q
+    std::int64_t percentileUs(double q) const {
+        std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(total));
+        std::uint64_t seen = 0;
+        for (std::size_t b = 0; b < BUCKETS; b++) {
+            seen += counts[b];
+            if (seen > rank) {
+                return b == 0 ? 1 : std::int64_t(1) << b;
+            }
+        }
+        return maximum;
+    }
+
+    void print(const char* label) const {
+        std::cout << "    " << std::left << std::setw(10) << label << std::right
+                  << " p50 <" << percentileUs(0.5) << " us, p99 <" << percentileUs(0.99)
+                  << " us, max " << maximum << " us |";
+        for (std::size_t b = 0; b < BUCKETS; b++) {
+            if (counts[b] != 0) {
+                std::cout << " <" << (b == 0 ? 1 : std::int64_t(1) << b) << "us:" << counts[b];
+            }
+        }
+        std::cout << "\n";
+    }
+};
+
+class ScanScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TaskId = std::size_t;
+    static constexpr TaskId INVALID_TASK = static_cast<TaskId>(-1);
+
+private:
+    // Slots a task writes back at copy-out
+    struct WriteSet {
+        std::vector<std::uint64_t> outputMask;      // per output word
+        std::vector<std::uint32_t> integers;
+        std::vector<std::uint32_t> reals;
+        std::vector<std::uint32_t> booleans;
+    };
+
+    struct Task {
+        std::string name;
+        std::chrono::nanoseconds period;
+        int priority;
+        std::chrono::nanoseconds watchdog;
+        std::vector<const STProgram*> programs;
+        std::vector<TimerBank*> timers;     // evaluated after the programs
+        std::vector<PIDEngine*> pids;       // stepped after the timers
+        WriteSet writes;
+        ProcessImage image;
+        Clock::time_point release;
+        TimestampNs virtualRelease = 0;     // release on the virtual clock (free-running)
+
+        std::uint64_t scans = 0;
+        std::uint64_t overruns = 0;         // scans that finished after the next release
+        std::uint64_t watchdogTrips = 0;
+        ScanHistogram scanTime;
+        ScanHistogram jitter;               // start - release
+        ScanHistogram overrun;              // finish - next release, for late scans
+    };
+
+    PLCMemory& memory;
+    std::vector<Task> tasks;
+    ChangeTracker* changes = nullptr;
+
+    static void addUnique(std::vector<std::uint32_t>& list, std::uint32_t index) {
+        if (std::find(list.begin(), list.end(), index) == list.end()) {
+            list.push_back(index);
+        }
+    }
+
+    static void addWrite(WriteSet& writes, PLCAddress address) {
+        switch (address.area) {
+            case PLCArea::OUTPUT: {
+                std::size_t word = address.index / 64;
+                if (writes.outputMask.size() <= word) {
+                    writes.outputMask.resize(word + 1, 0);
+                }
+                writes.outputMask[word] |= std::uint64_t(1) << (address.index & 63);
+                break;
+            }
+            case PLCArea::INT: addUnique(writes.integers, address.index); break;
+            case PLCArea::REAL: addUnique(writes.reals, address.index); break;
+            case PLCArea::BOOL: addUnique(writes.booleans, address.index); break;
+            default: break;
+        }
+    }
+
+    void copyIn(Task& task) {
+        task.image = memory.image();    // reuses the task image's capacity
+    }
+
+    void copyOut(const Task& task) {
+        ProcessImage& global = memory.image();
+        const WriteSet& writes = task.writes;
+        for (std::size_t w = 0; w < writes.outputMask.size(); w++) {
+            std::uint64_t mask = writes.outputMask[w];
+            global.outputs[w] = (global.outputs[w] & ~mask) | (task.image.outputs[w] & mask);
+        }
+        for (std::uint32_t i : writes.integers) {
+            global.integers[i] = task.image.integers[i];
+        }
+        for (std::uint32_t i : writes.reals) {
+            global.reals[i] = task.image.reals[i];
+        }
+        for (std::uint32_t i : writes.booleans) {
+            global.booleans[i] = task.image.booleans[i];
+        }
+    }
+
+    // One scan: copy-in, programs, timers, PIDs, copy-out, change publishing
+    void scan(Task& task) {
+        copyIn(task);
+        for (const STProgram* program : task.programs) {
+            STVirtualMachine::run(*program, task.image);
+        }
+        TimestampNs now = clockNowNs();
+        for (TimerBank* bank : task.timers) {
+            bank->update(task.image, now);
+        }
+        float dt = std::chrono::duration<float>(task.period).count();
+        for (PIDEngine* engine : task.pids) {
+            engine->scan(task.image, dt);
+        }
+        copyOut(task);
+        if (changes != nullptr) {
+            changes->publish(memory.image(), now);
+        }
+    }
+
+    void execute(Task& task, Clock::time_point start) {
+        scan(task);
+        Clock::time_point finish = Clock::now();
+
+        std::chrono::nanoseconds elapsed = finish - start;
+        task.scans++;
+        task.scanTime.record(elapsed);
+        task.jitter.record(start - task.release);
+        task.watchdogTrips += elapsed > task.watchdog;
+
+        // Next release on the absolute grid. A late task starts its pending
+        // activation at once; whole periods that passed meanwhile are skipped.
+        task.release += task.period;
+        if (finish > task.release) {
+            task.overrun.record(finish - task.release);
+            task.overruns++;
+            task.release += task.period * ((finish - task.release) / task.period);
+        }
+    }
+
+public:
+    explicit ScanScheduler(PLCMemory& plcMemory) : memory(plcMemory) {}
+
+    // Add a cyclic task; the watchdog defaults to the period. A period that
+    // is not positive is rejected with INVALID_TASK, which the add* calls ignore.
+    TaskId addTask(const std::string& name, std::chrono::nanoseconds period, int priority,
+                   std::chrono::nanoseconds watchdog = std::chrono::nanoseconds::zero()) {
+        if (period.count() <= 0) {
+            std::cout << "[ERROR] Task " << name << ": period must be positive\n";
+            return INVALID_TASK;
+        }
+        Task task;
+        task.name = name;
+        task.period = period;
+        task.priority = priority;
+        task.watchdog = watchdog.count() > 0 ? watchdog : period;
+        tasks.push_back(std::move(task));
+        return tasks.size() - 1;
+    }
+
+    // Attach a compiled program (executed in attach order). The program must
+    // outlive the scheduler and be compiled against this scheduler's memory.
+    void addProgram(TaskId id, const STProgram& program) {
+        if (id >= tasks.size()) {
+            return;
+        }
+        Task& task = tasks[id];
+        task.programs.push_back(&program);
+        for (const STSymbol& symbol : program.symbols) {
+            if (symbol.written) {
+                addWrite(task.writes, symbol.address);
+            }
+        }
+    }
+
+    // Attach timers, evaluated after the task's programs at the task's rate
+    void addTimers(TaskId id, TimerBank& timers) {
+        if (id >= tasks.size()) {
+            return;
+        }
+        Task& task = tasks[id];
+        task.timers.push_back(&timers);
+        for (std::size_t i = 0; i < timers.size(); i++) {
+            addWrite(task.writes, timers[i].out);
+            addWrite(task.writes, timers[i].elapsed);
+        }
+    }
+
+    // Attach a PID engine, stepped once per scan with dt = the task period.
+    // Bind its loops first: their CV slots become the task's writes.
+    void addPIDs(TaskId id, PIDEngine& engine) {
+        if (id >= tasks.size()) {
+            return;
+        }
+        Task& task = tasks[id];
+        task.pids.push_back(&engine);
+        for (PLCAddress slot : engine.writtenSlots()) {
+            addWrite(task.writes, slot);
+        }
+    }
+
+    // Publish the points each scan changed in the shared image; the tracker
+    // must outlive the scheduler
+    void setChangeTracker(ChangeTracker* tracker) { changes = tracker; }
+
+    // Run all tasks in real time for the given duration
+    void run(std::chrono::nanoseconds duration) {
+        Clock::time_point begin = Clock::now();
+        Clock::time_point end = begin + duration;
+        for (Task& task : tasks) {
+            task.release = begin;
+        }
+        for (;;) {
+            Clock::time_point now = Clock::now();
+            if (now >= end) {
+                return;
+            }
+            // Highest-priority released task, earliest release on ties
+            Task* ready = nullptr;
+            Clock::time_point nextRelease = end;
+            for (Task& task : tasks) {
+                if (task.release <= now) {
+                    if (ready == nullptr || task.priority < ready->priority ||
+                        (task.priority == ready->priority && task.release < ready->release)) {
+                        ready = &task;
+                    }
+                } else {
+                    nextRelease = std::min(nextRelease, task.release);
+                }
+            }
+            if (ready != nullptr) {
+                execute(*ready, now);
+            } else {
+                std::this_thread::sleep_until(nextRelease);
+            }
+        }
+    }
+
+    // Run all tasks for the given plant time on a virtual clock, scans back
+    // to back; starts at the clock's current time and leaves it at the end
+    void runFreeRunning(VirtualClock& clock, std::chrono::nanoseconds duration) {
+        ClockBinding binding(clock);
+        TimestampNs end = clock.now() + duration.count();
+        for (Task& task : tasks) {
+            task.virtualRelease = clock.now();
+        }
+        for (;;) {
+            // Highest-priority released task, earliest release on ties
+            Task* ready = nullptr;
+            TimestampNs nextRelease = end;
+            for (Task& task : tasks) {
+                if (task.virtualRelease <= clock.now() && task.virtualRelease < end) {
+                    if (ready == nullptr || task.priority < ready->priority ||
+                        (task.priority == ready->priority && task.virtualRelease < ready->virtualRelease)) {
+                        ready = &task;
+                    }
+                } else {
+                    nextRelease = std::min(nextRelease, task.virtualRelease);
+                }
+            }
+            if (ready == nullptr) {
+                clock.set(nextRelease);
+                if (nextRelease >= end) {
+                    return;
+                }
+                continue;
+            }
+            Clock::time_point start = Clock::now();
+            scan(*ready);
+            ready->scans++;
+            ready->scanTime.record(Clock::now() - start);
+            ready->virtualRelease += ready->period.count();
+        }
+    }
+
+    void printReport() const {
+        std::cout << "=== TASK REPORT ===\n";
+        for (const Task& task : tasks) {
+            std::cout << "  Task " << task.name << " ("
+                      << std::chrono::duration<double, std::milli>(task.period).count() << " ms, priority "
+                      << task.priority << "): " << task.scans << " scans, " << task.overruns
+                      << " overruns, " << task.watchdogTrips << " watchdog trips\n";
+            task.scanTime.print("scan time");
+            task.jitter.print("jitter");
+            if (task.overrun.count() != 0) {
+                task.overrun.print("overrun");
+            }
+        }
+        std::cout << "===================\n\n";
+    }
+
+    std::size_t taskCount() const { return tasks.size(); }
+    std::uint64_t scanCount(TaskId id) const { return id < tasks.size() ? tasks[id].scans : 0; }
+    std::uint64_t overrunCount(TaskId id) const { return id < tasks.size() ? tasks[id].overruns : 0; }
+};
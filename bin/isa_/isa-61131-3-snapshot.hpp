@@ -0,0 +1,121 @@
+/**
+ * ISA-61131-3 PLC Snapshots
+ * The run-time state of a simulated PLC - process image, timers, function
+ * block instance frames and the virtual clock - as one flat byte blob. A
+ * SnapshotLayout lists the memory regions once, after configuration;
+ * capture and restore are then one memcpy per region, with no allocation
+ * once the blob has its capacity. A blob restores into any PLC built from
+ * the same configuration, e.g. one per thread to fork what-if runs from a
+ * common checkpoint. It starts with the region sizes, so restoring into a
+ * differently configured PLC is refused instead of corrupting it.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "isa-clock.hpp"
+#include "isa-61131-3-function-block.hpp"
+#include "isa-61131-3-plc-memory.hpp"
+#include "isa-61131-3-process-image.hpp"
+#include "isa-61131-3-timers.hpp"
+
+using PLCSnapshot = std::vector<unsigned char>;
+
+class SnapshotLayout {
+private:
+    static constexpr std::uint32_t MAGIC = 0x53434C50;     // "PLCS"
+
+    struct Region {
+        void* data;
+        std::uint64_t bytes;
+    };
+
+    std::vector<Region> regions;
+
+    std::size_t headerSize() const { return 2 * sizeof(std::uint32_t) + regions.size() * sizeof(std::uint64_t); }
+
+public:
+    // Regions must not be resized or reallocated while the layout is in use
+    void add(void* data, std::size_t bytes) { regions.push_back({data, bytes}); }
+
+    void add(ProcessImage& image) {
+        add(image.inputs.data(), image.inputs.size() * sizeof(std::uint64_t));
+        add(image.outputs.data(), image.outputs.size() * sizeof(std::uint64_t));
+        add(image.integers.data(), image.integers.size() * sizeof(std::int32_t));
+        add(image.reals.data(), image.reals.size() * sizeof(float));
+        add(image.booleans.data(), image.booleans.size());
+    }
+
+    void add(PLCMemory& memory) { add(memory.image()); }
+    void add(TimerBank& timers) { add(timers.data(), timers.size() * sizeof(IECTimer)); }
+    void add(VirtualClock& clock) {
+        static_assert(std::is_trivially_copyable<VirtualClock>::value, "the clock is snapshotted with memcpy");
+        add(&clock, sizeof(VirtualClock));
+    }
+
+    void add(FBInstanceArray& instances) {
+        add(instances.frame(0), instances.size() * instances.functionBlock().frameSize() * sizeof(STCell));
+    }
+
+    // Blob size in bytes
+    std::size_t size() const {
+        std::size_t bytes = headerSize();
+        for (const Region& region : regions) {
+            bytes += region.bytes;
+        }
+        return bytes;
+    }
+
+    void capture(PLCSnapshot& blob) const {
+        blob.resize(size());
+        unsigned char* out = blob.data();
+        std::uint32_t header[2] = {MAGIC, static_cast<std::uint32_t>(regions.size())};
+        std::memcpy(out, header, sizeof(header));
+        out += sizeof(header);
+        for (const Region& region : regions) {
+            std::memcpy(out, &region.bytes, sizeof(region.bytes));
+            out += sizeof(region.bytes);
+        }
+        for (const Region& region : regions) {
+            if (region.bytes != 0) {
+                std::memcpy(out, region.data, region.bytes);
+            }
+            out += region.bytes;
+        }
+    }
+
+    // Restore a blob captured from the same layout; false (and nothing
+    // changed) if it does not match
+    bool restore(const PLCSnapshot& blob) const {
+        if (blob.size() != size()) {
+            return false;
+        }
+        const unsigned char* in = blob.data();
+        std::uint32_t header[2];
+        std::memcpy(header, in, sizeof(header));
+        if (header[0] != MAGIC || header[1] != regions.size()) {
+            return false;
+        }
+        in += sizeof(header);
+        for (const Region& region : regions) {
+            std::uint64_t bytes;
+            std::memcpy(&bytes, in, sizeof(bytes));
+            if (bytes != region.bytes) {
+                return false;
+            }
+            in += sizeof(bytes);
+        }
+        for (const Region& region : regions) {
+            if (region.bytes != 0) {
+                std::memcpy(region.data, in, region.bytes);
+            }
+            in += region.bytes;
+        }
+        return true;
+    }
+};
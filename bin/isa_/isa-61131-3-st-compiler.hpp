@@ -0,0 +1,1173 @@
+/**
+ * ISA-61131-3 Structured Text Compiler
+ * Turns the parsed program into register bytecode for STVirtualMachine.
+ * Every variable is resolved once, at compile time, to its process image
+ * address; expressions are type-checked (INT is promoted to REAL where
+ * mixed) and built-in calls map to single opcodes. Subexpressions whose
+ * operands are all constant are folded at compile time through the VM's
+ * ALU, and branches with constant conditions are dropped. IF/ELSIF/ELSE,
+ * FOR, WHILE and REPEAT become conditional jumps; EXIT and RETURN become
+ * forward jumps patched when the loop or program ends.
+ *
+ * compileFunctionBlock() compiles a FUNCTION_BLOCK: its variables are laid
+ * out in an instance frame and accessed frame-relative, VAR CONSTANT names
+ * become literals (and so fold), and VAR_TEMP is re-initialized per call.
+ * With setSquareDistances(true), REAL temporaries that only hold
+ * SQRT(non-negative) values and are only compared (nearest-match searches)
+ * keep the squared value instead, and the SQRT is dropped; EXPT(x, 2) and
+ * x ** 2 become a multiplication. Results can then differ from the exact
+ * program in the last bit: powf is not correctly rounded, x * x is, and
+ * near-ties between compared distances can order differently.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "isa-61131-3-function-block.hpp"
+#include "isa-61131-3-plc-memory.hpp"
+#include "isa-61131-3-st-parser.hpp"
+#include "isa-61131-3-st-vm.hpp"
+
+class STCompiler {
+private:
+    PLCMemory& memory;
+    STProgram& program;
+    std::unordered_map<std::string, std::uint32_t> symbols;   // name -> program.symbols index
+    std::vector<std::vector<std::size_t>> loopExits;            // EXIT jumps per open loop
+    std::vector<std::size_t> returns;                           // RETURN jumps
+    std::string errorMessage;
+
+    // Function block being compiled, if any
+    struct Constant {
+        STType type;
+        STCell value;
+    };
+    STFunctionBlock* block = nullptr;
+    std::unordered_map<std::string, std::uint32_t> locals;     // name -> block->variables index
+    std::unordered_map<std::string, Constant> constants;
+    bool squareDistances = false;
+
+    // A resolved variable: a frame slot of the function block or a process image symbol
+    struct VarRef {
+        bool local;
+        std::uint32_t index;        // block->variables or program.symbols index
+        STType type;
+    };
+
+    bool fail(int line, const std::string& message) {
+        if (errorMessage.empty()) {
+            errorMessage = "line " + std::to_string(line) + ": " + message;
+        }
+        return false;
+    }
+
+    void emit(OpCode op, int dst = 0, int lhs = 0, int rhs = 0, std::int32_t operand = 0) {
+        program.code.push_back({op, static_cast<std::uint8_t>(dst), static_cast<std::uint8_t>(lhs),
+                                static_cast<std::uint8_t>(rhs), operand});
+    }
+
+    static STType areaType(PLCArea area) {
+        switch (area) {
+            case PLCArea::INT: return STType::INT;
+            case PLCArea::REAL: return STType::REAL;
+            default: return STType::BOOL;
+        }
+    }
+
+    std::uint32_t addSymbol(const std::string& name, PLCAddress address) {
+        std::uint32_t symbol = static_cast<std::uint32_t>(program.symbols.size());
+        program.symbols.push_back({name, areaType(address.area), address, false});
+        symbols.emplace(name, symbol);
+        return symbol;
+    }
+
+    // Resolve a name to its process image address (once per program)
+    bool resolve(const std::string& name, std::uint32_t& symbol) {
+        auto it = symbols.find(name);
+        if (it != symbols.end()) {
+            symbol = it->second;
+            return true;
+        }
+        PLCAddress address = memory.find(name);
+        if (!address.valid()) {
+            return false;
+        }
+        symbol = addSymbol(name, address);
+        return true;
+    }
+
+    // Assigning an undeclared name creates it, typed by the value (Qn.m is an output)
+    std::uint32_t declare(const std::string& name, STType type) {
+        bool output = name.size() > 1 && name[0] == 'Q' && std::isdigit(static_cast<unsigned char>(name[1]));
+        PLCArea area = (type == STType::INT) ? PLCArea::INT
+                     : (type == STType::REAL) ? PLCArea::REAL
+                     : output ? PLCArea::OUTPUT : PLCArea::BOOL;
+        return addSymbol(name, memory.define(area, name));
+    }
+
+    // Locals shadow process image names
+    bool lookup(const std::string& name, VarRef& ref) {
+        auto local = locals.find(name);
+        if (local != locals.end()) {
+            ref = {true, local->second, block->variables[local->second].type};
+            return true;
+        }
+        std::uint32_t symbol = 0;
+        if (!resolve(name, symbol)) {
+            return false;
+        }
+        ref = {false, symbol, program.symbols[symbol].type};
+        return true;
+    }
+
+    static OpCode loadOp(PLCArea area) {
+        switch (area) {
+            case PLCArea::INPUT: return OpCode::LOAD_INPUT;
+            case PLCArea::OUTPUT: return OpCode::LOAD_OUTPUT;
+            case PLCArea::INT: return OpCode::LOAD_INT;
+            case PLCArea::REAL: return OpCode::LOAD_REAL;
+            default: return OpCode::LOAD_BOOL;
+        }
+    }
+
+    static OpCode storeOp(PLCArea area) {
+        switch (area) {
+            case PLCArea::OUTPUT: return OpCode::STORE_OUTPUT;
+            case PLCArea::INT: return OpCode::STORE_INT;
+            case PLCArea::REAL: return OpCode::STORE_REAL;
+            default: return OpCode::STORE_BOOL;
+        }
+    }
+
+    static bool isNumeric(STType type) {
+        return type == STType::INT || type == STType::REAL;
+    }
+
+    // Built-in functions. With all-INT arguments intOp is used when it exists;
+    // otherwise the arguments are promoted to REAL and realOp is used.
+    struct Builtin {
+        const char* name;
+        std::size_t arity;
+        OpCode intOp;       // HALT: no INT form
+        OpCode realOp;      // HALT: no REAL form
+    };
+
+    static const Builtin* findBuiltin(const std::string& name) {
+        static const Builtin builtins[] = {
+            {"SQRT", 1, OpCode::HALT, OpCode::SQRT_REAL},
+            {"SQR", 1, OpCode::HALT, OpCode::SQUARE_REAL},
+            {"EXPT", 2, OpCode::HALT, OpCode::EXPT_REAL},
+            {"ABS", 1, OpCode::ABS_INT, OpCode::ABS_REAL},
+            {"MIN", 2, OpCode::MIN_INT, OpCode::MIN_REAL},
+            {"MAX", 2, OpCode::MAX_INT, OpCode::MAX_REAL},
+            {"INT_TO_REAL", 1, OpCode::INT_TO_REAL, OpCode::HALT},
+            {"REAL_TO_INT", 1, OpCode::HALT, OpCode::REAL_TO_INT},
+            {"TRUNC", 1, OpCode::HALT, OpCode::TRUNC_REAL},
+        };
+        for (const Builtin& builtin : builtins) {
+            std::string_view text(builtin.name);
+            bool match = text.size() == name.size();
+            for (std::size_t i = 0; i < name.size() && match; i++) {
+                match = std::toupper(static_cast<unsigned char>(name[i])) == text[i];
+            }
+            if (match) {
+                return &builtin;
+            }
+        }
+        return nullptr;
+    }
+
+    static STType resultType(OpCode op) {
+        switch (op) {
+            case OpCode::ABS_INT: case OpCode::MIN_INT: case OpCode::MAX_INT:
+            case OpCode::REAL_TO_INT: case OpCode::TRUNC_REAL:
+                return STType::INT;
+            default:
+                return STType::REAL;
+        }
+    }
+
+    static OpCode arithmeticOp(TokenKind op, bool real) {
+        switch (op) {
+            case TokenKind::PLUS: return real ? OpCode::ADD_REAL : OpCode::ADD_INT;
+            case TokenKind::MINUS: return real ? OpCode::SUB_REAL : OpCode::SUB_INT;
+            case TokenKind::STAR: return real ? OpCode::MUL_REAL : OpCode::MUL_INT;
+            case TokenKind::SLASH: return real ? OpCode::DIV_REAL : OpCode::DIV_INT;
+            case TokenKind::POWER: return OpCode::EXPT_REAL;
+            default: return OpCode::MOD_INT;
+        }
+    }
+
+    static OpCode comparisonOp(TokenKind op, bool real) {
+        switch (op) {
+            case TokenKind::EQ: return real ? OpCode::EQ_REAL : OpCode::EQ_INT;
+            case TokenKind::NE: return real ? OpCode::NE_REAL : OpCode::NE_INT;
+            case TokenKind::LT: return real ? OpCode::LT_REAL : OpCode::LT_INT;
+            case TokenKind::LE: return real ? OpCode::LE_REAL : OpCode::LE_INT;
+            case TokenKind::GT: return real ? OpCode::GT_REAL : OpCode::GT_INT;
+            default: return real ? OpCode::GE_REAL : OpCode::GE_INT;
+        }
+    }
+
+    static bool isComparison(TokenKind op) {
+        return op == TokenKind::EQ || op == TokenKind::NE || op == TokenKind::LT ||
+               op == TokenKind::LE || op == TokenKind::GT || op == TokenKind::GE;
+    }
+
+    // Opcode of a checked UNARY, BINARY or CALL node (operands already promoted)
+    static OpCode opcodeOf(const STExpr& expr) {
+        switch (expr.kind) {
+            case ExprKind::UNARY:
+                if (expr.op == TokenKind::KW_NOT) {
+                    return OpCode::NOT;
+                }
+                return expr.type == STType::REAL ? OpCode::NEG_REAL : OpCode::NEG_INT;
+            case ExprKind::BINARY:
+                switch (expr.op) {
+                    case TokenKind::KW_AND: return OpCode::AND;
+                    case TokenKind::KW_OR: return OpCode::OR;
+                    case TokenKind::KW_XOR: return OpCode::XOR;
+                    default: break;
+                }
+                if (isComparison(expr.op)) {
+                    return comparisonOp(expr.op, expr.lhs->type == STType::REAL);
+                }
+                return arithmeticOp(expr.op, expr.type == STType::REAL);
+            case ExprKind::CALL: {
+                const Builtin* builtin = findBuiltin(expr.name);
+                return expr.args[0]->type == STType::INT && builtin->intOp != OpCode::HALT ? builtin->intOp
+                                                                                           : builtin->realOp;
+            }
+            default:
+                return OpCode::HALT;
+        }
+    }
+
+    // Replace a node whose operands are all literals by its value, computed
+    // with the VM's own ALU so the result is exactly what a scan would produce
+    static void fold(STExpr& expr) {
+        STExpr* a = nullptr;
+        STExpr* b = nullptr;
+        if (expr.kind == ExprKind::CALL) {
+            a = expr.args[0].get();
+            b = expr.args.size() > 1 ? expr.args[1].get() : a;
+        } else {
+            a = expr.lhs.get();
+            b = expr.rhs ? expr.rhs.get() : a;
+        }
+        if (a->kind != ExprKind::LITERAL || b->kind != ExprKind::LITERAL) {
+            return;
+        }
+        expr.value = STVirtualMachine::alu(opcodeOf(expr), a->value, b->value);
+        expr.kind = ExprKind::LITERAL;
+        expr.lhs.reset();
+        expr.rhs.reset();
+        expr.args.clear();
+    }
+
+    // Convert an operand to a type; only INT -> REAL is implicit
+    bool promote(STExprPtr& operand, STType to) {
+        if (operand->type == to) {
+            return true;
+        }
+        if (operand->type == STType::INT && to == STType::REAL) {
+            STExprPtr conversion = std::make_unique<STExpr>();
+            conversion->kind = ExprKind::CALL;
+            conversion->name = "INT_TO_REAL";
+            conversion->type = STType::REAL;
+            conversion->line = operand->line;
+            conversion->args.push_back(std::move(operand));
+            fold(*conversion);
+            operand = std::move(conversion);
+            return true;
+        }
+        return fail(operand->line, std::string("cannot convert ") + typeToString(operand->type) + " to " +
+                                   typeToString(to));
+    }
+
+    // Resolve names, type-check and fold constants. Sets expr.type to the
+    // result type and inserts conversions so operands match their operator.
+    bool check(STExpr& expr) {
+        switch (expr.kind) {
+            case ExprKind::LITERAL:
+                return true;
+            case ExprKind::VARIABLE: {
+                auto constant = constants.find(expr.name);
+                if (constant != constants.end()) {
+                    expr.kind = ExprKind::LITERAL;
+                    expr.type = constant->second.type;
+                    expr.value = constant->second.value;
+                    return true;
+                }
+                VarRef ref;
+                if (!lookup(expr.name, ref)) {
+                    return fail(expr.line, "undefined variable '" + expr.name + "'");
+                }
+                if (ref.local && block->variables[ref.index].array) {
+                    return fail(expr.line, "array '" + expr.name + "' needs an index");
+                }
+                expr.type = ref.type;
+                return true;
+            }
+            case ExprKind::INDEX:
+                return checkIndex(expr.name, *expr.lhs, expr.line, expr.type);
+            case ExprKind::UNARY: {
+                if (!check(*expr.lhs)) {
+                    return false;
+                }
+                expr.type = expr.lhs->type;
+                if (expr.op == TokenKind::KW_NOT && expr.type != STType::BOOL) {
+                    return fail(expr.line, "NOT requires a BOOL operand");
+                }
+                if (expr.op != TokenKind::KW_NOT && !isNumeric(expr.type)) {
+                    return fail(expr.line, "negation requires a numeric operand");
+                }
+                fold(expr);
+                return true;
+            }
+            case ExprKind::BINARY:
+                if (squareDistances && expr.op == TokenKind::POWER && isLiteralTwo(*expr.rhs)) {
+                    expr.kind = ExprKind::CALL;
+                    expr.name = "EXPT";
+                    expr.args.push_back(std::move(expr.lhs));
+                    expr.args.push_back(std::move(expr.rhs));
+                    return check(expr);
+                }
+                if (!checkBinary(expr)) {
+                    return false;
+                }
+                fold(expr);
+                return true;
+            case ExprKind::CALL:
+                if (!checkCall(expr)) {
+                    return false;
+                }
+                fold(expr);
+                return true;
+        }
+        return false;
+    }
+
+    bool checkBinary(STExpr& expr) {
+        if (!check(*expr.lhs) || !check(*expr.rhs)) {
+            return false;
+        }
+        STType left = expr.lhs->type;
+        STType right = expr.rhs->type;
+        switch (expr.op) {
+            case TokenKind::KW_AND:
+            case TokenKind::KW_OR:
+            case TokenKind::KW_XOR:
+                if (left != STType::BOOL || right != STType::BOOL) {
+                    return fail(expr.line, "logical operators require BOOL operands");
+                }
+                expr.type = STType::BOOL;
+                return true;
+
+            case TokenKind::EQ: case TokenKind::NE: case TokenKind::LT:
+            case TokenKind::LE: case TokenKind::GT: case TokenKind::GE: {
+                bool equality = expr.op == TokenKind::EQ || expr.op == TokenKind::NE;
+                if (left == STType::BOOL && right == STType::BOOL && equality) {
+                    expr.type = STType::BOOL;
+                    return true;
+                }
+                if (!isNumeric(left) || !isNumeric(right)) {
+                    return fail(expr.line, std::string("cannot compare ") + typeToString(left) +
+                                           " with " + typeToString(right));
+                }
+                STType common = (left == STType::REAL || right == STType::REAL) ? STType::REAL : STType::INT;
+                expr.type = STType::BOOL;
+                return promote(expr.lhs, common) && promote(expr.rhs, common);
+            }
+
+            default: {
+                if (!isNumeric(left) || !isNumeric(right)) {
+                    return fail(expr.line, "arithmetic requires numeric operands");
+                }
+                bool real = left == STType::REAL || right == STType::REAL || expr.op == TokenKind::POWER;
+                if (expr.op == TokenKind::KW_MOD && real) {
+                    return fail(expr.line, "MOD requires INT operands");
+                }
+                expr.type = real ? STType::REAL : STType::INT;
+                return promote(expr.lhs, expr.type) && promote(expr.rhs, expr.type);
+            }
+        }
+    }
+
+    // name[index]: name must be a local array and index an INT in range
+    bool checkIndex(const std::string& name, STExpr& index, int line, STType& type) {
+        auto local = locals.find(name);
+        if (local == locals.end() || !block->variables[local->second].array) {
+            return fail(line, "'" + name + "' is not an array");
+        }
+        const STVariable& variable = block->variables[local->second];
+        if (!check(index)) {
+            return false;
+        }
+        if (index.type != STType::INT) {
+            return fail(line, "array index must be INT");
+        }
+        if (index.kind == ExprKind::LITERAL &&
+            (index.value.i < variable.lower ||
+             std::int64_t(index.value.i) - variable.lower >= std::int64_t(variable.length))) {
+            return fail(line, "index " + std::to_string(index.value.i) + " out of range for '" + name + "'");
+        }
+        type = variable.type;
+        return true;
+    }
+
+    // Frame address of name[index]: a fixed slot for a constant index,
+    // otherwise the zero-based element is left in r[reg]
+    bool emitElement(const std::string& name, const STExpr& index, int reg, bool& fixed, std::int32_t& operand) {
+        const STVariable& variable = block->variables[locals.at(name)];
+        fixed = index.kind == ExprKind::LITERAL;
+        if (fixed) {
+            operand = static_cast<std::int32_t>(variable.offset + (index.value.i - variable.lower));
+            return true;
+        }
+        if (!emitExpr(index, reg)) {
+            return false;
+        }
+        if (variable.lower != 0) {
+            if (!useRegister(reg + 1, index.line)) {
+                return false;
+            }
+            emit(OpCode::LOAD_CONST, reg + 1, 0, 0, variable.lower);
+            emit(OpCode::SUB_INT, reg, reg, reg + 1);
+        }
+        operand = packArray(variable.offset, variable.length);
+        return true;
+    }
+
+    bool checkCall(STExpr& expr) {
+        // Squaring by multiplication; may differ from powf in the last bit
+        if (squareDistances && expr.args.size() == 2 && isLiteralTwo(*expr.args[1]) &&
+            findBuiltin(expr.name) == findBuiltin("EXPT")) {
+            expr.name = "SQR";
+            expr.args.pop_back();
+        }
+        const Builtin* builtin = findBuiltin(expr.name);
+        if (builtin == nullptr) {
+            return fail(expr.line, "unknown function '" + expr.name + "'");
+        }
+        if (expr.args.size() != builtin->arity) {
+            return fail(expr.line, std::string(builtin->name) + " expects " + std::to_string(builtin->arity) +
+                                   (builtin->arity == 1 ? " argument" : " arguments"));
+        }
+        bool allInt = true;
+        for (STExprPtr& arg : expr.args) {
+            if (!check(*arg)) {
+                return false;
+            }
+            if (!isNumeric(arg->type)) {
+                return fail(arg->line, std::string(builtin->name) + " requires numeric arguments");
+            }
+            allInt = allInt && arg->type == STType::INT;
+        }
+        OpCode op = builtin->intOp;
+        if (!allInt || op == OpCode::HALT) {
+            op = builtin->realOp;
+            if (op == OpCode::HALT) {
+                return fail(expr.line, std::string(builtin->name) + " requires INT arguments");
+            }
+            for (STExprPtr& arg : expr.args) {
+                promote(arg, STType::REAL);
+            }
+        }
+        expr.type = resultType(op);
+        return true;
+    }
+
+    // Reserve registers up to reg
+    bool useRegister(int reg, int line) {
+        if (reg >= static_cast<int>(STVirtualMachine::REGISTER_COUNT)) {
+            return fail(line, "expression too deeply nested");
+        }
+        if (static_cast<std::size_t>(reg + 1) > program.registerCount) {
+            program.registerCount = static_cast<std::size_t>(reg + 1);
+        }
+        return true;
+    }
+
+    // Emit a checked expression into r[reg], using registers above reg as scratch
+    bool emitExpr(const STExpr& expr, int reg) {
+        if (!useRegister(reg, expr.line)) {
+            return false;
+        }
+        switch (expr.kind) {
+            case ExprKind::LITERAL:
+                emit(OpCode::LOAD_CONST, reg, 0, 0, expr.value.i);
+                return true;
+            case ExprKind::VARIABLE: {
+                VarRef ref;
+                lookup(expr.name, ref);
+                load(ref, reg);
+                return true;
+            }
+            case ExprKind::INDEX: {
+                bool fixed = false;
+                std::int32_t operand = 0;
+                if (!emitElement(expr.name, *expr.lhs, reg, fixed, operand)) {
+                    return false;
+                }
+                emit(fixed ? OpCode::LOAD_LOCAL : OpCode::LOAD_LOCAL_INDEXED, reg, reg, 0, operand);
+                return true;
+            }
+            case ExprKind::UNARY:
+                if (!emitExpr(*expr.lhs, reg)) {
+                    return false;
+                }
+                emit(opcodeOf(expr), reg, reg, reg);
+                return true;
+            case ExprKind::BINARY:
+                if (!emitExpr(*expr.lhs, reg) || !emitExpr(*expr.rhs, reg + 1)) {
+                    return false;
+                }
+                emit(opcodeOf(expr), reg, reg, reg + 1);
+                return true;
+            case ExprKind::CALL:
+                for (std::size_t a = 0; a < expr.args.size(); a++) {
+                    if (!emitExpr(*expr.args[a], reg + static_cast<int>(a))) {
+                        return false;
+                    }
+                }
+                emit(opcodeOf(expr), reg, reg, expr.args.size() > 1 ? reg + 1 : reg);
+                return true;
+        }
+        return false;
+    }
+
+    // Check, convert to the wanted type and emit into r[reg]
+    bool compileExpr(STExprPtr& expr, STType type, int reg) {
+        return check(*expr) && promote(expr, type) && emitExpr(*expr, reg);
+    }
+
+    bool compileCondition(STExprPtr& condition, const char* what) {
+        if (!check(*condition)) {
+            return false;
+        }
+        if (condition->type != STType::BOOL) {
+            return fail(condition->line, std::string(what) + " condition must be BOOL");
+        }
+        return true;
+    }
+
+    bool isConstant(const STExpr& expr, bool value) const {
+        return expr.kind == ExprKind::LITERAL && (expr.value.i != 0) == value;
+    }
+
+    std::int32_t here() const { return static_cast<std::int32_t>(program.code.size()); }
+
+    void patch(std::size_t at) { program.code[at].operand = here(); }
+
+    // Drop code emitted since mark (dead code that was compiled only to be
+    // checked), together with any EXIT/RETURN jumps recorded inside it
+    void discard(std::size_t mark) {
+        program.code.resize(mark);
+        auto drop = [mark](std::vector<std::size_t>& jumps) {
+            jumps.erase(std::remove_if(jumps.begin(), jumps.end(),
+                                       [mark](std::size_t at) { return at >= mark; }), jumps.end());
+        };
+        drop(returns);
+        if (!loopExits.empty()) {
+            drop(loopExits.back());
+        }
+    }
+
+    // Statements use r[reg] and above; enclosing FOR loops own the registers below
+    bool compileBlock(STBlock& block, int reg) {
+        for (STStmtPtr& stmt : block) {
+            if (!compileStatement(*stmt, reg)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool compileStatement(STStmt& stmt, int reg) {
+        switch (stmt.kind) {
+            case StmtKind::ASSIGN: return compileAssign(stmt, reg);
+            case StmtKind::IF: return compileIf(stmt, reg);
+            case StmtKind::FOR: return compileFor(stmt, reg);
+            case StmtKind::WHILE: return compileWhile(stmt, reg);
+            case StmtKind::REPEAT: return compileRepeat(stmt, reg);
+            case StmtKind::EXIT:
+                if (loopExits.empty()) {
+                    return fail(stmt.line, "EXIT outside of a loop");
+                }
+                loopExits.back().push_back(program.code.size());
+                emit(OpCode::JUMP);
+                return true;
+            case StmtKind::RETURN:
+                returns.push_back(program.code.size());
+                emit(OpCode::JUMP);
+                return true;
+        }
+        return false;
+    }
+
+    // Resolve an assignment target, creating it if needed, and mark it written
+    bool assignable(const std::string& name, STType type, int line, VarRef& ref) {
+        if (constants.count(name) != 0) {
+            return fail(line, "cannot assign to constant '" + name + "'");
+        }
+        if (!lookup(name, ref)) {
+            if (block != nullptr) {
+                return fail(line, "undeclared variable '" + name + "'");     // FBs declare everything
+            }
+            std::uint32_t symbol = declare(name, type);
+            ref = {false, symbol, program.symbols[symbol].type};
+        }
+        if (ref.local) {
+            return true;
+        }
+        STSymbol& variable = program.symbols[ref.index];
+        if (variable.address.area == PLCArea::INPUT) {
+            return fail(line, "cannot assign to input '" + name + "'");
+        }
+        variable.written = true;
+        return true;
+    }
+
+    void load(const VarRef& ref, int reg) {
+        if (ref.local) {
+            emit(OpCode::LOAD_LOCAL, reg, 0, 0, static_cast<std::int32_t>(block->variables[ref.index].offset));
+            return;
+        }
+        const STSymbol& variable = program.symbols[ref.index];
+        emit(loadOp(variable.address.area), reg, 0, 0, static_cast<std::int32_t>(variable.address.index));
+    }
+
+    void store(const VarRef& ref, int reg) {
+        if (ref.local) {
+            emit(OpCode::STORE_LOCAL, 0, reg, 0, static_cast<std::int32_t>(block->variables[ref.index].offset));
+            return;
+        }
+        const STSymbol& variable = program.symbols[ref.index];
+        emit(storeOp(variable.address.area), 0, reg, 0, static_cast<std::int32_t>(variable.address.index));
+    }
+
+    bool compileAssign(STStmt& stmt, int reg) {
+        if (stmt.index) {
+            STType type = STType::INT;
+            bool fixed = false;
+            std::int32_t operand = 0;
+            if (!checkIndex(stmt.target, *stmt.index, stmt.line, type) || !check(*stmt.value) ||
+                !promote(stmt.value, type) || !emitExpr(*stmt.value, reg) ||
+                !emitElement(stmt.target, *stmt.index, reg + 1, fixed, operand)) {
+                return false;
+            }
+            emit(fixed ? OpCode::STORE_LOCAL : OpCode::STORE_LOCAL_INDEXED, 0, reg, reg + 1, operand);
+            return true;
+        }
+        VarRef ref;
+        if (!check(*stmt.value) || !assignable(stmt.target, stmt.value->type, stmt.line, ref)) {
+            return false;
+        }
+        if (ref.local && block->variables[ref.index].array) {
+            return fail(stmt.line, "array '" + stmt.target + "' needs an index");
+        }
+        if (!promote(stmt.value, ref.type) || !emitExpr(*stmt.value, reg)) {
+            return false;
+        }
+        store(ref, reg);
+        return true;
+    }
+
+    // IF / ELSIF chain: each false condition jumps to the next branch, each
+    // taken branch jumps past the rest. Constant conditions drop dead branches.
+    bool compileIf(STStmt& stmt, int reg) {
+        std::vector<std::size_t> exits;
+        bool taken = false;         // a constant TRUE branch made the rest dead
+        for (std::size_t b = 0; b < stmt.branches.size(); b++) {
+            STBranch& branch = stmt.branches[b];
+            if (!compileCondition(branch.condition, "IF")) {
+                return false;
+            }
+            std::size_t mark = program.code.size();
+            bool dead = taken || isConstant(*branch.condition, false);
+            bool always = !dead && isConstant(*branch.condition, true);
+            std::size_t skip = 0;
+            if (!dead && !always) {
+                if (!emitExpr(*branch.condition, reg)) {
+                    return false;
+                }
+                skip = program.code.size();
+                emit(OpCode::JUMP_IF_FALSE, 0, reg);
+            }
+            if (!compileBlock(branch.body, reg)) {
+                return false;
+            }
+            if (dead) {
+                discard(mark);
+                continue;
+            }
+            if (always) {
+                taken = true;
+                continue;
+            }
+            if (b + 1 < stmt.branches.size() || !stmt.elseBody.empty()) {
+                exits.push_back(program.code.size());
+                emit(OpCode::JUMP);
+            }
+            patch(skip);
+        }
+        std::size_t mark = program.code.size();
+        if (!compileBlock(stmt.elseBody, reg)) {
+            return false;
+        }
+        if (taken) {
+            discard(mark);
+        }
+        for (std::size_t exit : exits) {
+            patch(exit);
+        }
+        return true;
+    }
+
+    // FOR i := start TO end BY step: end is evaluated once into r[reg] and the
+    // step must be a constant, which fixes the direction of the end test
+    bool compileFor(STStmt& stmt, int reg) {
+        VarRef control;
+        if (!assignable(stmt.target, STType::INT, stmt.line, control)) {
+            return false;
+        }
+        if (control.type != STType::INT || (control.local && block->variables[control.index].array)) {
+            return fail(stmt.line, "FOR control variable '" + stmt.target + "' must be INT");
+        }
+        if (!stmt.step) {
+            stmt.step = std::make_unique<STExpr>();
+            stmt.step->kind = ExprKind::LITERAL;
+            stmt.step->value.i = 1;
+        }
+        if (!check(*stmt.step) || !promote(stmt.step, STType::INT)) {
+            return false;
+        }
+        if (stmt.step->kind != ExprKind::LITERAL || stmt.step->value.i == 0) {
+            return fail(stmt.line, "FOR step must be a non-zero constant");
+        }
+        std::int32_t step = stmt.step->value.i;
+        if (!compileExpr(stmt.value, STType::INT, reg) || !useRegister(reg + 2, stmt.line)) {
+            return false;
+        }
+        store(control, reg);
+        if (!compileExpr(stmt.limit, STType::INT, reg)) {
+            return false;
+        }
+
+        std::int32_t loop = here();
+        load(control, reg + 1);
+        emit(step > 0 ? OpCode::LE_INT : OpCode::GE_INT, reg + 1, reg + 1, reg);
+        std::size_t exit = program.code.size();
+        emit(OpCode::JUMP_IF_FALSE, 0, reg + 1);
+
+        loopExits.emplace_back();
+        if (!compileBlock(stmt.body, reg + 1)) {
+            return false;
+        }
+        load(control, reg + 1);
+        emit(OpCode::LOAD_CONST, reg + 2, 0, 0, step);
+        emit(OpCode::ADD_INT, reg + 1, reg + 1, reg + 2);
+        store(control, reg + 1);
+        emit(OpCode::JUMP, 0, 0, 0, loop);
+        patch(exit);
+        closeLoop();
+        return true;
+    }
+
+    bool compileWhile(STStmt& stmt, int reg) {
+        if (!compileCondition(stmt.condition, "WHILE")) {
+            return false;
+        }
+        std::size_t mark = program.code.size();
+        std::int32_t loop = here();
+        std::size_t exit = 0;
+        bool always = isConstant(*stmt.condition, true);
+        if (!always) {
+            if (!emitExpr(*stmt.condition, reg)) {
+                return false;
+            }
+            exit = program.code.size();
+            emit(OpCode::JUMP_IF_FALSE, 0, reg);
+        }
+        loopExits.emplace_back();
+        if (!compileBlock(stmt.body, reg)) {
+            return false;
+        }
+        emit(OpCode::JUMP, 0, 0, 0, loop);
+        if (isConstant(*stmt.condition, false)) {
+            discard(mark);
+        } else if (!always) {
+            patch(exit);
+        }
+        closeLoop();
+        return true;
+    }
+
+    bool compileRepeat(STStmt& stmt, int reg) {
+        std::int32_t loop = here();
+        loopExits.emplace_back();
+        if (!compileBlock(stmt.body, reg) || !compileCondition(stmt.condition, "UNTIL")) {
+            return false;
+        }
+        if (!isConstant(*stmt.condition, true)) {
+            if (!emitExpr(*stmt.condition, reg)) {
+                return false;
+            }
+            emit(OpCode::JUMP_IF_FALSE, 0, reg, 0, loop);
+        }
+        closeLoop();
+        return true;
+    }
+
+    // SQRT elision. SQRT is monotonic, so comparing square roots orders the
+    // same way as comparing their arguments (up to rounding at near-ties).
+
+    static bool isLiteralTwo(const STExpr& expr) {
+        return expr.kind == ExprKind::LITERAL &&
+               (expr.type == STType::REAL ? expr.value.r == 2.0f : expr.value.i == 2);
+    }
+
+    static bool isNonNegativeLiteral(const STExpr& expr) {
+        return expr.kind == ExprKind::LITERAL && expr.type != STType::BOOL &&
+               (expr.type == STType::REAL ? expr.value.r >= 0.0f : expr.value.i >= 0);
+    }
+
+    static bool isSqrtCall(const STExpr& expr) {
+        const Builtin* builtin = expr.kind == ExprKind::CALL ? findBuiltin(expr.name) : nullptr;
+        return builtin != nullptr && builtin->realOp == OpCode::SQRT_REAL && expr.args.size() == 1;
+    }
+
+    // Conservative: squares, sums, products and quotients of non-negative terms
+    static bool nonNegative(const STExpr& expr) {
+        switch (expr.kind) {
+            case ExprKind::LITERAL:
+                return isNonNegativeLiteral(expr);
+            case ExprKind::CALL: {
+                const Builtin* builtin = findBuiltin(expr.name);
+                if (builtin == nullptr) {
+                    return false;
+                }
+                return builtin->realOp == OpCode::SQRT_REAL || builtin->realOp == OpCode::ABS_REAL ||
+                       builtin->realOp == OpCode::SQUARE_REAL ||
+                       (builtin->realOp == OpCode::EXPT_REAL && expr.args.size() == 2 && isLiteralTwo(*expr.args[1]));
+            }
+            case ExprKind::BINARY:
+                switch (expr.op) {
+                    case TokenKind::POWER: return isLiteralTwo(*expr.rhs);
+                    case TokenKind::PLUS:
+                    case TokenKind::STAR:
+                    case TokenKind::SLASH: return nonNegative(*expr.lhs) && nonNegative(*expr.rhs);
+                    default: return false;
+                }
+            default:
+                return false;
+        }
+    }
+
+    static STExprPtr squaredLiteral(const STExpr& literal) {
+        float value = literal.type == STType::REAL ? literal.value.r : static_cast<float>(literal.value.i);
+        STExprPtr squared = std::make_unique<STExpr>();
+        squared->kind = ExprKind::LITERAL;
+        squared->type = STType::REAL;
+        squared->value.r = value * value;
+        squared->line = literal.line;
+        return squared;
+    }
+
+    bool isCandidate(const std::unordered_map<std::string, bool>& candidates, const STExpr& expr) const {
+        auto it = expr.kind == ExprKind::VARIABLE ? candidates.find(expr.name) : candidates.end();
+        return it != candidates.end() && it->second;
+    }
+
+    // Drop candidates used other than as a compared operand; returns true if any was dropped
+    bool usesOutsideComparisons(std::unordered_map<std::string, bool>& candidates, const STExpr& expr) {
+        bool changed = false;
+        auto drop = [&](const STExpr& var) {
+            if (isCandidate(candidates, var)) {
+                candidates[var.name] = false;
+                changed = true;
+            }
+        };
+        if (expr.kind == ExprKind::BINARY && isComparison(expr.op)) {
+            const STExpr* sides[2] = {expr.lhs.get(), expr.rhs.get()};
+            for (int side = 0; side < 2; side++) {
+                const STExpr& operand = *sides[side];
+                const STExpr& other = *sides[1 - side];
+                if (isCandidate(candidates, operand)) {
+                    if (!isCandidate(candidates, other) && !isNonNegativeLiteral(other)) {
+                        drop(operand);
+                    }
+                } else {
+                    changed = usesOutsideComparisons(candidates, operand) || changed;
+                }
+            }
+            return changed;
+        }
+        drop(expr);
+        for (const STExpr* child : {expr.lhs.get(), expr.rhs.get()}) {
+            if (child != nullptr) {
+                changed = usesOutsideComparisons(candidates, *child) || changed;
+            }
+        }
+        for (const STExprPtr& arg : expr.args) {
+            changed = usesOutsideComparisons(candidates, *arg) || changed;
+        }
+        return changed;
+    }
+
+    bool screenBlock(std::unordered_map<std::string, bool>& candidates, const STBlock& block) {
+        bool changed = false;
+        for (const STStmtPtr& stmt : block) {
+            const STStmt& s = *stmt;
+            if (s.kind == StmtKind::ASSIGN) {
+                auto target = candidates.find(s.target);
+                bool toCandidate = !s.index && target != candidates.end() && target->second;
+                const STExpr& value = *s.value;
+                if (toCandidate && isSqrtCall(value) && nonNegative(*value.args[0])) {
+                    changed = usesOutsideComparisons(candidates, *value.args[0]) || changed;
+                } else if (toCandidate && (isNonNegativeLiteral(value) || isCandidate(candidates, value))) {
+                    // constant or copy between candidates
+                } else {
+                    if (toCandidate) {
+                        target->second = false;
+                        changed = true;
+                    }
+                    changed = usesOutsideComparisons(candidates, value) || changed;
+                }
+                if (s.index) {
+                    changed = usesOutsideComparisons(candidates, *s.index) || changed;
+                }
+                continue;
+            }
+            for (const STExpr* expr : {s.value.get(), s.limit.get(), s.step.get(), s.condition.get()}) {
+                if (expr != nullptr) {
+                    changed = usesOutsideComparisons(candidates, *expr) || changed;
+                }
+            }
+            for (const STBranch& branch : s.branches) {
+                changed = usesOutsideComparisons(candidates, *branch.condition) || changed;
+                changed = screenBlock(candidates, branch.body) || changed;
+            }
+            changed = screenBlock(candidates, s.elseBody) || changed;
+            changed = screenBlock(candidates, s.body) || changed;
+        }
+        return changed;
+    }
+
+    void squareComparisons(const std::unordered_map<std::string, bool>& candidates, STExpr& expr) {
+        if (expr.kind == ExprKind::BINARY && isComparison(expr.op)) {
+            if (isCandidate(candidates, *expr.lhs) && expr.rhs->kind == ExprKind::LITERAL) {
+                expr.rhs = squaredLiteral(*expr.rhs);
+            } else if (isCandidate(candidates, *expr.rhs) && expr.lhs->kind == ExprKind::LITERAL) {
+                expr.lhs = squaredLiteral(*expr.lhs);
+            }
+        }
+        for (STExpr* child : {expr.lhs.get(), expr.rhs.get()}) {
+            if (child != nullptr) {
+                squareComparisons(candidates, *child);
+            }
+        }
+        for (STExprPtr& arg : expr.args) {
+            squareComparisons(candidates, *arg);
+        }
+    }
+
+    void squareBlock(const std::unordered_map<std::string, bool>& candidates, STBlock& block) {
+        for (STStmtPtr& stmt : block) {
+            STStmt& s = *stmt;
+            auto target = candidates.find(s.target);
+            if (s.kind == StmtKind::ASSIGN && !s.index && target != candidates.end() && target->second) {
+                if (isSqrtCall(*s.value)) {
+                    STExprPtr argument = std::move(s.value->args[0]);
+                    s.value = std::move(argument);
+                } else if (s.value->kind == ExprKind::LITERAL) {
+                    s.value = squaredLiteral(*s.value);
+                }
+            }
+            for (STExpr* expr : {s.value.get(), s.limit.get(), s.step.get(), s.condition.get(), s.index.get()}) {
+                if (expr != nullptr) {
+                    squareComparisons(candidates, *expr);
+                }
+            }
+            for (STBranch& branch : s.branches) {
+                squareComparisons(candidates, *branch.condition);
+                squareBlock(candidates, branch.body);
+            }
+            squareBlock(candidates, s.elseBody);
+            squareBlock(candidates, s.body);
+        }
+    }
+
+    // Keep squared values in REAL temporaries that only hold SQRT(non-negative)
+    // or non-negative constants and are only compared with each other or with
+    // non-negative constants; their other uses could observe the difference
+    void elideSqrt(STFunctionBlockDecl& decl) {
+        std::unordered_map<std::string, bool> candidates;
+        for (const STVarDecl& var : decl.variables) {
+            if (var.section == VarSection::TEMP && var.type == STType::REAL && !var.array &&
+                (var.init.empty() || isNonNegativeLiteral(*var.init[0]))) {
+                candidates.emplace(var.name, true);
+            }
+        }
+        while (screenBlock(candidates, decl.body)) {
+        }
+        squareBlock(candidates, decl.body);
+        for (STVarDecl& var : decl.variables) {
+            auto it = candidates.find(var.name);
+            if (it != candidates.end() && it->second && !var.init.empty()) {
+                var.init[0] = squaredLiteral(*var.init[0]);
+            }
+        }
+    }
+
+    // Evaluate a declaration initializer, which must fold to a constant
+    bool constantValue(STExprPtr& value, STType type, STCell& cell) {
+        if (!check(*value) || !promote(value, type)) {
+            return false;
+        }
+        if (value->kind != ExprKind::LITERAL) {
+            return fail(value->line, "initial value must be constant");
+        }
+        cell = value->value;
+        return true;
+    }
+
+    // Give every non-constant variable its frame cells and initial values;
+    // constants are only recorded, in order, so later ones may use earlier ones
+    bool layoutFrame(STFunctionBlockDecl& decl) {
+        for (STVarDecl& var : decl.variables) {
+            if (locals.count(var.name) != 0 || constants.count(var.name) != 0) {
+                return fail(var.line, "duplicate variable '" + var.name + "'");
+            }
+            std::uint32_t length = var.array ? static_cast<std::uint32_t>(var.upper - var.lower + 1) : 1;
+            if (var.init.size() > length) {
+                return fail(var.line, "too many initial values for '" + var.name + "'");
+            }
+            if (var.section == VarSection::CONSTANT) {
+                if (var.array || var.init.empty()) {
+                    return fail(var.line, "constant '" + var.name + "' needs a single value");
+                }
+                Constant constant{var.type, {}};
+                if (!constantValue(var.init[0], var.type, constant.value)) {
+                    return false;
+                }
+                constants.emplace(var.name, constant);
+                continue;
+            }
+            std::uint32_t offset = static_cast<std::uint32_t>(block->initialFrame.size());
+            if (offset + length > 0xFFFF) {
+                return fail(var.line, "function block frame too large");
+            }
+            block->initialFrame.resize(offset + length, STCell{});
+            for (std::size_t i = 0; i < var.init.size(); i++) {
+                if (!constantValue(var.init[i], var.type, block->initialFrame[offset + i])) {
+                    return false;
+                }
+            }
+            locals.emplace(var.name, static_cast<std::uint32_t>(block->variables.size()));
+            block->variables.push_back({var.name, var.type, var.section, offset, length, var.lower, var.array});
+        }
+        return true;
+    }
+
+    // VAR_TEMP starts from its declared value on every call
+    bool initializeTemps() {
+        for (const STVariable& var : block->variables) {
+            if (var.section != VarSection::TEMP) {
+                continue;
+            }
+            if (!useRegister(0, 0)) {
+                return false;
+            }
+            for (std::uint32_t i = 0; i < var.length; i++) {
+                emit(OpCode::LOAD_CONST, 0, 0, 0, block->initialFrame[var.offset + i].i);
+                emit(OpCode::STORE_LOCAL, 0, 0, 0, static_cast<std::int32_t>(var.offset + i));
+            }
+        }
+        return true;
+    }
+
+    // Point the innermost loop's EXIT jumps here
+    void closeLoop() {
+        for (std::size_t exit : loopExits.back()) {
+            patch(exit);
+        }
+        loopExits.pop_back();
+    }
+
+    void reset(STFunctionBlock* functionBlock) {
+        program.clear();
+        symbols.clear();
+        loopExits.clear();
+        returns.clear();
+        errorMessage.clear();
+        block = functionBlock;
+        locals.clear();
+        constants.clear();
+    }
+
+public:
+    STCompiler(PLCMemory& mem, STProgram& target) : memory(mem), program(target) {}
+
+    // Parse and compile source into the target program (cleared first)
+    bool compile(std::string_view source) {
+        reset(nullptr);
+
+        STParser parser(source);
+        STBlock statements;
+        if (!parser.parseProgram(statements)) {
+            errorMessage = parser.error();
+            return false;
+        }
+        if (!compileBlock(statements, 0)) {
+            program.clear();
+            return false;
+        }
+        for (std::size_t exit : returns) {
+            patch(exit);
+        }
+        emit(OpCode::HALT);
+        return true;
+    }
+
+    // Parse and compile a FUNCTION_BLOCK source into block, whose program
+    // must be this compiler's target program
+    bool compileFunctionBlock(std::string_view source, STFunctionBlock& target) {
+        target.clear();
+        reset(&target);
+
+        STParser parser(source);
+        STFunctionBlockDecl decl;
+        if (!parser.parseFunctionBlock(decl)) {
+            errorMessage = parser.error();
+            return false;
+        }
+        target.name = decl.name;
+        if (squareDistances) {
+            elideSqrt(decl);
+        }
+        if (!layoutFrame(decl) || !initializeTemps() || !compileBlock(decl.body, 0)) {
+            target.clear();
+            return false;
+        }
+        for (std::size_t exit : returns) {
+            patch(exit);
+        }
+        emit(OpCode::HALT);
+        return true;
+    }
+
+    // Let compileFunctionBlock() drop SQRT from distances that are only compared
+    void setSquareDistances(bool enable) { squareDistances = enable; }
+
+    const std::string& error() const { return errorMessage; }
+};
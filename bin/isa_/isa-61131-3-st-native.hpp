@@ -0,0 +1,429 @@
+/**
+ * ISA-61131-3 Native Code for Compiled ST Programs
+ * Translates the bytecode of a compiled program or function block into a
+ * C++ function, builds it with the host compiler as a shared object and
+ * loads it with dlopen. Every instruction becomes a statement with its
+ * slot, frame offset or constant spelled out as a literal and every jump a
+ * goto, so the host compiler sees straight-line code it can keep in
+ * registers; there is no dispatch left.
+ *
+ * The generated source includes isa-61131-3-st-vm.hpp and computes each
+ * ALU operation with the same STVirtualMachine::apply<op>(), built without
+ * FP contraction or fast-math and with EXPT exponents kept opaque (the
+ * host compiler would otherwise specialize powf for constants), so results
+ * are bit-identical to the interpreter, which remains the reference. Built objects are cached by an
+ * FNV-1a checksum of the generated source, every header it includes (the
+ * VM, the instruction and cell types, the process image) and the compiler
+ * command, so a restart with unchanged programs only dlopens them and a
+ * changed header never loads an object built against the old layout.
+ * The cache lives in $ISA_ST_NATIVE_CACHE or a per-user directory under the
+ * system temp directory, and the compiler runs via fork/exec with an argv
+ * array, so no path ever passes through a shell.
+ * POSIX dlopen/fork/exec, C++17 <filesystem>.
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "isa-61131-3-process-image.hpp"
+#include "isa-61131-3-st-vm.hpp"
+
+// A program loaded from a shared object
+class STNativeProgram {
+public:
+    using ScanFunction = void (*)(const std::uint64_t* inputs, std::uint64_t* outputs, std::int32_t* integers,
+                                  float* reals, std::uint8_t* booleans, STCell* frame);
+
+private:
+    void* handle = nullptr;
+    ScanFunction function = nullptr;
+    bool cached = false;
+
+    friend class STNativeCompiler;
+
+public:
+    STNativeProgram() = default;
+    STNativeProgram(const STNativeProgram&) = delete;
+    STNativeProgram& operator=(const STNativeProgram&) = delete;
+    STNativeProgram(STNativeProgram&& other) noexcept
+        : handle(other.handle), function(other.function), cached(other.cached) {
+        other.handle = nullptr;
+        other.function = nullptr;
+    }
+    ~STNativeProgram() { unload(); }
+
+    void unload() {
+        if (handle != nullptr) {
+            ::dlclose(handle);
+        }
+        handle = nullptr;
+        function = nullptr;
+        cached = false;
+    }
+
+    bool loaded() const { return function != nullptr; }
+
+    // True when the shared object came from the cache rather than a build
+    bool fromCache() const { return cached; }
+
+    // Execute one pass, like STVirtualMachine::run
+    void run(ProcessImage& image, STCell* frame = nullptr) const {
+        function(image.inputs.data(), image.outputs.data(), image.integers.data(), image.reals.data(),
+                 image.booleans.data(), frame);
+    }
+};
+
+class STNativeCompiler {
+private:
+    std::string cacheDirectory;
+    std::string includeDirectory;
+    std::vector<std::string> compilerArguments;     // compiler and flags, without paths
+    std::string errorMessage;
+
+    static constexpr const char* ENTRY = "st_native_scan";
+
+    // Headers the generated source pulls in (st-vm.hpp and what it includes);
+    // all of them are part of the cache key
+    static constexpr const char* GENERATED_INCLUDES[] = {"isa-61131-3-st-vm.hpp", "isa-61131-3-st-parser.hpp",
+                                                         "isa-61131-3-process-image.hpp"};
+
+    static std::uint64_t fnv1a(const std::string& text, std::uint64_t hash = 14695981039346656037ull) {
+        for (unsigned char c : text) {
+            hash = (hash ^ c) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static std::string readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream text;
+        text << file.rdbuf();
+        return text.str();
+    }
+
+    // Where the generated source finds the VM: this header's directory as
+    // the build saw it (relative paths resolve against the working
+    // directory), else the directory of the executable
+    static std::string defaultIncludeDirectory() {
+        std::error_code error;
+        std::filesystem::path candidates[] = {
+            std::filesystem::absolute(std::filesystem::path(__FILE__), error).parent_path(),
+            std::filesystem::read_symlink("/proc/self/exe", error).parent_path()
+        };
+        for (const std::filesystem::path& directory : candidates) {
+            if (std::filesystem::exists(directory / "isa-61131-3-st-vm.hpp", error)) {
+                return directory.string();
+            }
+        }
+        return candidates[0].string();
+    }
+
+    static std::string defaultCacheDirectory() {
+        const char* configured = std::getenv("ISA_ST_NATIVE_CACHE");
+        if (configured != nullptr && *configured != '\0') {
+            return configured;
+        }
+        std::error_code error;
+        std::filesystem::path temp = std::filesystem::temp_directory_path(error);
+        if (error) {
+            temp = "/tmp";
+        }
+        return (temp / ("isa-st-native-" + std::to_string(::getuid()))).string();
+    }
+
+    // The cache holds code this process will dlopen: it must be ours and not
+    // writable by anyone else
+    bool prepareCacheDirectory() {
+        std::error_code error;
+        std::filesystem::create_directories(cacheDirectory, error);
+        struct stat info;
+        if (::stat(cacheDirectory.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+            return fail("cannot create cache directory " + cacheDirectory);
+        }
+        if (info.st_uid != ::getuid() || (info.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+            return fail("cache directory " + cacheDirectory + " is not private to this user");
+        }
+        return true;
+    }
+
+    // Run the compiler directly (no shell), stderr to logPath
+    bool runCompiler(const std::vector<std::string>& arguments, const std::string& logPath) {
+        std::vector<char*> argv;
+        for (const std::string& argument : arguments) {
+            argv.push_back(const_cast<char*>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+        int log = ::open(logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (log < 0) {
+            return fail("cannot write " + logPath);
+        }
+        pid_t child = ::fork();
+        if (child == 0) {
+            ::dup2(log, STDERR_FILENO);
+            ::execvp(argv[0], argv.data());
+            ::_exit(127);
+        }
+        ::close(log);
+        if (child < 0) {
+            return fail("cannot start the host compiler");
+        }
+        int status = 0;
+        while (::waitpid(child, &status, 0) < 0) {
+            if (errno != EINTR) {
+                return fail("lost the host compiler process");
+            }
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            return fail("host compiler failed, see " + logPath);
+        }
+        return true;
+    }
+
+    static const char* aluName(OpCode op) {
+        switch (op) {
+            case OpCode::ADD_INT: return "ADD_INT";
+            case OpCode::SUB_INT: return "SUB_INT";
+            case OpCode::MUL_INT: return "MUL_INT";
+            case OpCode::DIV_INT: return "DIV_INT";
+            case OpCode::MOD_INT: return "MOD_INT";
+            case OpCode::NEG_INT: return "NEG_INT";
+            case OpCode::ADD_REAL: return "ADD_REAL";
+            case OpCode::SUB_REAL: return "SUB_REAL";
+            case OpCode::MUL_REAL: return "MUL_REAL";
+            case OpCode::DIV_REAL: return "DIV_REAL";
+            case OpCode::NEG_REAL: return "NEG_REAL";
+            case OpCode::EQ_INT: return "EQ_INT";
+            case OpCode::NE_INT: return "NE_INT";
+            case OpCode::LT_INT: return "LT_INT";
+            case OpCode::LE_INT: return "LE_INT";
+            case OpCode::GT_INT: return "GT_INT";
+            case OpCode::GE_INT: return "GE_INT";
+            case OpCode::EQ_REAL: return "EQ_REAL";
+            case OpCode::NE_REAL: return "NE_REAL";
+            case OpCode::LT_REAL: return "LT_REAL";
+            case OpCode::LE_REAL: return "LE_REAL";
+            case OpCode::GT_REAL: return "GT_REAL";
+            case OpCode::GE_REAL: return "GE_REAL";
+            case OpCode::AND: return "AND";
+            case OpCode::OR: return "OR";
+            case OpCode::XOR: return "XOR";
+            case OpCode::NOT: return "NOT";
+            case OpCode::INT_TO_REAL: return "INT_TO_REAL";
+            case OpCode::REAL_TO_INT: return "REAL_TO_INT";
+            case OpCode::TRUNC_REAL: return "TRUNC_REAL";
+            case OpCode::ABS_INT: return "ABS_INT";
+            case OpCode::ABS_REAL: return "ABS_REAL";
+            case OpCode::MIN_INT: return "MIN_INT";
+            case OpCode::MAX_INT: return "MAX_INT";
+            case OpCode::MIN_REAL: return "MIN_REAL";
+            case OpCode::MAX_REAL: return "MAX_REAL";
+            case OpCode::SQRT_REAL: return "SQRT_REAL";
+            case OpCode::SQUARE_REAL: return "SQUARE_REAL";
+            case OpCode::EXPT_REAL: return "EXPT_REAL";
+            default: return nullptr;
+        }
+    }
+
+    static bool isUnary(OpCode op) {
+        switch (op) {
+            case OpCode::NEG_INT: case OpCode::NEG_REAL: case OpCode::NOT:
+            case OpCode::INT_TO_REAL: case OpCode::REAL_TO_INT: case OpCode::TRUNC_REAL:
+            case OpCode::ABS_INT: case OpCode::ABS_REAL: case OpCode::SQRT_REAL: case OpCode::SQUARE_REAL:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool fail(const std::string& message) {
+        errorMessage = message;
+        return false;
+    }
+
+    bool load(const std::string& path, STNativeProgram& target) {
+        target.unload();
+        target.handle = ::dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (target.handle == nullptr) {
+            return fail(std::string("dlopen failed: ") + ::dlerror());
+        }
+        target.function = reinterpret_cast<STNativeProgram::ScanFunction>(::dlsym(target.handle, ENTRY));
+        if (target.function == nullptr) {
+            target.unload();
+            return fail(path + " has no " + ENTRY);
+        }
+        return true;
+    }
+
+public:
+    // Shared objects are kept in cacheDir (default: $ISA_ST_NATIVE_CACHE or a
+    // per-user temp directory); the host compiler is $CXX, split on spaces, or c++
+    explicit STNativeCompiler(const std::string& cacheDir = "")
+        : cacheDirectory(cacheDir.empty() ? defaultCacheDirectory() : cacheDir),
+          includeDirectory(defaultIncludeDirectory()) {
+        const char* cxx = std::getenv("CXX");
+        std::istringstream words(cxx != nullptr && *cxx != '\0' ? cxx : "c++");
+        for (std::string word; words >> word;) {
+            compilerArguments.push_back(word);
+        }
+        for (const char* flag : {"-std=c++17", "-O2", "-ffp-contract=off", "-fno-fast-math", "-fPIC", "-shared"}) {
+            compilerArguments.push_back(flag);
+        }
+    }
+
+    // Where the generated source finds isa-61131-3-st-vm.hpp
+    void setIncludeDirectory(const std::string& directory) { includeDirectory = directory; }
+
+    const std::string& error() const { return errorMessage; }
+
+    // C++ source of one program as an extern "C" scan function
+    static std::string translate(const STProgram& program) {
+        std::vector<bool> target(program.code.size() + 1, false);
+        for (const Instruction& in : program.code) {
+            if (in.op == OpCode::JUMP || in.op == OpCode::JUMP_IF_FALSE) {
+                target[static_cast<std::size_t>(in.operand)] = true;
+            }
+        }
+
+        std::ostringstream out;
+        out << "// Generated from ST bytecode by isa-61131-3-st-native.hpp; do not edit\n"
+            << "#include \"isa-61131-3-st-vm.hpp\"\n\n"
+            << "extern \"C\" void " << ENTRY << "(const std::uint64_t* inputs, std::uint64_t* outputs, "
+            << "std::int32_t* integers, float* reals, std::uint8_t* booleans, STCell* frame) {\n"
+            << "    (void)inputs; (void)outputs; (void)integers; (void)reals; (void)booleans; (void)frame;\n"
+            << "    STCell r[" << (program.registerCount > 0 ? program.registerCount : 1) << "];\n";
+        for (std::size_t pc = 0; pc < program.code.size(); pc++) {
+            const Instruction& in = program.code[pc];
+            if (target[pc]) {
+                out << "L" << pc << ":\n";
+            }
+            std::string d = "r[" + std::to_string(in.dst) + "]";
+            std::string a = "r[" + std::to_string(in.lhs) + "]";
+            std::string b = "r[" + std::to_string(in.rhs) + "]";
+            std::uint32_t operand = static_cast<std::uint32_t>(in.operand);
+            std::string word = std::to_string(operand >> 6);
+            std::string bit = std::to_string(operand & 63);
+            std::string offset = std::to_string(operand & 0xFFFF);
+            std::string length = std::to_string(operand >> 16);
+            out << "    ";
+            switch (in.op) {
+                case OpCode::LOAD_CONST:
+                    out << d << ".i = static_cast<std::int32_t>(" << operand << "u);";
+                    break;
+                case OpCode::LOAD_INPUT:
+                    out << d << ".i = static_cast<std::int32_t>((inputs[" << word << "] >> " << bit << ") & 1);";
+                    break;
+                case OpCode::LOAD_OUTPUT:
+                    out << d << ".i = static_cast<std::int32_t>((outputs[" << word << "] >> " << bit << ") & 1);";
+                    break;
+                case OpCode::STORE_OUTPUT:
+                    out << "outputs[" << word << "] = (outputs[" << word << "] & ~(std::uint64_t(1) << " << bit
+                        << ")) | (-static_cast<std::uint64_t>(" << a << ".i & 1) & (std::uint64_t(1) << "
+                        << bit << "));";
+                    break;
+                case OpCode::LOAD_INT: out << d << ".i = integers[" << operand << "];"; break;
+                case OpCode::STORE_INT: out << "integers[" << operand << "] = " << a << ".i;"; break;
+                case OpCode::LOAD_REAL: out << d << ".r = reals[" << operand << "];"; break;
+                case OpCode::STORE_REAL: out << "reals[" << operand << "] = " << a << ".r;"; break;
+                case OpCode::LOAD_BOOL: out << d << ".i = booleans[" << operand << "];"; break;
+                case OpCode::STORE_BOOL:
+                    out << "booleans[" << operand << "] = static_cast<std::uint8_t>(" << a << ".i);";
+                    break;
+                case OpCode::LOAD_LOCAL: out << d << " = frame[" << operand << "];"; break;
+                case OpCode::STORE_LOCAL: out << "frame[" << operand << "] = " << a << ";"; break;
+                case OpCode::LOAD_LOCAL_INDEXED:
+                    out << "{ std::uint32_t e = static_cast<std::uint32_t>(" << a << ".i); " << d << ".i = 0; "
+                        << "if (e < " << length << "u) " << d << " = frame[" << offset << " + e]; }";
+                    break;
+                case OpCode::STORE_LOCAL_INDEXED:
+                    out << "{ std::uint32_t e = static_cast<std::uint32_t>(" << b << ".i); "
+                        << "if (e < " << length << "u) frame[" << offset << " + e] = " << a << "; }";
+                    break;
+                case OpCode::JUMP: out << "goto L" << operand << ";"; break;
+                case OpCode::JUMP_IF_FALSE: out << "if (" << a << ".i == 0) goto L" << operand << ";"; break;
+                case OpCode::HALT: out << "return;"; break;
+                case OpCode::EXPT_REAL:
+                    // Hide the exponent from constant propagation: GCC turns
+                    // powf(x, 2) into x * x, which is not what powf returns
+                    out << "{ volatile float e = " << b << ".r; STCell y; y.r = e; " << d
+                        << " = STVirtualMachine::apply<OpCode::EXPT_REAL>(" << a << ", y); }";
+                    break;
+                default:
+                    out << d << " = STVirtualMachine::apply<OpCode::" << aluName(in.op) << ">(" << a << ", "
+                        << (isUnary(in.op) ? a : b) << ");";
+                    break;
+            }
+            out << "\n";
+        }
+        if (target[program.code.size()]) {
+            out << "L" << program.code.size() << ":;\n";
+        }
+        out << "}\n";
+        return out.str();
+    }
+
+    // Translate, build (or find in the cache) and load a compiled program
+    bool compile(const STProgram& program, STNativeProgram& target) {
+        errorMessage.clear();
+        std::string source = translate(program);
+        std::uint64_t key = fnv1a(source);
+        for (const char* header : GENERATED_INCLUDES) {
+            std::string text = readFile(includeDirectory + "/" + header);
+            if (text.empty()) {
+                return fail(std::string("cannot read ") + header + " in " + includeDirectory);
+            }
+            key = fnv1a(text, key);
+        }
+        for (const std::string& argument : compilerArguments) {
+            key = fnv1a(argument + " ", key);
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), "st-%016llx", static_cast<unsigned long long>(key));
+        std::string base = cacheDirectory + "/" + name;
+
+        if (!prepareCacheDirectory()) {
+            return false;
+        }
+        std::error_code error;
+        if (std::filesystem::exists(base + ".so", error)) {
+            bool loaded = load(base + ".so", target);
+            target.cached = loaded;
+            return loaded;
+        }
+        std::ofstream file(base + ".cpp", std::ios::binary | std::ios::trunc);
+        file << source;
+        file.close();
+        if (!file) {
+            return fail("cannot write " + base + ".cpp");
+        }
+
+        // Build under a private name and rename, so a concurrent or
+        // interrupted build never leaves a partial object in the cache
+        std::string temporary = base + "." + std::to_string(::getpid()) + ".tmp";
+        std::vector<std::string> arguments = compilerArguments;
+        arguments.insert(arguments.end(), {"-I", includeDirectory, "-o", temporary, base + ".cpp"});
+        if (!runCompiler(arguments, base + ".log")) {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+        std::filesystem::rename(temporary, base + ".so", error);
+        if (error) {
+            return fail("cannot store " + base + ".so: " + error.message());
+        }
+        return load(base + ".so", target);
+    }
+};
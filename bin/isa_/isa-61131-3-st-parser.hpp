@@ -0,0 +1,938 @@
+/**
+ * ISA-61131-3 Structured Text Front End
+ * Lexer, abstract syntax tree and recursive-descent parser for the ST subset
+ * used by the simulator: assignments, IF/ELSIF/ELSE, FOR, WHILE, REPEAT,
+ * EXIT and RETURN, and typed expressions over BOOL, INT and REAL including
+ * function calls such as SQRT(x) and the ** operator. parseFunctionBlock()
+ * also reads FUNCTION_BLOCK sources (as written in SCL): VAR_INPUT,
+ * VAR_OUTPUT, VAR_IN_OUT, VAR_TEMP, VAR and VAR CONSTANT sections, ARRAY
+ * declarations with initializer lists, an optional BEGIN and a[i] indexing.
+ * Keywords are case-insensitive; identifiers keep their case, and direct
+ * addresses such as I0.0 / Q0.1 lex as identifiers.
+ *
+ * The parser reports the first error with its line number instead of
+ * throwing; the result is only valid when ok() is true.
+ */
+
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class STType : std::uint8_t { BOOL, INT, REAL };
+
+inline const char* typeToString(STType type) {
+    switch (type) {
+        case STType::BOOL: return "BOOL";
+        case STType::INT: return "INT";
+        case STType::REAL: return "REAL";
+    }
+    return "UNKNOWN";
+}
+
+// One 32-bit value: BOOL and INT use i (BOOL is 0/1), REAL uses r
+union STCell {
+    std::int32_t i;
+    float r;
+};
+
+enum class TokenKind : std::uint8_t {
+    END_OF_FILE, IDENTIFIER, INT_LITERAL, REAL_LITERAL,
+    // Punctuation and operators
+    ASSIGN, SEMICOLON, LPAREN, RPAREN, COMMA,
+    COLON, RANGE, LBRACKET, RBRACKET,
+    PLUS, MINUS, STAR, SLASH, POWER,
+    EQ, NE, LT, LE, GT, GE,
+    // Keywords
+    KW_IF, KW_THEN, KW_ELSIF, KW_ELSE, KW_END_IF,
+    KW_FOR, KW_TO, KW_BY, KW_DO, KW_END_FOR,
+    KW_WHILE, KW_END_WHILE, KW_REPEAT, KW_UNTIL, KW_END_REPEAT,
+    KW_EXIT, KW_RETURN,
+    KW_FUNCTION_BLOCK, KW_END_FUNCTION_BLOCK, KW_BEGIN,
+    KW_VAR_INPUT, KW_VAR_OUTPUT, KW_VAR_IN_OUT, KW_VAR_TEMP, KW_VAR, KW_CONSTANT, KW_END_VAR,
+    KW_ARRAY, KW_OF,
+    KW_AND, KW_OR, KW_XOR, KW_NOT, KW_MOD,
+    KW_TRUE, KW_FALSE,
+    INVALID
+};
+
+struct Token {
+    TokenKind kind = TokenKind::END_OF_FILE;
+    std::string_view text;
+    int line = 0;
+};
+
+class STLexer {
+private:
+    std::string_view source;
+    std::size_t pos = 0;
+    int line = 1;
+
+    struct Keyword {
+        const char* text;
+        TokenKind kind;
+    };
+
+    static TokenKind keywordKind(std::string_view word) {
+        static const Keyword keywords[] = {
+            {"IF", TokenKind::KW_IF}, {"THEN", TokenKind::KW_THEN},
+            {"ELSIF", TokenKind::KW_ELSIF}, {"ELSE", TokenKind::KW_ELSE},
+            {"END_IF", TokenKind::KW_END_IF},
+            {"FOR", TokenKind::KW_FOR}, {"TO", TokenKind::KW_TO},
+            {"BY", TokenKind::KW_BY}, {"DO", TokenKind::KW_DO},
+            {"END_FOR", TokenKind::KW_END_FOR},
+            {"WHILE", TokenKind::KW_WHILE}, {"END_WHILE", TokenKind::KW_END_WHILE},
+            {"REPEAT", TokenKind::KW_REPEAT}, {"UNTIL", TokenKind::KW_UNTIL},
+            {"END_REPEAT", TokenKind::KW_END_REPEAT},
+            {"EXIT", TokenKind::KW_EXIT}, {"RETURN", TokenKind::KW_RETURN},
+            {"FUNCTION_BLOCK", TokenKind::KW_FUNCTION_BLOCK},
+            {"END_FUNCTION_BLOCK", TokenKind::KW_END_FUNCTION_BLOCK},
+            {"BEGIN", TokenKind::KW_BEGIN},
+            {"VAR_INPUT", TokenKind::KW_VAR_INPUT}, {"VAR_OUTPUT", TokenKind::KW_VAR_OUTPUT},
+            {"VAR_IN_OUT", TokenKind::KW_VAR_IN_OUT}, {"VAR_TEMP", TokenKind::KW_VAR_TEMP},
+            {"VAR", TokenKind::KW_VAR}, {"CONSTANT", TokenKind::KW_CONSTANT},
+            {"END_VAR", TokenKind::KW_END_VAR},
+            {"ARRAY", TokenKind::KW_ARRAY}, {"OF", TokenKind::KW_OF},
+            {"AND", TokenKind::KW_AND}, {"OR", TokenKind::KW_OR},
+            {"XOR", TokenKind::KW_XOR}, {"NOT", TokenKind::KW_NOT},
+            {"MOD", TokenKind::KW_MOD},
+            {"TRUE", TokenKind::KW_TRUE}, {"FALSE", TokenKind::KW_FALSE},
+        };
+        for (const Keyword& keyword : keywords) {
+            std::string_view text(keyword.text);
+            if (text.size() != word.size()) {
+                continue;
+            }
+            bool match = true;
+            for (std::size_t i = 0; i < word.size() && match; i++) {
+                match = std::toupper(static_cast<unsigned char>(word[i])) == text[i];
+            }
+            if (match) {
+                return keyword.kind;
+            }
+        }
+        return TokenKind::IDENTIFIER;
+    }
+
+    char peekChar(std::size_t ahead = 0) const {
+        return pos + ahead < source.size() ? source[pos + ahead] : '\0';
+    }
+
+    static bool isIdentStart(char c) {
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    static bool isIdentChar(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    static bool isDigit(char c) {
+        return std::isdigit(static_cast<unsigned char>(c)) != 0;
+    }
+
+    // Skip whitespace and // , (* *) and /* */ comments
+    void skipTrivia() {
+        for (;;) {
+            char c = peekChar();
+            if (c == '\n') {
+                line++;
+                pos++;
+            } else if (std::isspace(static_cast<unsigned char>(c))) {
+                pos++;
+            } else if (c == '/' && peekChar(1) == '/') {
+                while (pos < source.size() && source[pos] != '\n') {
+                    pos++;
+                }
+            } else if ((c == '(' || c == '/') && peekChar(1) == '*') {
+                char close = (c == '(') ? ')' : '/';
+                pos += 2;
+                while (pos < source.size() && !(source[pos] == '*' && peekChar(1) == close)) {
+                    line += source[pos] == '\n';
+                    pos++;
+                }
+                pos = pos < source.size() ? pos + 2 : pos;
+            } else {
+                return;
+            }
+        }
+    }
+
+    // Direct addresses such as I0.0 or Q12.7: a letter, digits, '.', digits
+    bool isDirectAddress(std::size_t start) const {
+        std::size_t length = pos - start;
+        if (length < 2 || peekChar() != '.' || !isDigit(peekChar(1))) {
+            return false;
+        }
+        char area = static_cast<char>(std::toupper(static_cast<unsigned char>(source[start])));
+        if (area != 'I' && area != 'Q' && area != 'M') {
+            return false;
+        }
+        for (std::size_t i = start + 1; i < pos; i++) {
+            if (!isDigit(source[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    explicit STLexer(std::string_view text) : source(text) {}
+
+    Token next() {
+        skipTrivia();
+        Token token;
+        token.line = line;
+        std::size_t start = pos;
+        if (pos >= source.size()) {
+            token.kind = TokenKind::END_OF_FILE;
+            return token;
+        }
+
+        char c = source[pos];
+        if (isIdentStart(c)) {
+            while (isIdentChar(peekChar())) {
+                pos++;
+            }
+            if (isDirectAddress(start)) {
+                pos++;
+                while (isDigit(peekChar())) {
+                    pos++;
+                }
+                token.kind = TokenKind::IDENTIFIER;
+            } else {
+                token.kind = keywordKind(source.substr(start, pos - start));
+            }
+        } else if (isDigit(c)) {
+            while (isDigit(peekChar()) || peekChar() == '_') {
+                pos++;
+            }
+            token.kind = TokenKind::INT_LITERAL;
+            if (peekChar() == '.' && isDigit(peekChar(1))) {
+                pos++;
+                while (isDigit(peekChar())) {
+                    pos++;
+                }
+                token.kind = TokenKind::REAL_LITERAL;
+            }
+            if ((peekChar() == 'E' || peekChar() == 'e') &&
+                (isDigit(peekChar(1)) || ((peekChar(1) == '+' || peekChar(1) == '-') && isDigit(peekChar(2))))) {
+                pos += 2;
+                while (isDigit(peekChar())) {
+                    pos++;
+                }
+                token.kind = TokenKind::REAL_LITERAL;
+            }
+        } else {
+            pos++;
+            switch (c) {
+                case ';': token.kind = TokenKind::SEMICOLON; break;
+                case '(': token.kind = TokenKind::LPAREN; break;
+                case ')': token.kind = TokenKind::RPAREN; break;
+                case ',': token.kind = TokenKind::COMMA; break;
+                case '[': token.kind = TokenKind::LBRACKET; break;
+                case ']': token.kind = TokenKind::RBRACKET; break;
+                case '.':
+                    token.kind = TokenKind::INVALID;
+                    if (peekChar() == '.') {
+                        pos++;
+                        token.kind = TokenKind::RANGE;
+                    }
+                    break;
+                case '+': token.kind = TokenKind::PLUS; break;
+                case '-': token.kind = TokenKind::MINUS; break;
+                case '&': token.kind = TokenKind::KW_AND; break;
+                case '*':
+                    token.kind = TokenKind::STAR;
+                    if (peekChar() == '*') {
+                        pos++;
+                        token.kind = TokenKind::POWER;
+                    }
+                    break;
+                case '/': token.kind = TokenKind::SLASH; break;
+                case '=': token.kind = TokenKind::EQ; break;
+                case ':':
+                    token.kind = TokenKind::COLON;
+                    if (peekChar() == '=') {
+                        pos++;
+                        token.kind = TokenKind::ASSIGN;
+                    }
+                    break;
+                case '<':
+                    token.kind = TokenKind::LT;
+                    if (peekChar() == '=') {
+                        pos++;
+                        token.kind = TokenKind::LE;
+                    } else if (peekChar() == '>') {
+                        pos++;
+                        token.kind = TokenKind::NE;
+                    }
+                    break;
+                case '>':
+                    token.kind = TokenKind::GT;
+                    if (peekChar() == '=') {
+                        pos++;
+                        token.kind = TokenKind::GE;
+                    }
+                    break;
+                default: token.kind = TokenKind::INVALID; break;
+            }
+        }
+        token.text = source.substr(start, pos - start);
+        return token;
+    }
+};
+
+// Abstract syntax tree
+
+enum class ExprKind : std::uint8_t { LITERAL, VARIABLE, UNARY, BINARY, CALL, INDEX };
+
+struct STExpr {
+    ExprKind kind;
+    TokenKind op = TokenKind::INVALID;      // UNARY / BINARY operator
+    STType type = STType::INT;              // literal type; result type after compilation
+    STCell value{};                         // LITERAL
+    std::string name;                       // VARIABLE, CALL function name, INDEX array
+    std::unique_ptr<STExpr> lhs;            // UNARY operand, BINARY left, INDEX subscript
+    std::unique_ptr<STExpr> rhs;
+    std::vector<std::unique_ptr<STExpr>> args;  // CALL
+    int line = 0;
+};
+
+using STExprPtr = std::unique_ptr<STExpr>;
+
+inline STExprPtr cloneExpr(const STExpr& expr) {
+    STExprPtr copy = std::make_unique<STExpr>();
+    copy->kind = expr.kind;
+    copy->op = expr.op;
+    copy->type = expr.type;
+    copy->value = expr.value;
+    copy->name = expr.name;
+    copy->lhs = expr.lhs ? cloneExpr(*expr.lhs) : nullptr;
+    copy->rhs = expr.rhs ? cloneExpr(*expr.rhs) : nullptr;
+    for (const STExprPtr& arg : expr.args) {
+        copy->args.push_back(cloneExpr(*arg));
+    }
+    copy->line = expr.line;
+    return copy;
+}
+
+enum class StmtKind : std::uint8_t { ASSIGN, IF, FOR, WHILE, REPEAT, EXIT, RETURN };
+
+struct STStmt;
+using STStmtPtr = std::unique_ptr<STStmt>;
+using STBlock = std::vector<STStmtPtr>;
+
+struct STBranch {
+    STExprPtr condition;
+    STBlock body;
+};
+
+struct STStmt {
+    StmtKind kind;
+    int line = 0;
+    std::string target;                     // ASSIGN, FOR control variable
+    STExprPtr index;                        // ASSIGN to target[index]
+    STExprPtr value;                        // ASSIGN, FOR start value
+    std::vector<STBranch> branches;         // IF / ELSIF
+    STBlock elseBody;                       // ELSE
+    STExprPtr limit;                        // FOR end value
+    STExprPtr step;                         // FOR BY (null means 1)
+    STExprPtr condition;                    // WHILE, REPEAT UNTIL
+    STBlock body;                           // FOR / WHILE / REPEAT
+};
+
+// FUNCTION_BLOCK declarations
+
+enum class VarSection : std::uint8_t { INPUT, OUTPUT, IN_OUT, TEMP, STATIC, CONSTANT };
+
+struct STVarDecl {
+    std::string name;
+    STType type = STType::INT;
+    VarSection section = VarSection::STATIC;
+    bool array = false;
+    std::int32_t lower = 0;                 // ARRAY[lower..upper]
+    std::int32_t upper = 0;
+    std::vector<STExprPtr> init;            // one value, or the array initializer list
+    int line = 0;
+};
+
+struct STFunctionBlockDecl {
+    std::string name;
+    std::vector<STVarDecl> variables;
+    STBlock body;
+};
+
+class STParser {
+private:
+    // Recursive descent depth limit: deep nesting fails instead of overflowing the stack
+    static constexpr int MAX_NESTING = 256;
+
+    STLexer lexer;
+    Token current;
+    std::string errorMessage;
+    int nesting = 0;            // expressions
+    int blockNesting = 0;       // statement blocks
+
+    struct NestingGuard {
+        int& depth;
+        explicit NestingGuard(int& counter) : depth(counter) { depth++; }
+        ~NestingGuard() { depth--; }
+    };
+
+    void advance() { current = lexer.next(); }
+
+    bool fail(const std::string& message) {
+        if (errorMessage.empty()) {
+            errorMessage = "line " + std::to_string(current.line) + ": " + message;
+        }
+        current.kind = TokenKind::END_OF_FILE;   // stop parsing
+        return false;
+    }
+
+    bool expect(TokenKind kind, const char* what) {
+        if (current.kind != kind) {
+            return fail(std::string("expected ") + what + " but found '" + std::string(current.text) + "'");
+        }
+        advance();
+        return true;
+    }
+
+    STExprPtr makeExpr(ExprKind kind) {
+        STExprPtr expr = std::make_unique<STExpr>();
+        expr->kind = kind;
+        expr->line = current.line;
+        return expr;
+    }
+
+    STExprPtr makeBinary(TokenKind op, STExprPtr lhs, STExprPtr rhs) {
+        STExprPtr expr = makeExpr(ExprKind::BINARY);
+        expr->op = op;
+        expr->line = lhs->line;
+        expr->lhs = std::move(lhs);
+        expr->rhs = std::move(rhs);
+        return expr;
+    }
+
+    // Precedence, lowest first: OR, XOR, AND, equality, relational, additive,
+    // multiplicative, unary, **
+    STExprPtr parseExpression() {
+        NestingGuard guard(nesting);
+        if (nesting > MAX_NESTING) {
+            fail("expression too deeply nested");
+            return nullptr;
+        }
+        STExprPtr lhs = parseXor();
+        while (lhs && current.kind == TokenKind::KW_OR) {
+            advance();
+            STExprPtr rhs = parseXor();
+            lhs = rhs ? makeBinary(TokenKind::KW_OR, std::move(lhs), std::move(rhs)) : nullptr;
+        }
+        return lhs;
+    }
+
+    STExprPtr parseXor() {
+        STExprPtr lhs = parseAnd();
+        while (lhs && current.kind == TokenKind::KW_XOR) {
+            advance();
+            STExprPtr rhs = parseAnd();
+            lhs = rhs ? makeBinary(TokenKind::KW_XOR, std::move(lhs), std::move(rhs)) : nullptr;
+        }
+        return lhs;
+    }
+
+    STExprPtr parseAnd() {
+        STExprPtr lhs = parseEquality();
+        while (lhs && current.kind == TokenKind::KW_AND) {
+            advance();
+            STExprPtr rhs = parseEquality();
+            lhs = rhs ? makeBinary(TokenKind::KW_AND, std::move(lhs), std::move(rhs)) : nullptr;
+        }
+        return lhs;
+    }
+
+    STExprPtr parseEquality() {
+        STExprPtr lhs = parseRelational();
+        while (lhs && (current.kind == TokenKind::EQ || current.kind == TokenKind::NE)) {
+            TokenKind op = current.kind;
+            advance();
+            STExprPtr rhs = parseRelational();
+            lhs = rhs ? makeBinary(op, std::move(lhs), std::move(rhs)) : nullptr;
+        }
+        return lhs;
+    }
+
+    static bool isRelational(TokenKind kind) {
+        return kind == TokenKind::LT || kind == TokenKind::LE || kind == TokenKind::GT || kind == TokenKind::GE;
+    }
+
+    STExprPtr parseRelational() {
+        STExprPtr lhs = parseAdditive();
+        while (lhs && isRelational(current.kind)) {
+            TokenKind op = current.kind;
+            advance();
+            STExprPtr rhs = parseAdditive();
+            lhs = rhs ? makeBinary(op, std::move(lhs), std::move(rhs)) : nullptr;
+        }
+        return lhs;
+    }
+
+    STExprPtr parseAdditive() {
+        STExprPtr lhs = parseMultiplicative();
+        while (lhs && (current.kind == TokenKind::PLUS || current.kind == TokenKind::MINUS)) {
+            TokenKind op = current.kind;
+            advance();
+            STExprPtr rhs = parseMultiplicative();
+            lhs = rhs ? makeBinary(op, std::move(lhs), std::move(rhs)) : nullptr;
+        }
+        return lhs;
+    }
+
+    STExprPtr parseMultiplicative() {
+        STExprPtr lhs = parseUnary();
+        while (lhs && (current.kind == TokenKind::STAR || current.kind == TokenKind::SLASH ||
+                       current.kind == TokenKind::KW_MOD)) {
+            TokenKind op = current.kind;
+            advance();
+            STExprPtr rhs = parseUnary();
+            lhs = rhs ? makeBinary(op, std::move(lhs), std::move(rhs)) : nullptr;
+        }
+        return lhs;
+    }
+
+    STExprPtr parseUnary() {
+        if (current.kind == TokenKind::MINUS || current.kind == TokenKind::KW_NOT ||
+            current.kind == TokenKind::PLUS) {
+            NestingGuard guard(nesting);
+            if (nesting > MAX_NESTING) {
+                fail("expression too deeply nested");
+                return nullptr;
+            }
+            TokenKind op = current.kind;
+            STExprPtr expr = makeExpr(ExprKind::UNARY);
+            advance();
+            STExprPtr operand = parseUnary();
+            if (!operand) {
+                return nullptr;
+            }
+            if (op == TokenKind::PLUS) {
+                return operand;
+            }
+            expr->op = op;
+            expr->lhs = std::move(operand);
+            return expr;
+        }
+        return parsePower();
+    }
+
+    // ** is left-associative and binds tighter than unary minus: -2**2 = -4
+    STExprPtr parsePower() {
+        STExprPtr lhs = parsePrimary();
+        while (lhs && current.kind == TokenKind::POWER) {
+            advance();
+            STExprPtr rhs = parsePrimary();
+            lhs = rhs ? makeBinary(TokenKind::POWER, std::move(lhs), std::move(rhs)) : nullptr;
+        }
+        return lhs;
+    }
+
+    // [expr] after an array name
+    bool parseSubscript(STExprPtr& index) {
+        advance();      // [
+        index = parseExpression();
+        return index && expect(TokenKind::RBRACKET, "']'");
+    }
+
+    // name(arg, ...) after the name has been consumed
+    STExprPtr parseCall(STExprPtr call) {
+        call->kind = ExprKind::CALL;
+        advance();      // (
+        if (current.kind != TokenKind::RPAREN) {
+            for (;;) {
+                STExprPtr arg = parseExpression();
+                if (!arg) {
+                    return nullptr;
+                }
+                call->args.push_back(std::move(arg));
+                if (current.kind != TokenKind::COMMA) {
+                    break;
+                }
+                advance();
+            }
+        }
+        if (!expect(TokenKind::RPAREN, "')'")) {
+            return nullptr;
+        }
+        return call;
+    }
+
+    STExprPtr parsePrimary() {
+        STExprPtr expr;
+        switch (current.kind) {
+            case TokenKind::INT_LITERAL: {
+                expr = makeExpr(ExprKind::LITERAL);
+                std::string digits;
+                for (char c : current.text) {
+                    if (c != '_') {
+                        digits += c;
+                    }
+                }
+                long long value = std::strtoll(digits.c_str(), nullptr, 10);
+                if (value > INT32_MAX) {
+                    fail("integer literal out of range: " + std::string(current.text));
+                    return nullptr;
+                }
+                expr->type = STType::INT;
+                expr->value.i = static_cast<std::int32_t>(value);
+                advance();
+                return expr;
+            }
+            case TokenKind::REAL_LITERAL: {
+                expr = makeExpr(ExprKind::LITERAL);
+                std::string digits;
+                for (char c : current.text) {
+                    if (c != '_') {
+                        digits += c;
+                    }
+                }
+                expr->type = STType::REAL;
+                expr->value.r = std::strtof(digits.c_str(), nullptr);
+                advance();
+                return expr;
+            }
+            case TokenKind::KW_TRUE:
+            case TokenKind::KW_FALSE:
+                expr = makeExpr(ExprKind::LITERAL);
+                expr->type = STType::BOOL;
+                expr->value.i = current.kind == TokenKind::KW_TRUE;
+                advance();
+                return expr;
+            case TokenKind::IDENTIFIER:
+                expr = makeExpr(ExprKind::VARIABLE);
+                expr->name = std::string(current.text);
+                advance();
+                if (current.kind == TokenKind::LPAREN) {
+                    return parseCall(std::move(expr));
+                }
+                if (current.kind == TokenKind::LBRACKET) {
+                    expr->kind = ExprKind::INDEX;
+                    if (!parseSubscript(expr->lhs)) {
+                        return nullptr;
+                    }
+                }
+                return expr;
+            case TokenKind::LPAREN:
+                advance();
+                expr = parseExpression();
+                if (!expr || !expect(TokenKind::RPAREN, "')'")) {
+                    return nullptr;
+                }
+                return expr;
+            default:
+                fail("unexpected '" + std::string(current.text) + "' in expression");
+                return nullptr;
+        }
+    }
+
+    // Parse statements until one of the terminator keywords (not consumed)
+    bool parseBlock(STBlock& block, std::initializer_list<TokenKind> terminators) {
+        NestingGuard guard(blockNesting);
+        if (blockNesting > MAX_NESTING) {
+            return fail("statements too deeply nested");
+        }
+        for (;;) {
+            for (TokenKind terminator : terminators) {
+                if (current.kind == terminator) {
+                    return true;
+                }
+            }
+            if (current.kind == TokenKind::END_OF_FILE) {
+                return errorMessage.empty() ? fail("unexpected end of program") : false;
+            }
+            STStmtPtr stmt = parseStatement();
+            if (!stmt) {
+                return false;
+            }
+            if (stmt->kind != StmtKind::ASSIGN || stmt->value) {
+                block.push_back(std::move(stmt));
+            }
+        }
+    }
+
+    STStmtPtr parseStatement() {
+        STStmtPtr stmt = std::make_unique<STStmt>();
+        stmt->line = current.line;
+        switch (current.kind) {
+            case TokenKind::SEMICOLON:      // empty statement
+                advance();
+                stmt->kind = StmtKind::ASSIGN;
+                return stmt;
+            case TokenKind::IDENTIFIER:
+                stmt->kind = StmtKind::ASSIGN;
+                stmt->target = std::string(current.text);
+                advance();
+                if (current.kind == TokenKind::LBRACKET && !parseSubscript(stmt->index)) {
+                    return nullptr;
+                }
+                if (!expect(TokenKind::ASSIGN, "':='")) {
+                    return nullptr;
+                }
+                stmt->value = parseExpression();
+                if (!stmt->value || !expect(TokenKind::SEMICOLON, "';'")) {
+                    return nullptr;
+                }
+                return stmt;
+            case TokenKind::KW_IF:
+                stmt->kind = StmtKind::IF;
+                do {
+                    advance();      // IF or ELSIF
+                    STBranch branch;
+                    branch.condition = parseExpression();
+                    if (!branch.condition || !expect(TokenKind::KW_THEN, "THEN") ||
+                        !parseBlock(branch.body, {TokenKind::KW_ELSIF, TokenKind::KW_ELSE, TokenKind::KW_END_IF})) {
+                        return nullptr;
+                    }
+                    stmt->branches.push_back(std::move(branch));
+                } while (current.kind == TokenKind::KW_ELSIF);
+                if (current.kind == TokenKind::KW_ELSE) {
+                    advance();
+                    if (!parseBlock(stmt->elseBody, {TokenKind::KW_END_IF})) {
+                        return nullptr;
+                    }
+                }
+                if (!expect(TokenKind::KW_END_IF, "END_IF") || !expect(TokenKind::SEMICOLON, "';'")) {
+                    return nullptr;
+                }
+                return stmt;
+            case TokenKind::KW_FOR:
+                stmt->kind = StmtKind::FOR;
+                advance();
+                if (current.kind != TokenKind::IDENTIFIER) {
+                    fail("expected control variable after FOR");
+                    return nullptr;
+                }
+                stmt->target = std::string(current.text);
+                advance();
+                if (!expect(TokenKind::ASSIGN, "':='") || !(stmt->value = parseExpression()) ||
+                    !expect(TokenKind::KW_TO, "TO") || !(stmt->limit = parseExpression())) {
+                    return nullptr;
+                }
+                if (current.kind == TokenKind::KW_BY) {
+                    advance();
+                    if (!(stmt->step = parseExpression())) {
+                        return nullptr;
+                    }
+                }
+                if (!expect(TokenKind::KW_DO, "DO") || !parseBlock(stmt->body, {TokenKind::KW_END_FOR}) ||
+                    !expect(TokenKind::KW_END_FOR, "END_FOR") || !expect(TokenKind::SEMICOLON, "';'")) {
+                    return nullptr;
+                }
+                return stmt;
+            case TokenKind::KW_WHILE:
+                stmt->kind = StmtKind::WHILE;
+                advance();
+                if (!(stmt->condition = parseExpression()) || !expect(TokenKind::KW_DO, "DO") ||
+                    !parseBlock(stmt->body, {TokenKind::KW_END_WHILE}) ||
+                    !expect(TokenKind::KW_END_WHILE, "END_WHILE") || !expect(TokenKind::SEMICOLON, "';'")) {
+                    return nullptr;
+                }
+                return stmt;
+            case TokenKind::KW_REPEAT:
+                stmt->kind = StmtKind::REPEAT;
+                advance();
+                if (!parseBlock(stmt->body, {TokenKind::KW_UNTIL}) || !expect(TokenKind::KW_UNTIL, "UNTIL") ||
+                    !(stmt->condition = parseExpression()) ||
+                    !expect(TokenKind::KW_END_REPEAT, "END_REPEAT") || !expect(TokenKind::SEMICOLON, "';'")) {
+                    return nullptr;
+                }
+                return stmt;
+            case TokenKind::KW_EXIT:
+            case TokenKind::KW_RETURN:
+                stmt->kind = current.kind == TokenKind::KW_EXIT ? StmtKind::EXIT : StmtKind::RETURN;
+                advance();
+                if (!expect(TokenKind::SEMICOLON, "';'")) {
+                    return nullptr;
+                }
+                return stmt;
+            default:
+                fail("unexpected '" + std::string(current.text) + "' at start of statement");
+                return nullptr;
+        }
+    }
+
+    static bool isVarSection(TokenKind kind, VarSection& section) {
+        switch (kind) {
+            case TokenKind::KW_VAR_INPUT: section = VarSection::INPUT; return true;
+            case TokenKind::KW_VAR_OUTPUT: section = VarSection::OUTPUT; return true;
+            case TokenKind::KW_VAR_IN_OUT: section = VarSection::IN_OUT; return true;
+            case TokenKind::KW_VAR_TEMP: section = VarSection::TEMP; return true;
+            case TokenKind::KW_VAR: section = VarSection::STATIC; return true;
+            default: return false;
+        }
+    }
+
+    bool parseBound(std::int32_t& bound) {
+        bool negative = current.kind == TokenKind::MINUS;
+        if (negative) {
+            advance();
+        }
+        STExprPtr literal = current.kind == TokenKind::INT_LITERAL ? parsePrimary() : nullptr;
+        if (!literal) {
+            return fail("expected an integer array bound");
+        }
+        bound = negative ? -literal->value.i : literal->value.i;
+        return true;
+    }
+
+    // BOOL, INT (DINT is the same 32-bit type here) or REAL
+    bool parseElementaryType(STType& type) {
+        std::string name(current.text);
+        for (char& c : name) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        if (current.kind != TokenKind::IDENTIFIER) {
+            return fail("expected a type but found '" + std::string(current.text) + "'");
+        }
+        if (name == "BOOL") {
+            type = STType::BOOL;
+        } else if (name == "INT" || name == "DINT") {
+            type = STType::INT;
+        } else if (name == "REAL") {
+            type = STType::REAL;
+        } else {
+            return fail("unsupported type '" + std::string(current.text) + "'");
+        }
+        advance();
+        return true;
+    }
+
+    // a, b : [ARRAY[lo..hi] OF] type [:= value | := (value, ...)] ;
+    bool parseDeclaration(VarSection section, std::vector<STVarDecl>& variables) {
+        STVarDecl decl;
+        decl.section = section;
+        decl.line = current.line;
+        std::vector<std::string> names;     // a, b : REAL declares both
+        for (;;) {
+            if (current.kind != TokenKind::IDENTIFIER) {
+                return fail("expected a variable name but found '" + std::string(current.text) + "'");
+            }
+            names.emplace_back(current.text);
+            advance();
+            if (current.kind != TokenKind::COMMA) {
+                break;
+            }
+            advance();
+        }
+        if (!expect(TokenKind::COLON, "':'")) {
+            return false;
+        }
+        if (current.kind == TokenKind::KW_ARRAY) {
+            decl.array = true;
+            advance();
+            if (!expect(TokenKind::LBRACKET, "'['") || !parseBound(decl.lower) ||
+                !expect(TokenKind::RANGE, "'..'") || !parseBound(decl.upper) ||
+                !expect(TokenKind::RBRACKET, "']'") || !expect(TokenKind::KW_OF, "OF")) {
+                return false;
+            }
+            if (decl.upper < decl.lower) {
+                return fail("empty array range");
+            }
+        }
+        if (!parseElementaryType(decl.type)) {
+            return false;
+        }
+        if (current.kind == TokenKind::ASSIGN) {
+            advance();
+            bool list = decl.array && current.kind == TokenKind::LPAREN;
+            if (list) {
+                advance();
+            }
+            do {
+                if (list && current.kind == TokenKind::COMMA) {
+                    advance();
+                }
+                STExprPtr value = parseExpression();
+                if (!value) {
+                    return false;
+                }
+                decl.init.push_back(std::move(value));
+            } while (list && current.kind == TokenKind::COMMA);
+            if (list && !expect(TokenKind::RPAREN, "')'")) {
+                return false;
+            }
+        }
+        if (!expect(TokenKind::SEMICOLON, "';'")) {
+            return false;
+        }
+        for (std::size_t n = 0; n < names.size(); n++) {
+            STVarDecl copy;
+            copy.name = names[n];
+            copy.type = decl.type;
+            copy.section = decl.section;
+            copy.array = decl.array;
+            copy.lower = decl.lower;
+            copy.upper = decl.upper;
+            copy.line = decl.line;
+            for (const STExprPtr& value : decl.init) {
+                copy.init.push_back(cloneExpr(*value));
+            }
+            variables.push_back(std::move(copy));
+        }
+        return true;
+    }
+
+public:
+    explicit STParser(std::string_view source) : lexer(source) { advance(); }
+
+    // Parse a statement list up to the end of the source
+    bool parseProgram(STBlock& program) {
+        return parseBlock(program, {TokenKind::END_OF_FILE}) && errorMessage.empty();
+    }
+
+    // Parse FUNCTION_BLOCK name, its VAR sections and body, up to END_FUNCTION_BLOCK
+    bool parseFunctionBlock(STFunctionBlockDecl& block) {
+        if (!expect(TokenKind::KW_FUNCTION_BLOCK, "FUNCTION_BLOCK")) {
+            return false;
+        }
+        if (current.kind != TokenKind::IDENTIFIER) {
+            return fail("expected a function block name");
+        }
+        block.name = std::string(current.text);
+        advance();
+        VarSection section;
+        while (isVarSection(current.kind, section)) {
+            advance();
+            if (section == VarSection::STATIC && current.kind == TokenKind::KW_CONSTANT) {
+                section = VarSection::CONSTANT;
+                advance();
+            }
+            while (current.kind == TokenKind::IDENTIFIER) {
+                if (!parseDeclaration(section, block.variables)) {
+                    return false;
+                }
+            }
+            if (!expect(TokenKind::KW_END_VAR, "END_VAR")) {
+                return false;
+            }
+        }
+        if (current.kind == TokenKind::KW_BEGIN) {
+            advance();
+        }
+        if (!parseBlock(block.body, {TokenKind::KW_END_FUNCTION_BLOCK})) {
+            return false;
+        }
+        advance();
+        if (current.kind == TokenKind::SEMICOLON) {
+            advance();
+        }
+        return expect(TokenKind::END_OF_FILE, "end of source after END_FUNCTION_BLOCK") && errorMessage.empty();
+    }
+
+    bool ok() const { return errorMessage.empty(); }
+    const std::string& error() const { return errorMessage; }
+};
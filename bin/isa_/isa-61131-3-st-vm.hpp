@@ -0,0 +1,386 @@
+/**
+ * ISA-61131-3 Structured Text Bytecode and Register VM
+ * A compiled program is a flat array of 8-byte register instructions whose
+ * operands are already resolved: variables are process image slots (bit
+ * numbers for I/Q) or, inside a function block, offsets in the instance
+ * frame; constants are immediates and control flow is absolute jump
+ * targets. Executing a scan is a single dispatch loop over that array
+ * reading and writing the image in place, with no lookups or allocation.
+ *
+ * Arithmetic is total: INT wraps, division by zero yields 0 and REAL
+ * conversions saturate, so a scan never traps or throws. Every ALU opcode
+ * is defined once, in apply<op>(); the VM inlines it per opcode and the
+ * compiler folds constants through alu(), which dispatches to the same
+ * code, so a folded constant is bit-identical to the value computed at
+ * run time.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "isa-61131-3-process-image.hpp"
+#include "isa-61131-3-st-parser.hpp"
+
+enum class OpCode : std::uint8_t {
+    LOAD_CONST,     // r[dst] = operand (raw 32-bit cell)
+    LOAD_INPUT,     // r[dst] = input bit operand
+    LOAD_OUTPUT,    // r[dst] = output bit operand
+    STORE_OUTPUT,   // output bit operand = r[lhs]
+    LOAD_INT, STORE_INT,        // integers[operand]
+    LOAD_REAL, STORE_REAL,      // reals[operand]
+    LOAD_BOOL, STORE_BOOL,      // booleans[operand]
+    LOAD_LOCAL, STORE_LOCAL,    // frame[operand] (function block instance data)
+    LOAD_LOCAL_INDEXED,         // r[dst] = frame[offset + r[lhs]], 0 when out of range
+    STORE_LOCAL_INDEXED,        // frame[offset + r[rhs]] = r[lhs], dropped when out of range
+    ADD_INT, SUB_INT, MUL_INT, DIV_INT, MOD_INT, NEG_INT,
+    ADD_REAL, SUB_REAL, MUL_REAL, DIV_REAL, NEG_REAL,
+    EQ_INT, NE_INT, LT_INT, LE_INT, GT_INT, GE_INT,
+    EQ_REAL, NE_REAL, LT_REAL, LE_REAL, GT_REAL, GE_REAL,
+    AND, OR, XOR, NOT,
+    INT_TO_REAL,
+    REAL_TO_INT,    // round half to even, saturating
+    TRUNC_REAL,     // REAL -> INT toward zero, saturating
+    ABS_INT, ABS_REAL,
+    MIN_INT, MAX_INT, MIN_REAL, MAX_REAL,
+    SQRT_REAL, SQUARE_REAL, EXPT_REAL,
+    JUMP,           // pc = operand
+    JUMP_IF_FALSE,  // if (!r[lhs]) pc = operand
+    HALT
+};
+
+struct Instruction {
+    OpCode op;
+    std::uint8_t dst;
+    std::uint8_t lhs;
+    std::uint8_t rhs;
+    std::int32_t operand;
+};
+
+static_assert(sizeof(Instruction) == 8, "instructions are packed to 8 bytes");
+
+// Indexed frame access packs the array offset (low 16 bits) and length
+// (high 16 bits) into the operand
+inline std::int32_t packArray(std::uint32_t offset, std::uint32_t length) {
+    return static_cast<std::int32_t>(offset | (length << 16));
+}
+
+// A variable referenced by the program, resolved at compile time
+struct STSymbol {
+    std::string name;
+    STType type;
+    PLCAddress address;
+    bool written;       // assigned by the program
+};
+
+struct STProgram {
+    std::vector<Instruction> code;
+    std::vector<STSymbol> symbols;
+    std::size_t registerCount = 0;
+
+    void clear() {
+        code.clear();
+        symbols.clear();
+        registerCount = 0;
+    }
+};
+
+class STVirtualMachine {
+public:
+    static constexpr std::size_t REGISTER_COUNT = 64;
+
+private:
+    // INT arithmetic wraps like the 32-bit target instead of being undefined
+    static std::int32_t wrap(std::int64_t value) {
+        return static_cast<std::int32_t>(static_cast<std::uint32_t>(value));
+    }
+
+    // Division by zero yields 0 rather than trapping the simulator
+    static std::int32_t divide(std::int32_t a, std::int32_t b) {
+        if (b == 0) {
+            return 0;
+        }
+        if (b == -1) {
+            return wrap(-static_cast<std::int64_t>(a));
+        }
+        return a / b;
+    }
+
+    static std::int32_t modulo(std::int32_t a, std::int32_t b) {
+        return (b == 0 || b == -1) ? 0 : a % b;
+    }
+
+    // REAL -> INT without undefined behaviour: NaN is 0, out of range clamps
+    static std::int32_t saturate(float value) {
+        if (!(value == value)) {
+            return 0;
+        }
+        if (value >= 2147483648.0f) {
+            return INT32_MAX;
+        }
+        if (value < -2147483648.0f) {
+            return INT32_MIN;
+        }
+        return static_cast<std::int32_t>(value);
+    }
+
+    static STCell intCell(std::int32_t value) {
+        STCell cell;
+        cell.i = value;
+        return cell;
+    }
+
+    static STCell realCell(float value) {
+        STCell cell;
+        cell.r = value;
+        return cell;
+    }
+
+public:
+    // Result of one pure opcode; unary ones ignore b
+    template <OpCode op>
+    static STCell apply(STCell a, STCell b) {
+        if constexpr (op == OpCode::ADD_INT) {
+            return intCell(wrap(std::int64_t(a.i) + b.i));
+        } else if constexpr (op == OpCode::SUB_INT) {
+            return intCell(wrap(std::int64_t(a.i) - b.i));
+        } else if constexpr (op == OpCode::MUL_INT) {
+            return intCell(wrap(std::int64_t(a.i) * b.i));
+        } else if constexpr (op == OpCode::DIV_INT) {
+            return intCell(divide(a.i, b.i));
+        } else if constexpr (op == OpCode::MOD_INT) {
+            return intCell(modulo(a.i, b.i));
+        } else if constexpr (op == OpCode::NEG_INT) {
+            return intCell(wrap(-std::int64_t(a.i)));
+        } else if constexpr (op == OpCode::ADD_REAL) {
+            return realCell(a.r + b.r);
+        } else if constexpr (op == OpCode::SUB_REAL) {
+            return realCell(a.r - b.r);
+        } else if constexpr (op == OpCode::MUL_REAL) {
+            return realCell(a.r * b.r);
+        } else if constexpr (op == OpCode::DIV_REAL) {
+            return realCell(a.r / b.r);
+        } else if constexpr (op == OpCode::NEG_REAL) {
+            return realCell(-a.r);
+        } else if constexpr (op == OpCode::EQ_INT) {
+            return intCell(a.i == b.i);
+        } else if constexpr (op == OpCode::NE_INT) {
+            return intCell(a.i != b.i);
+        } else if constexpr (op == OpCode::LT_INT) {
+            return intCell(a.i < b.i);
+        } else if constexpr (op == OpCode::LE_INT) {
+            return intCell(a.i <= b.i);
+        } else if constexpr (op == OpCode::GT_INT) {
+            return intCell(a.i > b.i);
+        } else if constexpr (op == OpCode::GE_INT) {
+            return intCell(a.i >= b.i);
+        } else if constexpr (op == OpCode::EQ_REAL) {
+            return intCell(a.r == b.r);
+        } else if constexpr (op == OpCode::NE_REAL) {
+            return intCell(a.r != b.r);
+        } else if constexpr (op == OpCode::LT_REAL) {
+            return intCell(a.r < b.r);
+        } else if constexpr (op == OpCode::LE_REAL) {
+            return intCell(a.r <= b.r);
+        } else if constexpr (op == OpCode::GT_REAL) {
+            return intCell(a.r > b.r);
+        } else if constexpr (op == OpCode::GE_REAL) {
+            return intCell(a.r >= b.r);
+        } else if constexpr (op == OpCode::AND) {
+            return intCell(a.i & b.i);
+        } else if constexpr (op == OpCode::OR) {
+            return intCell(a.i | b.i);
+        } else if constexpr (op == OpCode::XOR) {
+            return intCell(a.i ^ b.i);
+        } else if constexpr (op == OpCode::NOT) {
+            return intCell(a.i ^ 1);
+        } else if constexpr (op == OpCode::INT_TO_REAL) {
+            return realCell(static_cast<float>(a.i));
+        } else if constexpr (op == OpCode::REAL_TO_INT) {
+            return intCell(saturate(std::nearbyint(a.r)));
+        } else if constexpr (op == OpCode::TRUNC_REAL) {
+            return intCell(saturate(std::trunc(a.r)));
+        } else if constexpr (op == OpCode::ABS_INT) {
+            return intCell(a.i < 0 ? wrap(-std::int64_t(a.i)) : a.i);
+        } else if constexpr (op == OpCode::ABS_REAL) {
+            return realCell(std::fabs(a.r));
+        } else if constexpr (op == OpCode::MIN_INT) {
+            return intCell(b.i < a.i ? b.i : a.i);
+        } else if constexpr (op == OpCode::MAX_INT) {
+            return intCell(a.i < b.i ? b.i : a.i);
+        } else if constexpr (op == OpCode::MIN_REAL) {
+            return realCell(b.r < a.r ? b.r : a.r);
+        } else if constexpr (op == OpCode::MAX_REAL) {
+            return realCell(a.r < b.r ? b.r : a.r);
+        } else if constexpr (op == OpCode::SQRT_REAL) {
+            return realCell(std::sqrt(a.r));
+        } else if constexpr (op == OpCode::SQUARE_REAL) {
+            return realCell(a.r * a.r);
+        } else {
+            static_assert(op == OpCode::EXPT_REAL, "not an ALU opcode");
+            return realCell(std::pow(a.r, b.r));
+        }
+    }
+
+    // The same operation selected at run time (used for constant folding)
+    static STCell alu(OpCode op, STCell a, STCell b) {
+        switch (op) {
+            case OpCode::ADD_INT: return apply<OpCode::ADD_INT>(a, b);
+            case OpCode::SUB_INT: return apply<OpCode::SUB_INT>(a, b);
+            case OpCode::MUL_INT: return apply<OpCode::MUL_INT>(a, b);
+            case OpCode::DIV_INT: return apply<OpCode::DIV_INT>(a, b);
+            case OpCode::MOD_INT: return apply<OpCode::MOD_INT>(a, b);
+            case OpCode::NEG_INT: return apply<OpCode::NEG_INT>(a, b);
+            case OpCode::ADD_REAL: return apply<OpCode::ADD_REAL>(a, b);
+            case OpCode::SUB_REAL: return apply<OpCode::SUB_REAL>(a, b);
+            case OpCode::MUL_REAL: return apply<OpCode::MUL_REAL>(a, b);
+            case OpCode::DIV_REAL: return apply<OpCode::DIV_REAL>(a, b);
+            case OpCode::NEG_REAL: return apply<OpCode::NEG_REAL>(a, b);
+            case OpCode::EQ_INT: return apply<OpCode::EQ_INT>(a, b);
+            case OpCode::NE_INT: return apply<OpCode::NE_INT>(a, b);
+            case OpCode::LT_INT: return apply<OpCode::LT_INT>(a, b);
+            case OpCode::LE_INT: return apply<OpCode::LE_INT>(a, b);
+            case OpCode::GT_INT: return apply<OpCode::GT_INT>(a, b);
+            case OpCode::GE_INT: return apply<OpCode::GE_INT>(a, b);
+            case OpCode::EQ_REAL: return apply<OpCode::EQ_REAL>(a, b);
+            case OpCode::NE_REAL: return apply<OpCode::NE_REAL>(a, b);
+            case OpCode::LT_REAL: return apply<OpCode::LT_REAL>(a, b);
+            case OpCode::LE_REAL: return apply<OpCode::LE_REAL>(a, b);
+            case OpCode::GT_REAL: return apply<OpCode::GT_REAL>(a, b);
+            case OpCode::GE_REAL: return apply<OpCode::GE_REAL>(a, b);
+            case OpCode::AND: return apply<OpCode::AND>(a, b);
+            case OpCode::OR: return apply<OpCode::OR>(a, b);
+            case OpCode::XOR: return apply<OpCode::XOR>(a, b);
+            case OpCode::NOT: return apply<OpCode::NOT>(a, b);
+            case OpCode::INT_TO_REAL: return apply<OpCode::INT_TO_REAL>(a, b);
+            case OpCode::REAL_TO_INT: return apply<OpCode::REAL_TO_INT>(a, b);
+            case OpCode::TRUNC_REAL: return apply<OpCode::TRUNC_REAL>(a, b);
+            case OpCode::ABS_INT: return apply<OpCode::ABS_INT>(a, b);
+            case OpCode::ABS_REAL: return apply<OpCode::ABS_REAL>(a, b);
+            case OpCode::MIN_INT: return apply<OpCode::MIN_INT>(a, b);
+            case OpCode::MAX_INT: return apply<OpCode::MAX_INT>(a, b);
+            case OpCode::MIN_REAL: return apply<OpCode::MIN_REAL>(a, b);
+            case OpCode::MAX_REAL: return apply<OpCode::MAX_REAL>(a, b);
+            case OpCode::SQRT_REAL: return apply<OpCode::SQRT_REAL>(a, b);
+            case OpCode::SQUARE_REAL: return apply<OpCode::SQUARE_REAL>(a, b);
+            case OpCode::EXPT_REAL: return apply<OpCode::EXPT_REAL>(a, b);
+            default: return a;
+        }
+    }
+
+    // Execute one pass of the program against a process image; function
+    // block code also gets the frame of the instance being called
+    static void run(const STProgram& program, ProcessImage& image, STCell* frame = nullptr) {
+        STCell r[REGISTER_COUNT];
+        const std::uint64_t* inputs = image.inputs.data();
+        std::uint64_t* outputs = image.outputs.data();
+        std::int32_t* integers = image.integers.data();
+        float* reals = image.reals.data();
+        std::uint8_t* booleans = image.booleans.data();
+        const Instruction* code = program.code.data();
+        std::size_t pc = 0;
+        for (;;) {
+            const Instruction& in = code[pc++];
+            switch (in.op) {
+                case OpCode::LOAD_CONST: r[in.dst].i = in.operand; break;
+                case OpCode::LOAD_INPUT:
+                    r[in.dst].i = static_cast<std::int32_t>((inputs[in.operand >> 6] >> (in.operand & 63)) & 1);
+                    break;
+                case OpCode::LOAD_OUTPUT:
+                    r[in.dst].i = static_cast<std::int32_t>((outputs[in.operand >> 6] >> (in.operand & 63)) & 1);
+                    break;
+                case OpCode::STORE_OUTPUT: {
+                    std::uint64_t mask = std::uint64_t(1) << (in.operand & 63);
+                    std::uint64_t& word = outputs[in.operand >> 6];
+                    word = (word & ~mask) | (-static_cast<std::uint64_t>(r[in.lhs].i & 1) & mask);
+                    break;
+                }
+                case OpCode::LOAD_INT: r[in.dst].i = integers[in.operand]; break;
+                case OpCode::STORE_INT: integers[in.operand] = r[in.lhs].i; break;
+                case OpCode::LOAD_REAL: r[in.dst].r = reals[in.operand]; break;
+                case OpCode::STORE_REAL: reals[in.operand] = r[in.lhs].r; break;
+                case OpCode::LOAD_BOOL: r[in.dst].i = booleans[in.operand]; break;
+                case OpCode::STORE_BOOL: booleans[in.operand] = static_cast<std::uint8_t>(r[in.lhs].i); break;
+                case OpCode::LOAD_LOCAL: r[in.dst] = frame[in.operand]; break;
+                case OpCode::STORE_LOCAL: frame[in.operand] = r[in.lhs]; break;
+                case OpCode::LOAD_LOCAL_INDEXED: {
+                    std::uint32_t element = static_cast<std::uint32_t>(r[in.lhs].i);
+                    std::uint32_t packed = static_cast<std::uint32_t>(in.operand);
+                    r[in.dst].i = 0;
+                    if (element < (packed >> 16)) {
+                        r[in.dst] = frame[(packed & 0xFFFF) + element];
+                    }
+                    break;
+                }
+                case OpCode::STORE_LOCAL_INDEXED: {
+                    std::uint32_t element = static_cast<std::uint32_t>(r[in.rhs].i);
+                    std::uint32_t packed = static_cast<std::uint32_t>(in.operand);
+                    if (element < (packed >> 16)) {
+                        frame[(packed & 0xFFFF) + element] = r[in.lhs];
+                    }
+                    break;
+                }
+
+                case OpCode::ADD_INT: r[in.dst] = apply<OpCode::ADD_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::SUB_INT: r[in.dst] = apply<OpCode::SUB_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::MUL_INT: r[in.dst] = apply<OpCode::MUL_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::DIV_INT: r[in.dst] = apply<OpCode::DIV_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::MOD_INT: r[in.dst] = apply<OpCode::MOD_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::NEG_INT: r[in.dst] = apply<OpCode::NEG_INT>(r[in.lhs], r[in.lhs]); break;
+
+                case OpCode::ADD_REAL: r[in.dst] = apply<OpCode::ADD_REAL>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::SUB_REAL: r[in.dst] = apply<OpCode::SUB_REAL>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::MUL_REAL: r[in.dst] = apply<OpCode::MUL_REAL>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::DIV_REAL: r[in.dst] = apply<OpCode::DIV_REAL>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::NEG_REAL: r[in.dst] = apply<OpCode::NEG_REAL>(r[in.lhs], r[in.lhs]); break;
+
+                case OpCode::EQ_INT: r[in.dst] = apply<OpCode::EQ_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::NE_INT: r[in.dst] = apply<OpCode::NE_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::LT_INT: r[in.dst] = apply<OpCode::LT_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::LE_INT: r[in.dst] = apply<OpCode::LE_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::GT_INT: r[in.dst] = apply<OpCode::GT_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::GE_INT: r[in.dst] = apply<OpCode::GE_INT>(r[in.lhs], r[in.rhs]); break;
+
+                case OpCode::EQ_REAL: r[in.dst] = apply<OpCode::EQ_REAL>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::NE_REAL: r[in.dst] = apply<OpCode::NE_REAL>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::LT_REAL: r[in.dst] = apply<OpCode::LT_REAL>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::LE_REAL: r[in.dst] = apply<OpCode::LE_REAL>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::GT_REAL: r[in.dst] = apply<OpCode::GT_REAL>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::GE_REAL: r[in.dst] = apply<OpCode::GE_REAL>(r[in.lhs], r[in.rhs]); break;
+
+                case OpCode::AND: r[in.dst] = apply<OpCode::AND>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::OR: r[in.dst] = apply<OpCode::OR>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::XOR: r[in.dst] = apply<OpCode::XOR>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::NOT: r[in.dst] = apply<OpCode::NOT>(r[in.lhs], r[in.lhs]); break;
+
+                case OpCode::INT_TO_REAL: r[in.dst] = apply<OpCode::INT_TO_REAL>(r[in.lhs], r[in.lhs]); break;
+                case OpCode::REAL_TO_INT: r[in.dst] = apply<OpCode::REAL_TO_INT>(r[in.lhs], r[in.lhs]); break;
+                case OpCode::TRUNC_REAL: r[in.dst] = apply<OpCode::TRUNC_REAL>(r[in.lhs], r[in.lhs]); break;
+
+                case OpCode::ABS_INT: r[in.dst] = apply<OpCode::ABS_INT>(r[in.lhs], r[in.lhs]); break;
+                case OpCode::ABS_REAL: r[in.dst] = apply<OpCode::ABS_REAL>(r[in.lhs], r[in.lhs]); break;
+
+                case OpCode::MIN_INT: r[in.dst] = apply<OpCode::MIN_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::MAX_INT: r[in.dst] = apply<OpCode::MAX_INT>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::MIN_REAL: r[in.dst] = apply<OpCode::MIN_REAL>(r[in.lhs], r[in.rhs]); break;
+                case OpCode::MAX_REAL: r[in.dst] = apply<OpCode::MAX_REAL>(r[in.lhs], r[in.rhs]); break;
+
+                case OpCode::SQRT_REAL: r[in.dst] = apply<OpCode::SQRT_REAL>(r[in.lhs], r[in.lhs]); break;
+                case OpCode::SQUARE_REAL: r[in.dst] = apply<OpCode::SQUARE_REAL>(r[in.lhs], r[in.lhs]); break;
+                case OpCode::EXPT_REAL: r[in.dst] = apply<OpCode::EXPT_REAL>(r[in.lhs], r[in.rhs]); break;
+
+                case OpCode::JUMP: pc = static_cast<std::size_t>(in.operand); break;
+                case OpCode::JUMP_IF_FALSE:
+                    if (r[in.lhs].i == 0) {
+                        pc = static_cast<std::size_t>(in.operand);
+                    }
+                    break;
+                case OpCode::HALT: return;
+            }
+        }
+    }
+};
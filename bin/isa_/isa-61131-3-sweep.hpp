@@ -0,0 +1,427 @@
+/**
+ * ISA-61131-3 Parameter Sweeps for Control Function Blocks
+ * Runs a compiled FUNCTION_BLOCK in thousands of independent closed-loop
+ * simulations - a full grid over the swept parameters, or seeded random
+ * samples - on all cores. Each run calls the FB once per step against a
+ * first-order-plus-dead-time plant (PV' = (bias + gain * CV(t - dead) -
+ * PV) / tau) and reduces the PV trace to overshoot, settling time,
+ * integral absolute error and alarm count.
+ *
+ * Every worker owns an arena (instance frame, dead-time line, PV trace,
+ * result batch) sized once and reused for all its runs, so the hot loop
+ * never allocates and workers share nothing but a run counter and the
+ * file lock. Sample k depends only on the seed and k, so results do not
+ * depend on the thread count.
+ *
+ * Results stream to a compact binary file: a header (magic, version,
+ * record size, parameter count, 32-byte parameter labels) followed by one
+ * fixed-size record per run in completion order, written in batches.
+ * POSIX file I/O.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "isa-61131-3-function-block.hpp"
+#include "isa-61131-3-process-image.hpp"
+#include "isa-61131-3-st-vm.hpp"
+
+// Plant and metric settings; slots come from STFunctionBlock::slot
+struct SweepLoop {
+    std::int32_t pv = STFunctionBlock::NO_SLOT;        // REAL input: measured value
+    std::int32_t cv = STFunctionBlock::NO_SLOT;        // REAL output: controller output
+    std::int32_t sp = STFunctionBlock::NO_SLOT;        // REAL input: setpoint, optional
+    std::int32_t alarm = STFunctionBlock::NO_SLOT;     // BOOL output counted on rising edges, optional
+    float gain = 1.0f;              // PV per unit CV at steady state
+    float bias = 0.0f;              // PV at CV = 0
+    float timeConstant = 10.0f;     // s
+    float deadTime = 0.0f;          // s
+    float initialPv = 0.0f;
+    float initialCv = 0.0f;
+    float setpoint = 1.0f;          // target for IAE, written to sp when given
+    float alarmLimit = INFINITY;    // PV high alarm when no alarm slot is given
+    float settleBand = 0.02f;       // fraction of the PV change
+    float step = 0.1f;              // s per FB call
+    std::uint32_t steps = 1000;
+};
+
+// Fixed part of a result record; the swept parameter values follow
+struct SweepRecord {
+    std::uint32_t run;
+    std::uint32_t alarms;
+    float overshoot;        // % of the PV change
+    float settlingTime;     // s
+    float iae;              // integral |SP - PV| dt
+    float finalPv;
+};
+
+static_assert(sizeof(SweepRecord) == 24, "sweep record layout is part of the file format");
+
+struct SweepHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint32_t parameterCount;
+    std::uint32_t reserved;
+};
+
+constexpr char SWEEP_MAGIC[8] = {'S', 'T', 'S', 'W', 'E', 'E', 'P', '\0'};
+constexpr std::uint32_t SWEEP_VERSION = 1;
+constexpr std::size_t SWEEP_LABEL_SIZE = 32;
+
+class SweepRunner {
+public:
+    struct Summary {
+        std::uint64_t runs = 0;
+        std::uint64_t scans = 0;
+        unsigned threads = 0;
+        double seconds = 0.0;
+    };
+
+private:
+    struct Parameter {
+        std::string label;
+        std::int32_t slot;
+        float low;
+        float high;
+        std::uint32_t points;       // grid points; 1 holds the value at low
+    };
+
+    // Per-worker storage, allocated once
+    struct Arena {
+        std::vector<STCell> frame;
+        std::vector<float> delayLine;
+        std::vector<float> trace;
+        std::vector<float> values;
+        std::vector<unsigned char> batch;
+        ProcessImage image;
+    };
+
+    static constexpr std::size_t BATCH_RECORDS = 512;
+
+    const STFunctionBlock& block;
+    SweepLoop loop;
+    ProcessImage globals;
+    std::vector<Parameter> parameters;
+
+    bool parametersValid = true;
+
+    int fd = -1;
+    std::mutex fileMutex;
+    std::atomic<std::uint64_t> nextRun{0};
+    std::atomic<bool> writeFailed{false};
+
+    // True when slot is a cell of a variable of the given type in the frame
+    bool isCell(std::int32_t slot, STType type) const {
+        if (slot < 0 || static_cast<std::size_t>(slot) >= block.frameSize()) {
+            return false;
+        }
+        for (const STVariable& var : block.variables) {
+            if (static_cast<std::uint32_t>(slot) >= var.offset &&
+                static_cast<std::uint32_t>(slot) < var.offset + var.length) {
+                return var.type == type;
+            }
+        }
+        return false;
+    }
+
+    bool checkSlot(std::int32_t slot, STType type, const char* what, bool optional) const {
+        if ((optional && slot == STFunctionBlock::NO_SLOT) || isCell(slot, type)) {
+            return true;
+        }
+        std::cout << "[ERROR] sweep " << what << " is not a " << typeToString(type) << " variable of "
+                  << block.name << "\n";
+        return false;
+    }
+
+    std::size_t deadSteps() const { return static_cast<std::size_t>(std::lround(loop.deadTime / loop.step)); }
+
+    std::size_t recordSize() const { return sizeof(SweepRecord) + parameters.size() * sizeof(float); }
+
+    static std::uint64_t splitmix64(std::uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    // Parameter values of grid point `run` (first parameter varies fastest)
+    void gridValues(std::uint64_t run, std::vector<float>& values) const {
+        for (std::size_t p = 0; p < parameters.size(); p++) {
+            const Parameter& parameter = parameters[p];
+            std::uint32_t point = static_cast<std::uint32_t>(run % parameter.points);
+            run /= parameter.points;
+            values[p] = parameter.points > 1
+                ? parameter.low + (parameter.high - parameter.low) * static_cast<float>(point) /
+                  static_cast<float>(parameter.points - 1)
+                : parameter.low;
+        }
+    }
+
+    // Parameter values of random sample `run`, uniform in [low, high]
+    void randomValues(std::uint64_t seed, std::uint64_t run, std::vector<float>& values) const {
+        std::uint64_t state = splitmix64(seed ^ splitmix64(run));
+        for (std::size_t p = 0; p < parameters.size(); p++) {
+            state = splitmix64(state);
+            float unit = static_cast<float>(state >> 40) * (1.0f / 16777216.0f);
+            values[p] = parameters[p].low + (parameters[p].high - parameters[p].low) * unit;
+        }
+    }
+
+    // One closed-loop run with the arena's parameter values
+    SweepRecord simulate(Arena& arena) const {
+        std::copy(block.initialFrame.begin(), block.initialFrame.end(), arena.frame.begin());
+        STCell* frame = arena.frame.data();
+        for (std::size_t p = 0; p < parameters.size(); p++) {
+            frame[parameters[p].slot].r = arena.values[p];
+        }
+        std::fill(arena.delayLine.begin(), arena.delayLine.end(), loop.initialCv);
+
+        SweepRecord record{};
+        std::size_t delay = deadSteps();
+        float pv = loop.initialPv;
+        float dt = loop.step;
+        bool alarmed = false;
+        for (std::uint32_t k = 0; k < loop.steps; k++) {
+            frame[loop.pv].r = pv;
+            if (loop.sp != STFunctionBlock::NO_SLOT) {
+                frame[loop.sp].r = loop.setpoint;
+            }
+            STVirtualMachine::run(block.program, arena.image, frame);
+
+            // CV enters the plant after the dead time
+            float cv = frame[loop.cv].r;
+            if (delay > 0) {
+                std::swap(cv, arena.delayLine[k % delay]);
+            }
+            pv += (loop.bias + loop.gain * cv - pv) * dt / loop.timeConstant;
+            arena.trace[k] = pv;
+
+            record.iae += std::fabs(loop.setpoint - pv) * dt;
+            bool alarm = loop.alarm != STFunctionBlock::NO_SLOT ? frame[loop.alarm].i != 0 : pv > loop.alarmLimit;
+            record.alarms += alarm && !alarmed;
+            alarmed = alarm;
+        }
+
+        // Step response metrics relative to the change from the initial to the final PV
+        float change = pv - loop.initialPv;
+        float band = loop.settleBand * std::fabs(change);
+        float peak = 0.0f;
+        std::uint32_t settled = 0;
+        for (std::uint32_t k = 0; k < loop.steps; k++) {
+            float beyond = change >= 0.0f ? arena.trace[k] - pv : pv - arena.trace[k];
+            peak = std::max(peak, beyond);
+            if (std::fabs(arena.trace[k] - pv) > band) {
+                settled = k + 1;
+            }
+        }
+        record.overshoot = change != 0.0f ? 100.0f * peak / std::fabs(change) : 0.0f;
+        record.settlingTime = static_cast<float>(settled) * dt;
+        record.finalPv = pv;
+        return record;
+    }
+
+    void flush(Arena& arena) {
+        if (arena.batch.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(fileMutex);
+        const unsigned char* data = arena.batch.data();
+        std::size_t left = arena.batch.size();
+        while (left > 0) {
+            ssize_t written = ::write(fd, data, left);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                writeFailed = true;
+                break;
+            }
+            data += written;
+            left -= static_cast<std::size_t>(written);
+        }
+        arena.batch.clear();
+    }
+
+    void worker(std::uint64_t runs, bool random, std::uint64_t seed, std::uint64_t& scans) {
+        Arena arena;
+        arena.frame.resize(block.frameSize());
+        arena.delayLine.resize(std::max<std::size_t>(1, deadSteps()));
+        arena.trace.resize(loop.steps);
+        arena.values.resize(parameters.size());
+        arena.batch.reserve(BATCH_RECORDS * recordSize());
+        arena.image = globals;
+
+        for (;;) {
+            std::uint64_t run = nextRun.fetch_add(1, std::memory_order_relaxed);
+            if (run >= runs) {
+                break;
+            }
+            if (random) {
+                randomValues(seed, run, arena.values);
+            } else {
+                gridValues(run, arena.values);
+            }
+            SweepRecord record = simulate(arena);
+            record.run = static_cast<std::uint32_t>(run);
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&record);
+            arena.batch.insert(arena.batch.end(), bytes, bytes + sizeof(record));
+            bytes = reinterpret_cast<const unsigned char*>(arena.values.data());
+            arena.batch.insert(arena.batch.end(), bytes, bytes + arena.values.size() * sizeof(float));
+            scans += loop.steps;
+            if (arena.batch.size() >= BATCH_RECORDS * recordSize()) {
+                flush(arena);
+            }
+        }
+        flush(arena);
+    }
+
+    bool run(const std::string& path, std::uint64_t runs, bool random, std::uint64_t seed, unsigned threads,
+             Summary& summary) {
+        if (!parametersValid || !checkSlot(loop.pv, STType::REAL, "PV", false) ||
+            !checkSlot(loop.cv, STType::REAL, "CV", false) || !checkSlot(loop.sp, STType::REAL, "SP", true) ||
+            !checkSlot(loop.alarm, STType::BOOL, "alarm", true) || loop.step <= 0.0f) {
+            return false;
+        }
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        SweepHeader header{};
+        std::memcpy(header.magic, SWEEP_MAGIC, sizeof(header.magic));
+        header.version = SWEEP_VERSION;
+        header.recordSize = static_cast<std::uint32_t>(recordSize());
+        header.parameterCount = static_cast<std::uint32_t>(parameters.size());
+        std::vector<char> labels(parameters.size() * SWEEP_LABEL_SIZE, '\0');
+        for (std::size_t p = 0; p < parameters.size(); p++) {
+            parameters[p].label.copy(&labels[p * SWEEP_LABEL_SIZE], SWEEP_LABEL_SIZE - 1);
+        }
+        bool ok = ::write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)) &&
+                  ::write(fd, labels.data(), labels.size()) == static_cast<ssize_t>(labels.size());
+
+        threads = std::max(1u, threads);
+        auto start = std::chrono::steady_clock::now();
+        nextRun = 0;
+        writeFailed = false;
+        std::vector<std::uint64_t> scans(threads, 0);
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; ok && t < threads; t++) {
+            pool.emplace_back([this, runs, random, seed, &scans, t] { worker(runs, random, seed, scans[t]); });
+        }
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+        ok = ::close(fd) == 0 && ok && !writeFailed;
+        fd = -1;
+
+        summary.runs = runs;
+        summary.threads = threads;
+        summary.scans = 0;
+        for (std::uint64_t count : scans) {
+            summary.scans += count;
+        }
+        summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return ok;
+    }
+
+public:
+    // globals: the process image the FB was compiled against (copied per worker)
+    SweepRunner(const STFunctionBlock& functionBlock, const SweepLoop& closedLoop, const ProcessImage& image = {})
+        : block(functionBlock), loop(closedLoop), globals(image) {}
+
+    // Sweep a REAL frame slot over [low, high]: `points` grid points, or
+    // uniform samples in random mode; points = 1 holds it at low. A slot
+    // that is not a REAL cell of the frame is rejected and fails the runs.
+    bool addParameter(const std::string& label, std::int32_t slot, float low, float high, std::uint32_t points = 1) {
+        if (!checkSlot(slot, STType::REAL, ("parameter " + label).c_str(), false)) {
+            parametersValid = false;
+            return false;
+        }
+        parameters.push_back({label, slot, low, high, std::max(1u, points)});
+        return true;
+    }
+
+    std::uint64_t gridSize() const {
+        std::uint64_t runs = 1;
+        for (const Parameter& parameter : parameters) {
+            runs *= parameter.points;
+        }
+        return runs;
+    }
+
+    // Every grid point once
+    bool runGrid(const std::string& path, unsigned threads, Summary& summary) {
+        return run(path, gridSize(), false, 0, threads, summary);
+    }
+
+    // `samples` random parameter sets drawn from the seed
+    bool runRandom(const std::string& path, std::uint64_t samples, std::uint64_t seed, unsigned threads,
+                   Summary& summary) {
+        return run(path, samples, true, seed, threads, summary);
+    }
+};
+
+// A sweep results file read back: labels and records (values per record
+// are parameterCount floats starting at values[i * labels.size()])
+struct SweepResults {
+    std::vector<std::string> labels;
+    std::vector<SweepRecord> records;
+    std::vector<float> values;
+
+    bool read(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        std::vector<unsigned char> data;
+        unsigned char buffer[65536];
+        ssize_t n;
+        while ((n = ::read(fd, buffer, sizeof(buffer))) > 0) {
+            data.insert(data.end(), buffer, buffer + n);
+        }
+        ::close(fd);
+
+        SweepHeader header;
+        if (data.size() < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+        std::size_t parameters = header.parameterCount;
+        std::size_t offset = sizeof(header) + parameters * SWEEP_LABEL_SIZE;
+        if (std::memcmp(header.magic, SWEEP_MAGIC, sizeof(header.magic)) != 0 || header.version != SWEEP_VERSION ||
+            header.recordSize != sizeof(SweepRecord) + parameters * sizeof(float) || data.size() < offset) {
+            return false;
+        }
+        labels.clear();
+        for (std::size_t p = 0; p < parameters; p++) {
+            const char* label = reinterpret_cast<const char*>(data.data() + sizeof(header) + p * SWEEP_LABEL_SIZE);
+            labels.emplace_back(label, strnlen(label, SWEEP_LABEL_SIZE));
+        }
+        std::size_t count = (data.size() - offset) / header.recordSize;
+        records.resize(count);
+        values.resize(count * parameters);
+        for (std::size_t i = 0; i < count; i++, offset += header.recordSize) {
+            std::memcpy(&records[i], data.data() + offset, sizeof(SweepRecord));
+            if (parameters != 0) {
+                std::memcpy(&values[i * parameters], data.data() + offset + sizeof(SweepRecord),
+                            parameters * sizeof(float));
+            }
+        }
+        return true;
+    }
+};
@@ -0,0 +1,129 @@
+/**
+ * ISA-61131-3 Standard Timers (TON, TOF, TP)
+ * Timers are wired to the process image: IN is read from a bit or BOOL
+ * slot, Q is written to one, and the elapsed time ET (ms) optionally to an
+ * INT slot. They are evaluated with the time passed to update(), normally
+ * clockNowNs(), so on a virtual clock an hour-long delay takes as long as
+ * the scans in between. A TimerBank is a flat array of plain structs and
+ * can be snapshotted with memcpy.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "isa-clock.hpp"
+#include "isa-61131-3-process-image.hpp"
+
+enum class TimerKind : std::uint8_t {
+    TON,    // on-delay: Q rises PT after IN rises, falls with IN
+    TOF,    // off-delay: Q rises with IN, falls PT after IN falls
+    TP      // pulse: a rising IN starts a PT-long pulse on Q
+};
+
+struct IECTimer {
+    TimerKind kind;
+    bool lastIn;
+    bool running;
+    bool q;
+    PLCAddress in;
+    PLCAddress out;
+    PLCAddress elapsed;         // INT slot for ET in ms, or NONE
+    TimestampNs preset;         // PT
+    TimestampNs et;             // elapsed time, at most PT
+    TimestampNs start;          // when the current timing period began
+};
+
+static_assert(std::is_trivially_copyable<IECTimer>::value, "timers are snapshotted with memcpy");
+
+class TimerBank {
+private:
+    std::vector<IECTimer> timers;
+
+    static bool read(const ProcessImage& image, PLCAddress address) {
+        switch (address.area) {
+            case PLCArea::INPUT: return image.input(address.index);
+            case PLCArea::OUTPUT: return image.output(address.index);
+            case PLCArea::BOOL: return image.booleans[address.index] != 0;
+            default: return false;
+        }
+    }
+
+    static void write(ProcessImage& image, PLCAddress address, bool value) {
+        switch (address.area) {
+            case PLCArea::OUTPUT: image.setOutput(address.index, value); break;
+            case PLCArea::BOOL: image.booleans[address.index] = value; break;
+            default: break;
+        }
+    }
+
+    // Evaluate one timer (IEC 61131-3 semantics)
+    static void step(IECTimer& t, bool in, TimestampNs now) {
+        switch (t.kind) {
+            case TimerKind::TON:
+                if (in && !t.lastIn) {
+                    t.start = now;
+                }
+                t.et = in ? std::min(now - t.start, t.preset) : 0;
+                t.q = in && t.et >= t.preset;
+                break;
+            case TimerKind::TOF:
+                if (in) {
+                    t.running = false;
+                    t.et = 0;
+                } else if (t.lastIn) {
+                    t.start = now;
+                    t.running = true;
+                }
+                if (t.running) {
+                    t.et = std::min(now - t.start, t.preset);
+                    t.running = t.et < t.preset;
+                }
+                t.q = in || t.running;
+                break;
+            case TimerKind::TP:
+                if (in && !t.lastIn && !t.running) {
+                    t.start = now;
+                    t.running = true;
+                }
+                if (t.running) {
+                    t.et = std::min(now - t.start, t.preset);
+                    t.running = t.et < t.preset;
+                } else if (!in) {
+                    t.et = 0;
+                }
+                t.q = t.running;
+                break;
+        }
+        t.lastIn = in;
+    }
+
+public:
+    // Add a timer; elapsed may be an INT address to publish ET in ms
+    std::size_t add(TimerKind kind, PLCAddress in, PLCAddress out, TimestampNs preset,
+                    PLCAddress elapsed = {}) {
+        timers.push_back({kind, false, false, false, in, out, elapsed, preset, 0, 0});
+        return timers.size() - 1;
+    }
+
+    // Evaluate every timer at the given time and publish Q and ET
+    void update(ProcessImage& image, TimestampNs now) {
+        for (IECTimer& t : timers) {
+            step(t, read(image, t.in), now);
+            write(image, t.out, t.q);
+            if (t.elapsed.area == PLCArea::INT) {
+                image.integers[t.elapsed.index] = static_cast<std::int32_t>(t.et / 1000000);
+            }
+        }
+    }
+
+    std::size_t size() const { return timers.size(); }
+    const IECTimer& operator[](std::size_t i) const { return timers[i]; }
+
+    IECTimer* data() { return timers.data(); }
+    const IECTimer* data() const { return timers.data(); }
+};
@@ -0,0 +1,133 @@
+/**
+ * Time source and timestamp formatting - shared by the ISA simulations
+ * Event times are stored as int64 nanoseconds since the Unix epoch and only
+ * turned into text when something is printed.
+ *
+ * Simulation code reads the time through clockNowNs(). It is the system
+ * clock unless a VirtualClock is bound to the calling thread; then PLC
+ * timers, alarm timestamps and journal records all see plant time, which
+ * only moves when the simulation advances it. Each thread binds its own
+ * clock, so independent what-if runs can execute side by side.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+
+// Nanoseconds since the Unix epoch (0 = never)
+using TimestampNs = std::int64_t;
+
+constexpr TimestampNs NS_PER_SECOND = 1000000000;
+
+// Current wall-clock time; cheap enough to call on every transition
+inline TimestampNs systemNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Plant time that moves only when advanced
+class VirtualClock {
+private:
+    TimestampNs current;
+
+public:
+    explicit VirtualClock(TimestampNs start = systemNowNs()) : current(start) {}
+
+    TimestampNs now() const { return current; }
+    void set(TimestampNs time) { current = time; }
+    void advance(TimestampNs ns) { current += ns; }
+};
+
+// The virtual clock bound to this thread, or nullptr for real time
+inline VirtualClock*& boundClock() {
+    thread_local VirtualClock* clock = nullptr;
+    return clock;
+}
+
+// Current time for simulation logic: the bound virtual clock, else the system clock
+inline TimestampNs clockNowNs() {
+    VirtualClock* clock = boundClock();
+    return clock != nullptr ? clock->now() : systemNowNs();
+}
+
+// Binds a virtual clock to the current thread for the lifetime of the object
+class ClockBinding {
+private:
+    VirtualClock* previous;
+
+public:
+    explicit ClockBinding(VirtualClock& clock) : previous(boundClock()) { boundClock() = &clock; }
+    ~ClockBinding() { boundClock() = previous; }
+
+    ClockBinding(const ClockBinding&) = delete;
+    ClockBinding& operator=(const ClockBinding&) = delete;
+};
+
+// Formats timestamps as "YYYY-MM-DD HH:MM:SS" local time.
+// Thread-safe: uses the reentrant localtime variant and a per-thread cache of
+// the current minute, so bulk output of consecutive events only does the
+// calendar conversion once per minute.
+class TimestampFormatter {
+public:
+    static constexpr std::size_t BUFFER_SIZE = 20;  // 19 characters + terminator
+
+    // Format into a caller-supplied buffer of at least BUFFER_SIZE bytes
+    static std::size_t format(TimestampNs ns, char* buffer) {
+        std::int64_t seconds = ns / NS_PER_SECOND;
+        if (ns % NS_PER_SECOND < 0) {
+            seconds--;
+        }
+        std::int64_t minute = seconds / 60;
+        int second = static_cast<int>(seconds % 60);
+        if (second < 0) {
+            minute--;
+            second += 60;
+        }
+
+        Cache& cache = threadCache();
+        if (cache.minute != minute) {
+            std::time_t t = static_cast<std::time_t>(minute * 60);
+            std::tm tm{};
+#if defined(_WIN32)
+            localtime_s(&tm, &t);
+#else
+            localtime_r(&t, &tm);
+#endif
+            std::snprintf(cache.prefix, sizeof(cache.prefix), "%04d-%02d-%02d %02d:%02d:",
+                          tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min);
+            cache.minute = minute;
+        }
+
+        for (std::size_t i = 0; i < PREFIX_LENGTH; i++) {
+            buffer[i] = cache.prefix[i];
+        }
+        buffer[PREFIX_LENGTH] = static_cast<char>('0' + second / 10);
+        buffer[PREFIX_LENGTH + 1] = static_cast<char>('0' + second % 10);
+        buffer[PREFIX_LENGTH + 2] = '\0';
+        return PREFIX_LENGTH + 2;
+    }
+
+    static std::string format(TimestampNs ns) {
+        char buffer[BUFFER_SIZE];
+        std::size_t length = format(ns, buffer);
+        return std::string(buffer, length);
+    }
+
+private:
+    static constexpr std::size_t PREFIX_LENGTH = 17;  // "YYYY-MM-DD HH:MM:"
+
+    struct Cache {
+        std::int64_t minute = INT64_MIN;
+        char prefix[48] = {};           // room for any int year; only PREFIX_LENGTH is copied
+    };
+
+    static Cache& threadCache() {
+        thread_local Cache cache;
+        return cache;
+    }
+};
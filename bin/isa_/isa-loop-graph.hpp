@@ -0,0 +1,191 @@
+/**
+ * Loop Graph - shared by the ISA simulations
+ * Connects the objects the three simulators name by tag: ISA-5.1
+ * instruments (transmitters, controllers, valves), ISA-18.2 alarms and
+ * IEC 61131-3 process-image slots. Nodes are keyed by (kind, interned tag),
+ * so the instrument FT101 and the alarm FT101 share one TagId but are
+ * different nodes. Edges point along the signal and process path
+ * (FT101 -> FIC101 -> FV101, FT101 -> alarm FT101, FIC101 -> its output
+ * slot) and are stored in compressed sparse rows, forward and reverse, so
+ * "what is affected if FT101 fails" is a breadth-first walk over two flat
+ * arrays with no allocation once the result buffer has grown.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "isa-tag-registry.hpp"
+#include "isa-61131-3-process-image.hpp"
+
+enum class LoopNodeKind : std::uint8_t {
+    INSTRUMENT,     // ISA-5.1 tagged device
+    ALARM,          // ISA-18.2 alarm, ref is the alarm system's tag handle
+    VARIABLE        // process-image slot, ref is the packed PLCAddress
+};
+
+using LoopNodeId = std::uint32_t;
+constexpr LoopNodeId INVALID_LOOP_NODE = 0xFFFFFFFFu;
+
+class LoopGraph {
+private:
+    struct Node {
+        TagId tag;
+        LoopNodeKind kind;
+        std::uint32_t ref;
+    };
+
+    static constexpr unsigned SLOT_INDEX_BITS = 29;
+
+    TagRegistry tags;
+    std::vector<Node> nodes;
+    std::unordered_map<std::uint64_t, LoopNodeId> byKey;
+    std::vector<std::pair<LoopNodeId, LoopNodeId>> edges;
+
+    // CSR rows: successors of n are forwardTargets[forwardOffsets[n] .. forwardOffsets[n + 1])
+    std::vector<std::uint32_t> forwardOffsets;
+    std::vector<LoopNodeId> forwardTargets;
+    std::vector<std::uint32_t> reverseOffsets;
+    std::vector<LoopNodeId> reverseTargets;
+    bool built = true;
+
+    // Breadth-first search state; a node is visited when its mark equals the current epoch
+    std::vector<std::uint32_t> marks;
+    std::uint32_t epoch = 0;
+
+    static std::uint64_t key(LoopNodeKind kind, TagId tag) {
+        return std::uint64_t(kind) << 32 | tag;
+    }
+
+    LoopNodeId add(LoopNodeKind kind, std::string_view name, std::uint32_t ref) {
+        TagId tag = tags.intern(name);
+        auto inserted = byKey.emplace(key(kind, tag), static_cast<LoopNodeId>(nodes.size()));
+        if (inserted.second) {
+            nodes.push_back({tag, kind, ref});
+            built = false;
+        } else {
+            nodes[inserted.first->second].ref = ref;
+        }
+        return inserted.first->second;
+    }
+
+    // Counting sort of the edge list into CSR rows (duplicates are kept)
+    void buildRows(bool reverse, std::vector<std::uint32_t>& offsets, std::vector<LoopNodeId>& targets) {
+        offsets.assign(nodes.size() + 1, 0);
+        for (const auto& edge : edges) {
+            offsets[(reverse ? edge.second : edge.first) + 1]++;
+        }
+        for (std::size_t n = 0; n < nodes.size(); n++) {
+            offsets[n + 1] += offsets[n];
+        }
+        targets.resize(edges.size());
+        std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (const auto& edge : edges) {
+            LoopNodeId from = reverse ? edge.second : edge.first;
+            targets[fill[from]++] = reverse ? edge.first : edge.second;
+        }
+    }
+
+    void ensureBuilt() {
+        if (!built) {
+            buildRows(false, forwardOffsets, forwardTargets);
+            buildRows(true, reverseOffsets, reverseTargets);
+            marks.assign(nodes.size(), epoch);
+            built = true;
+        }
+    }
+
+    // Every node reachable from start (excluding start), in breadth-first order
+    void walk(LoopNodeId start, const std::vector<std::uint32_t>& offsets, const std::vector<LoopNodeId>& targets,
+              std::vector<LoopNodeId>& reached) {
+        reached.clear();
+        if (start >= nodes.size()) {
+            return;
+        }
+        if (++epoch == 0) {         // wrapped: stale marks could alias the new epoch
+            marks.assign(nodes.size(), 0);
+            epoch = 1;
+        }
+        marks[start] = epoch;
+        reached.push_back(start);
+        for (std::size_t head = 0; head < reached.size(); head++) {
+            LoopNodeId node = reached[head];
+            for (std::uint32_t e = offsets[node]; e < offsets[node + 1]; e++) {
+                LoopNodeId next = targets[e];
+                if (marks[next] != epoch) {
+                    marks[next] = epoch;
+                    reached.push_back(next);
+                }
+            }
+        }
+        reached.erase(reached.begin());
+    }
+
+public:
+    LoopNodeId addInstrument(std::string_view tag) { return add(LoopNodeKind::INSTRUMENT, tag, 0); }
+
+    // alarmTag is the alarm system's handle for the alarm (AlarmManagementSystem::addAlarm)
+    LoopNodeId addAlarm(std::string_view tag, TagId alarmTag) { return add(LoopNodeKind::ALARM, tag, alarmTag); }
+
+    LoopNodeId addVariable(std::string_view name, PLCAddress slot) {
+        return add(LoopNodeKind::VARIABLE, name,
+                   static_cast<std::uint32_t>(slot.area) << SLOT_INDEX_BITS | slot.index);
+    }
+
+    // Directed edge along the signal or process path: a fault at from affects
+    // to. Returns false (and adds nothing) unless both nodes exist, e.g. for
+    // an INVALID_LOOP_NODE from find().
+    bool connect(LoopNodeId from, LoopNodeId to) {
+        if (from >= nodes.size() || to >= nodes.size()) {
+            return false;
+        }
+        edges.emplace_back(from, to);
+        built = false;
+        return true;
+    }
+
+    void reserve(std::size_t nodeCount, std::size_t edgeCount) {
+        nodes.reserve(nodeCount);
+        byKey.reserve(nodeCount);
+        tags.reserve(nodeCount);
+        edges.reserve(edgeCount);
+    }
+
+    LoopNodeId find(LoopNodeKind kind, std::string_view tag) const {
+        TagId id = tags.find(tag);
+        if (id == INVALID_TAG_ID) {
+            return INVALID_LOOP_NODE;
+        }
+        auto it = byKey.find(key(kind, id));
+        return (it != byKey.end()) ? it->second : INVALID_LOOP_NODE;
+    }
+
+    // Everything downstream of a failed node: instruments, alarms and slots
+    void affected(LoopNodeId failed, std::vector<LoopNodeId>& reached) {
+        ensureBuilt();
+        walk(failed, forwardOffsets, forwardTargets, reached);
+    }
+
+    // Everything upstream of a node, e.g. the possible causes of an alarm
+    void causes(LoopNodeId node, std::vector<LoopNodeId>& reached) {
+        ensureBuilt();
+        walk(node, reverseOffsets, reverseTargets, reached);
+    }
+
+    LoopNodeKind kind(LoopNodeId node) const { return nodes[node].kind; }
+    TagId tag(LoopNodeId node) const { return nodes[node].tag; }
+    const std::string& name(LoopNodeId node) const { return tags.name(nodes[node].tag); }
+    TagId alarmTag(LoopNodeId node) const { return nodes[node].ref; }
+    PLCAddress slot(LoopNodeId node) const {
+        return {static_cast<PLCArea>(nodes[node].ref >> SLOT_INDEX_BITS),
+                nodes[node].ref & ((1u << SLOT_INDEX_BITS) - 1)};
+    }
+
+    std::size_t nodeCount() const { return nodes.size(); }
+    std::size_t edgeCount() const { return edges.size(); }
+};
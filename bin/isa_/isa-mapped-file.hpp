@@ -0,0 +1,67 @@
+/**
+ * Read-only file mapping - shared by the ISA simulations
+ * Used by the alarm history store (column files) and the plant
+ * configuration loader. POSIX mmap.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+private:
+    void* data = nullptr;
+    std::size_t length = 0;
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept : data(other.data), length(other.length) {
+        other.data = nullptr;
+        other.length = 0;
+    }
+    ~MappedFile() { unmap(); }
+
+    bool map(const std::string& path) {
+        unmap();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        // An empty file maps to an empty range; a failed fstat or mmap is an error
+        struct stat info;
+        bool ok = ::fstat(fd, &info) == 0;
+        if (ok && info.st_size > 0) {
+            void* mapped = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ,
+                                  MAP_SHARED, fd, 0);
+            ok = mapped != MAP_FAILED;
+            if (ok) {
+                data = mapped;
+                length = static_cast<std::size_t>(info.st_size);
+            }
+        }
+        ::close(fd);
+        return ok;
+    }
+
+    void unmap() {
+        if (data != nullptr) {
+            ::munmap(data, length);
+            data = nullptr;
+            length = 0;
+        }
+    }
+
+    template <typename T>
+    const T* as() const { return static_cast<const T*>(data); }
+
+    std::size_t size() const { return length; }
+};
@@ -0,0 +1,338 @@
+/**
+ * Plant Configuration Loader - alarms and I/O points
+ * Loads the alarm and PLC I/O database from a flat text file, one record
+ * per line ('#' starts a comment):
+ *   ALARM,<tag>,<LOW|MEDIUM|HIGH|CRITICAL>,<setpoint>,<deadband>,<description>
+ *   IO,<INPUT|OUTPUT|INT|REAL|BOOL>,<name>,<initial value>
+ * The description is last so it may contain commas. The file is memory-
+ * mapped and parsed in place: names and descriptions are string_views into
+ * the mapping and numbers are converted with std::from_chars, so parsing
+ * allocates nothing per field; the record arrays are reserved up front from
+ * a line count. Consumers construct their objects straight from the views.
+ *
+ * writeSnapshot() stores the parsed records as a binary file (header, fixed
+ * records, string pool) that load() recognises by its magic. Loading a
+ * snapshot is a bounds check and one pass of offset arithmetic - no
+ * tokenizing or number conversion - for near-instant warm restarts. Records
+ * are validated as parseText() validates them (known priority and area,
+ * non-empty tag and name), so a corrupt snapshot is rejected, not applied.
+ *
+ * The views stay valid for the lifetime of the PlantConfig (until the next
+ * load()). POSIX mmap/file I/O.
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "isa-mapped-file.hpp"
+#include "isa-18-2-alarm-types.hpp"
+#include "isa-61131-3-process-image.hpp"
+
+struct AlarmConfig {
+    std::string_view tag;
+    std::string_view description;
+    AlarmPriority priority;
+    double setpoint;
+    double deadband;
+};
+
+struct PointConfig {
+    std::string_view name;
+    PLCArea area;
+    double value;
+};
+
+// Snapshot layout: ConfigSnapshotHeader, AlarmConfigRecord[alarms],
+// PointConfigRecord[points], then the string pool; host byte order
+struct ConfigString {
+    std::uint32_t offset;       // into the string pool
+    std::uint32_t length;
+};
+
+struct AlarmConfigRecord {
+    ConfigString tag;
+    ConfigString description;
+    double setpoint;
+    double deadband;
+    AlarmPriority priority;
+    std::uint8_t reserved[7];
+};
+
+struct PointConfigRecord {
+    ConfigString name;
+    double value;
+    PLCArea area;
+    std::uint8_t reserved[7];
+};
+
+struct ConfigSnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t alarmRecordSize;
+    std::uint32_t pointRecordSize;
+    std::uint32_t alarmCount;
+    std::uint32_t pointCount;
+    std::uint32_t stringBytes;
+};
+
+static_assert(sizeof(AlarmConfigRecord) == 40, "alarm record layout is part of the snapshot format");
+static_assert(sizeof(PointConfigRecord) == 24, "point record layout is part of the snapshot format");
+static_assert(sizeof(ConfigSnapshotHeader) == 32, "snapshot header layout is part of the file format");
+
+constexpr char CONFIG_SNAPSHOT_MAGIC[8] = {'I', 'S', 'A', 'C', 'F', 'G', 'S', '\0'};
+constexpr std::uint32_t CONFIG_SNAPSHOT_VERSION = 1;
+
+class PlantConfig {
+private:
+    MappedFile file;
+    std::vector<AlarmConfig> alarmList;
+    std::vector<PointConfig> pointList;
+    std::string errorText;
+
+    // Split off the next comma-separated field (or the rest of the line)
+    static std::string_view field(std::string_view& line, bool last = false) {
+        std::size_t comma = last ? std::string_view::npos : line.find(',');
+        std::string_view value = line.substr(0, comma);
+        line.remove_prefix(comma == std::string_view::npos ? line.size() : comma + 1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+            value.remove_prefix(1);
+        }
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r')) {
+            value.remove_suffix(1);
+        }
+        return value;
+    }
+
+    static bool number(std::string_view text, double& value) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    static bool priority(std::string_view text, AlarmPriority& value) {
+        if (text == "LOW") value = AlarmPriority::LOW;
+        else if (text == "MEDIUM") value = AlarmPriority::MEDIUM;
+        else if (text == "HIGH") value = AlarmPriority::HIGH;
+        else if (text == "CRITICAL") value = AlarmPriority::CRITICAL;
+        else return false;
+        return true;
+    }
+
+    static bool area(std::string_view text, PLCArea& value) {
+        if (text == "INPUT") value = PLCArea::INPUT;
+        else if (text == "OUTPUT") value = PLCArea::OUTPUT;
+        else if (text == "INT") value = PLCArea::INT;
+        else if (text == "REAL") value = PLCArea::REAL;
+        else if (text == "BOOL") value = PLCArea::BOOL;
+        else return false;
+        return true;
+    }
+
+    bool fail(const std::string& message, std::size_t lineNumber = 0) {
+        errorText = lineNumber != 0 ? "line " + std::to_string(lineNumber) + ": " + message : message;
+        alarmList.clear();
+        pointList.clear();
+        return false;
+    }
+
+    bool parseText(std::string_view text) {
+        // Size both arrays from the first letter of every line
+        std::size_t alarmLines = 0;
+        std::size_t pointLines = 0;
+        for (std::size_t i = 0; i < text.size(); i++) {
+            if (i == 0 || text[i - 1] == '\n') {
+                alarmLines += text[i] == 'A';
+                pointLines += text[i] == 'I';
+            }
+        }
+        alarmList.reserve(alarmLines);
+        pointList.reserve(pointLines);
+
+        std::size_t lineNumber = 0;
+        while (!text.empty()) {
+            std::size_t end = text.find('\n');
+            std::string_view line = text.substr(0, end);
+            text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+            lineNumber++;
+
+            std::string_view kind = field(line);
+            if (kind.empty() || kind.front() == '#') {
+                continue;
+            }
+            if (kind == "ALARM") {
+                AlarmConfig alarm;
+                alarm.tag = field(line);
+                if (alarm.tag.empty() || !priority(field(line), alarm.priority) ||
+                    !number(field(line), alarm.setpoint) || !number(field(line), alarm.deadband)) {
+                    return fail("malformed ALARM record", lineNumber);
+                }
+                alarm.description = field(line, true);
+                alarmList.push_back(alarm);
+            } else if (kind == "IO") {
+                PointConfig point;
+                if (!area(field(line), point.area)) {
+                    return fail("unknown I/O area", lineNumber);
+                }
+                point.name = field(line);
+                if (point.name.empty() || !number(field(line, true), point.value)) {
+                    return fail("malformed IO record", lineNumber);
+                }
+                pointList.push_back(point);
+            } else {
+                return fail("unknown record type", lineNumber);
+            }
+        }
+        return true;
+    }
+
+    bool parseSnapshot(const char* data, std::size_t size) {
+        ConfigSnapshotHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.version != CONFIG_SNAPSHOT_VERSION || header.alarmRecordSize != sizeof(AlarmConfigRecord) ||
+            header.pointRecordSize != sizeof(PointConfigRecord)) {
+            return fail("unsupported snapshot version or layout");
+        }
+        std::size_t pool = sizeof(header) + std::size_t(header.alarmCount) * sizeof(AlarmConfigRecord) +
+                           std::size_t(header.pointCount) * sizeof(PointConfigRecord);
+        if (pool + header.stringBytes != size) {
+            return fail("truncated snapshot");
+        }
+        const char* strings = data + pool;
+        auto view = [&](ConfigString s, std::string_view& out) {
+            if (std::size_t(s.offset) + s.length > header.stringBytes) {
+                return false;
+            }
+            out = std::string_view(strings + s.offset, s.length);
+            return true;
+        };
+
+        // Records are 8-byte aligned in the file and the mapping is page-aligned
+        const AlarmConfigRecord* alarms = reinterpret_cast<const AlarmConfigRecord*>(data + sizeof(header));
+        const PointConfigRecord* points = reinterpret_cast<const PointConfigRecord*>(alarms + header.alarmCount);
+        alarmList.resize(header.alarmCount);
+        pointList.resize(header.pointCount);
+        for (std::uint32_t i = 0; i < header.alarmCount; i++) {
+            AlarmConfig& alarm = alarmList[i];
+            if (alarms[i].priority > AlarmPriority::CRITICAL) {
+                return fail("invalid alarm priority in snapshot");
+            }
+            alarm.priority = alarms[i].priority;
+            alarm.setpoint = alarms[i].setpoint;
+            alarm.deadband = alarms[i].deadband;
+            if (!view(alarms[i].tag, alarm.tag) || !view(alarms[i].description, alarm.description)) {
+                return fail("corrupt snapshot string reference");
+            }
+            if (alarm.tag.empty()) {
+                return fail("empty alarm tag in snapshot");
+            }
+        }
+        for (std::uint32_t i = 0; i < header.pointCount; i++) {
+            PointConfig& point = pointList[i];
+            if (points[i].area >= PLCArea::NONE) {
+                return fail("invalid I/O area in snapshot");
+            }
+            point.area = points[i].area;
+            point.value = points[i].value;
+            if (!view(points[i].name, point.name)) {
+                return fail("corrupt snapshot string reference");
+            }
+            if (point.name.empty()) {
+                return fail("empty I/O name in snapshot");
+            }
+        }
+        return true;
+    }
+
+public:
+    // Load a text configuration or a binary snapshot (detected by its magic)
+    bool load(const std::string& path) {
+        alarmList.clear();
+        pointList.clear();
+        errorText.clear();
+        if (!file.map(path)) {
+            return fail("cannot open " + path);
+        }
+        const char* data = file.as<char>();
+        std::size_t size = file.size();
+        if (size >= sizeof(ConfigSnapshotHeader) &&
+            std::memcmp(data, CONFIG_SNAPSHOT_MAGIC, sizeof(CONFIG_SNAPSHOT_MAGIC)) == 0) {
+            return parseSnapshot(data, size);
+        }
+        return parseText(std::string_view(data, size));
+    }
+
+    // Write the loaded records as a binary snapshot
+    bool writeSnapshot(const std::string& path) const {
+        std::vector<AlarmConfigRecord> alarms(alarmList.size());
+        std::vector<PointConfigRecord> points(pointList.size());
+        std::string strings;
+        auto intern = [&strings](std::string_view text) {
+            ConfigString s{static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(text.size())};
+            strings.append(text.data(), text.size());
+            return s;
+        };
+        for (std::size_t i = 0; i < alarmList.size(); i++) {
+            const AlarmConfig& alarm = alarmList[i];
+            alarms[i] = {intern(alarm.tag), intern(alarm.description), alarm.setpoint, alarm.deadband,
+                         alarm.priority, {}};
+        }
+        for (std::size_t i = 0; i < pointList.size(); i++) {
+            points[i] = {intern(pointList[i].name), pointList[i].value, pointList[i].area, {}};
+        }
+
+        ConfigSnapshotHeader header{};
+        std::memcpy(header.magic, CONFIG_SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = CONFIG_SNAPSHOT_VERSION;
+        header.alarmRecordSize = sizeof(AlarmConfigRecord);
+        header.pointRecordSize = sizeof(PointConfigRecord);
+        header.alarmCount = static_cast<std::uint32_t>(alarms.size());
+        header.pointCount = static_cast<std::uint32_t>(points.size());
+        header.stringBytes = static_cast<std::uint32_t>(strings.size());
+
+        // Written under a temporary name and renamed, so a crash never leaves a torn snapshot
+        std::string temporary = path + ".tmp";
+        int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        auto put = [fd](const void* data, std::size_t length) {
+            const char* bytes = static_cast<const char*>(data);
+            while (length > 0) {
+                ssize_t written = ::write(fd, bytes, length);
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (written <= 0) {
+                    return false;
+                }
+                bytes += written;
+                length -= static_cast<std::size_t>(written);
+            }
+            return true;
+        };
+        bool ok = put(&header, sizeof(header)) && put(alarms.data(), alarms.size() * sizeof(AlarmConfigRecord)) &&
+                  put(points.data(), points.size() * sizeof(PointConfigRecord)) &&
+                  put(strings.data(), strings.size());
+        ok = ::close(fd) == 0 && ok;
+        if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    const std::vector<AlarmConfig>& alarms() const { return alarmList; }
+    const std::vector<PointConfig>& points() const { return pointList; }
+    const std::string& error() const { return errorText; }
+};
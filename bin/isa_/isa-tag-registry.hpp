@@ -0,0 +1,53 @@
+/**
+ * Interned Tag Registry - shared by the ISA simulations
+ * Maps instrument tag names (e.g. "TT101", "FT303") to dense numeric IDs so
+ * hot paths can address tags by a stable integer handle instead of comparing
+ * strings.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Dense, stable numeric handle for an interned tag name
+using TagId = std::uint32_t;
+constexpr TagId INVALID_TAG_ID = 0xFFFFFFFFu;
+
+// Tag interning table: IDs are assigned in registration order and never reused
+class TagRegistry {
+private:
+    // std::deque never relocates its elements, so the views used as hash keys stay valid
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, TagId> index;
+
+public:
+    // Return the ID for a tag, registering it on first use
+    TagId intern(std::string_view name) {
+        auto it = index.find(name);
+        if (it != index.end()) {
+            return it->second;
+        }
+        TagId id = static_cast<TagId>(names.size());
+        names.emplace_back(name);
+        index.emplace(std::string_view(names.back()), id);
+        return id;
+    }
+
+    // Look up a tag without registering it (no allocation)
+    TagId find(std::string_view name) const {
+        auto it = index.find(name);
+        return (it != index.end()) ? it->second : INVALID_TAG_ID;
+    }
+
+    bool contains(TagId id) const { return id < names.size(); }
+
+    const std::string& name(TagId id) const { return names[id]; }
+
+    std::size_t size() const { return names.size(); }
+
+    void reserve(std::size_t count) { index.reserve(count); }
+};